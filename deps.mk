@@ -1,4 +1,73 @@
 argparser.o: modules/argparser.c modules/argparser.h \
-  modules/locale_macros.h
+ modules/locale_macros.h modules/plugins.h modules/qrgb_plugin.h
+devio.o: modules/devio.c modules/locale_macros.h modules/devio.h \
+ modules/rgbmodes.h modules/argparser.h modules/prng.h \
+ modules/keyframes.h modules/visualizer.h modules/sequence.h \
+ modules/easing.h modules/audio.h modules/analyzer.h modules/beat.h \
+ modules/ingress.h modules/qrgb_shm.h modules/openrgb.h modules/plugins.h \
+ modules/qrgb_plugin.h modules/scene.h modules/compositor.h \
+ modules/image.h modules/dimmer.h modules/calibration.h modules/player.h \
+ modules/decimator.h modules/control.h modules/watch.h modules/preset.h \
+ modules/pipeline.h modules/live.h modules/hotkey.h
 rgbmodes.o: modules/rgbmodes.c modules/rgbmodes.h modules/argparser.h \
-  modules/locale_macros.h
+ modules/locale_macros.h modules/prng.h modules/keyframes.h \
+ modules/visualizer.h modules/sequence.h modules/easing.h modules/audio.h \
+ modules/analyzer.h modules/beat.h modules/ingress.h modules/qrgb_shm.h \
+ modules/openrgb.h modules/plugins.h modules/qrgb_plugin.h \
+ modules/scene.h modules/compositor.h modules/image.h
+plugins.o: modules/plugins.c modules/plugins.h modules/locale_macros.h \
+ modules/qrgb_plugin.h
+compositor.o: modules/compositor.c modules/compositor.h \
+ modules/argparser.h modules/locale_macros.h modules/sequence.h \
+ modules/easing.h
+sequence.o: modules/sequence.c modules/sequence.h modules/easing.h
+scene.o: modules/scene.c modules/scene.h modules/compositor.h \
+ modules/argparser.h modules/locale_macros.h modules/sequence.h \
+ modules/easing.h modules/image.h
+prng.o: modules/prng.c modules/prng.h
+easing.o: modules/easing.c modules/easing.h
+keyframes.o: modules/keyframes.c modules/keyframes.h \
+ modules/locale_macros.h modules/argparser.h modules/easing.h \
+ modules/scene.h modules/compositor.h modules/sequence.h modules/image.h
+image.o: modules/image.c modules/image.h modules/locale_macros.h \
+ modules/rgbmodes.h modules/argparser.h modules/prng.h \
+ modules/keyframes.h modules/visualizer.h modules/sequence.h \
+ modules/easing.h modules/audio.h modules/analyzer.h modules/beat.h \
+ modules/ingress.h modules/qrgb_shm.h modules/openrgb.h modules/plugins.h \
+ modules/qrgb_plugin.h modules/scene.h modules/compositor.h
+audio.o: modules/audio.c modules/audio.h modules/locale_macros.h
+analyzer.o: modules/analyzer.c modules/analyzer.h
+visualizer.o: modules/visualizer.c modules/visualizer.h \
+ modules/locale_macros.h modules/argparser.h modules/sequence.h \
+ modules/easing.h modules/audio.h modules/analyzer.h modules/beat.h
+beat.o: modules/beat.c modules/beat.h modules/locale_macros.h \
+ modules/audio.h modules/analyzer.h modules/scene.h modules/compositor.h \
+ modules/argparser.h modules/sequence.h modules/easing.h modules/image.h
+dimmer.o: modules/dimmer.c modules/dimmer.h
+calibration.o: modules/calibration.c modules/calibration.h \
+ modules/locale_macros.h
+player.o: modules/player.c modules/player.h modules/scene.h \
+ modules/compositor.h modules/argparser.h modules/locale_macros.h \
+ modules/sequence.h modules/easing.h modules/image.h
+decimator.o: modules/decimator.c modules/decimator.h \
+ modules/locale_macros.h
+control.o: modules/control.c modules/control.h modules/locale_macros.h
+ingress.o: modules/ingress.c modules/ingress.h modules/locale_macros.h \
+ modules/argparser.h modules/sequence.h modules/easing.h \
+ modules/qrgb_shm.h
+openrgb.o: modules/openrgb.c modules/openrgb.h modules/locale_macros.h \
+ modules/argparser.h modules/sequence.h modules/easing.h
+watch.o: modules/watch.c modules/watch.h
+preset.o: modules/preset.c modules/preset.h modules/locale_macros.h \
+ modules/scene.h modules/compositor.h modules/argparser.h \
+ modules/sequence.h modules/easing.h modules/image.h modules/rgbmodes.h \
+ modules/prng.h modules/keyframes.h modules/visualizer.h modules/audio.h \
+ modules/analyzer.h modules/beat.h modules/ingress.h modules/qrgb_shm.h \
+ modules/openrgb.h modules/plugins.h modules/qrgb_plugin.h \
+ modules/control.h
+pipeline.o: modules/pipeline.c modules/locale_macros.h modules/pipeline.h
+live.o: modules/live.c modules/live.h modules/locale_macros.h \
+ modules/argparser.h
+hotkey.o: modules/hotkey.c modules/hotkey.h modules/locale_macros.h \
+ modules/keynames.h modules/argparser.h modules/preset.h modules/scene.h \
+ modules/compositor.h modules/sequence.h modules/easing.h modules/image.h
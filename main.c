@@ -28,6 +28,7 @@
 #include "modules/argparser.h"
 #include "modules/rgbmodes.h"
 #include "modules/devio.h"
+#include "modules/plugins.h"
 
 #define LOCALESETUP() \
     setlocale(LC_CTYPE, ""); \
@@ -50,30 +51,308 @@
 #define VERBOSE3_MIC _("Opening the microphone descriptor.")
 #define VERBOSE4_PKT _("Sending packets.")
 #define VERBOSE5_END _("Done.")
+#define VERBOSE6_IMG _("The compiled scene is written.")
+#define COMPILE_USAGE_MSG _("compile: give the output file with -o FILE\n")
+#define NOCOMPILE_MSG _("-o: only compile writes files\n")
+#define BEATTEST_USAGE_MSG _("Usage: quadcastrgb beattest clicks.wav\n")
+#define CTL_STDIN_MSG _("The running quadcastrgb can't read the audio of " \
+                        "this stdin, give it a file or a device\n")
+
+#define STATS_FRAMES (60*1000/FRAME_MS) /* played if the loop is longer */
+
+static int compile_scene(int argc, const char **argv);
+static int control_running(int argc, const char **argv);
+static int scene_stats(int argc, const char **argv);
+static void set_output_opts(const struct colschemes *cs,
+                            struct output_opts *opt);
+static int load_dev_calibration(libusb_device_handle *handle,
+                                const char *path, struct calibration *cal);
+static struct scene *preset_scene(const struct colschemes *cs,
+                                  uint64_t dev_key);
 
 int main(int argc, const char **argv)
 {
     struct colschemes *cs;
-    datpack *data_arr;
+    struct scene *sc = NULL;
     libusb_device_handle *handle;
-    int verbose = 0, data_packet_cnt;
+    struct output_opts opt;
+    int verbose = 0, status;
     /*LOCALESETUP();*/
+    if(argc > 1 && strequ(argv[1], "compile"))
+        return compile_scene(argc-1, argv+1);
+    if(argc > 1 && strequ(argv[1], "stats"))
+        return scene_stats(argc-1, argv+1);
+    if(argc > 1 && strequ(argv[1], "ctl"))
+        return control_running(argc-1, argv+1);
+    if(argc > 1 && strequ(argv[1], "beattest")) { /* no microphone needed */
+        if(argc != 3) {
+            fprintf(stderr, BEATTEST_USAGE_MSG);
+            return argerr;
+        }
+        return beat_test(argv[2], BEAT_LEAD(SPD_DEFAULT)) ? argerr : 0;
+    }
     /* Parse arguments */
     cs = parse_arg(argc, argv, &verbose);
+    if(cs->output) {
+        fprintf(stderr, NOCOMPILE_MSG);
+        free(cs); return argerr;
+    }
+    /* The running program takes it over, the lights go on without a gap.
+     * The audio of stdin can't go with the request, this one plays it */
+    status = reads_stdin(cs) ? -1 : ctl_send(argc, argv);
+    if(status >= 0) {
+        free(cs); return status;
+    }
+    if(cs->presets && preset_load(cs->presets, cs->cache)) {
+        free(cs); return argerr;
+    }
+    if(cs->image) { /* mapped now, the frames are ready */
+        sc = load_scene(cs->image);
+        if(!sc) {
+            preset_free();
+            free(cs); return argerr;
+        }
+    } else if(cs->preset) {
+        if(preset_find(cs->preset) < 0) {
+            preset_free();
+            free(cs); return argerr;
+        }
+    } else if(check_colorscheme(cs)) {
+        preset_free();
+        free(cs); return NOSUPPORT_EXIT;
+    }
     VERBOSE_PRINT(verbose, VERBOSE1_ARG);
-    /* Create data packets */
-    VERBOSE_PRINT(verbose, VERBOSE2_COL);
-    data_arr = parse_colorscheme(cs, &data_packet_cnt);
-    free(cs);
     /* Open the microphone */
     VERBOSE_PRINT(verbose, VERBOSE3_MIC);
-    handle = open_micro(data_arr); /* data_arr for freeing memory */
-    /* Send packets */
+    handle = open_micro(cs); /* cs for freeing memory */
+    if(!handle) { /* another one is starting with it, it takes the scene */
+        status = reads_stdin(cs);
+        free_scene(sc);
+        preset_free();
+        free(cs);
+        vis_close();
+        ingress_close();
+        orgb_close();
+        unload_plugins();
+        if(status) {
+            fprintf(stderr, CTL_STDIN_MSG);
+            return argerr;
+        }
+        status = ctl_send_wait(argc, argv, CTL_WAIT_MS);
+        if(status < 0) {
+            fprintf(stderr, CTL_BUSY_MSG);
+            return argerr;
+        }
+        return status;
+    }
+    if(load_dev_calibration(handle, cs->calib, &opt.cal)) {
+        free_scene(sc);
+        preset_free();
+        free(cs);
+        LIBUSB_FREE_EVERYTHING();
+        return argerr;
+    }
+    /* Create data packets, the random streams depend on the microphone */
+    VERBOSE_PRINT(verbose, VERBOSE2_COL);
+    preset_warm(dev_key(handle));
+    if(cs->preset && !cs->image)
+        sc = preset_scene(cs, dev_key(handle));
+    else if(!cs->image) /* the files might have gone since the check */
+        sc = parse_colorscheme(cs, dev_key(handle));
+    if(!sc) {
+        preset_free();
+        free(cs);
+        LIBUSB_FREE_EVERYTHING();
+        return argerr;
+    }
+    if(live_open(cs->osc, cs->midi) ||
+       (cs->hotkeys && hotkey_open(cs->hotkeys))) {
+        live_close();
+        free_scene(sc);
+        preset_free();
+        free(cs);
+        LIBUSB_FREE_EVERYTHING();
+        return argerr;
+    }
+    set_output_opts(cs, &opt);
+    opt.argc = argc;
+    opt.argv = argv;
+    free(cs);
+    /* Send packets, the scene is freed after them */
     VERBOSE_PRINT(verbose, VERBOSE4_PKT);
-    send_packets(handle, data_arr, data_packet_cnt, verbose);
+    send_packets(handle, sc, &opt, verbose);
     /* Free all memory */
-    free(data_arr);
+    hotkey_close();
+    live_close();
+    preset_free();
+    vis_close();
+    ingress_close();
+    orgb_close();
+    unload_plugins();
     LIBUSB_FREE_EVERYTHING();
     VERBOSE_PRINT(verbose, VERBOSE5_END);
     return 0;
 }
+
+/* quadcastrgb compile [OPTIONS] mode [COLORS]... -o FILE */
+static int compile_scene(int argc, const char **argv)
+{
+    struct colschemes *cs;
+    struct scene *sc = NULL;
+    const char *output;
+    int verbose = 0, err;
+
+    cs = parse_arg(argc, argv, &verbose); /* argv[0] is "compile" */
+    if(!cs->output || cs->image) {
+        fprintf(stderr, COMPILE_USAGE_MSG);
+        free(cs); return argerr;
+    }
+    if(cs->presets && preset_load(cs->presets, cs->cache)) {
+        free(cs); return argerr;
+    }
+    if(!cs->preset && check_colorscheme(cs)) {
+        preset_free();
+        free(cs); return NOSUPPORT_EXIT;
+    }
+    VERBOSE_PRINT(verbose, VERBOSE1_ARG);
+    output = cs->output;
+    /* No microphone: the random colors depend on the seed only */
+    VERBOSE_PRINT(verbose, VERBOSE2_COL);
+    sc = cs->preset ? preset_scene(cs, 0) : parse_colorscheme(cs, 0);
+    free(cs);
+    err = sc ? write_image(sc, output) : argerr;
+    free_scene(sc);
+    preset_free();
+    vis_close();
+    ingress_close();
+    orgb_close();
+    unload_plugins();
+    VERBOSE_PRINT(verbose && !err, VERBOSE6_IMG);
+    return err;
+}
+
+/* quadcastrgb ctl [OPTIONS] [mode [COLORS]...]
+ * Only the given options of the running program change */
+static int control_running(int argc, const char **argv)
+{
+    struct colschemes *cs;
+    int verbose = 0, status;
+
+    cs = parse_opts(argc, argv, &verbose); /* argv[0] is "ctl" */
+    if(cs->output) {
+        fprintf(stderr, NOCOMPILE_MSG);
+        free(cs); return argerr;
+    }
+    if(has_scene(cs))
+        check_modes(cs);
+    if(reads_stdin(cs)) {
+        fprintf(stderr, CTL_STDIN_MSG);
+        free(cs); return argerr;
+    }
+    free(cs);
+    status = ctl_send(argc, argv);
+    if(status < 0) {
+        fprintf(stderr, CTL_NODAEMON_MSG);
+        return argerr;
+    }
+    return status;
+}
+
+/* quadcastrgb stats [OPTIONS] mode [COLORS]...
+ * Plays a loop of the scene without the microphone and tells how many
+ * transfers --merge saves */
+static int scene_stats(int argc, const char **argv)
+{
+    struct colschemes *cs;
+    struct scene *sc;
+    struct output_opts opt;
+    struct player pl;
+    struct dimmer dims[2];
+    struct decimator dc;
+    unsigned long frames, i;
+    int verbose = 0, upper_col, lower_col;
+
+    cs = parse_arg(argc, argv, &verbose); /* argv[0] is "stats" */
+    if(cs->output) {
+        fprintf(stderr, NOCOMPILE_MSG);
+        free(cs); return argerr;
+    }
+    if(cs->presets && preset_load(cs->presets, cs->cache)) {
+        free(cs); return argerr;
+    }
+    if(cs->image) {
+        sc = load_scene(cs->image);
+    } else if(cs->preset) {
+        sc = preset_scene(cs, 0);
+    } else if(check_colorscheme(cs)) {
+        preset_free();
+        free(cs); return NOSUPPORT_EXIT;
+    } else {
+        sc = parse_colorscheme(cs, 0);
+    }
+    if(!sc) {
+        preset_free();
+        free(cs); return argerr;
+    }
+    set_output_opts(cs, &opt);
+    free(cs);
+    frames = sc->len == SEQ_ENDLESS ? STATS_FRAMES
+                          : (unsigned long)sc->len*RATE_ONE/opt.rate;
+    if(frames == 0 || frames > STATS_FRAMES)
+        frames = STATS_FRAMES;
+    player_init(&pl, sc);
+    player_set_rate(&pl, opt.rate);
+    dim_init(&dims[0], opt.upper_dim);
+    dim_init(&dims[1], opt.lower_dim);
+    dec_init(&dc, opt.merge);
+    for(i = 0; i < frames; i++) { /* as the sender does, but calibration */
+        player_next(&pl, &upper_col, &lower_col);
+        dec_frame(&dc, dim_color(&dims[0], upper_col),
+                  dim_color(&dims[1], lower_col));
+    }
+    dec_report(&dc, opt.upper_mode, opt.lower_mode);
+    player_free(&pl);
+    preset_free();
+    vis_close();
+    ingress_close();
+    orgb_close();
+    unload_plugins();
+    return 0;
+}
+
+/* The base modes name the groups, the scene file or the preset both */
+static void set_output_opts(const struct colschemes *cs,
+                            struct output_opts *opt)
+{
+    opt->upper_dim = cs->upper_dim;
+    opt->lower_dim = cs->lower_dim;
+    opt->fade = FADE_FRAMES(cs->fade);
+    opt->rate = RATE_FIXED(cs->rate);
+    opt->merge = cs->merge;
+    opt->ahead = cs->ahead;
+    opt->upper_mode = cs->image ? cs->image :
+                      cs->preset ? cs->preset : cs->upper.mode;
+    opt->lower_mode = cs->image ? cs->image :
+                      cs->preset ? cs->preset : cs->lower.mode;
+}
+
+/* From the library loaded before, NULL & message if it can't be played */
+static struct scene *preset_scene(const struct colschemes *cs,
+                                  uint64_t dev_key)
+{
+    int id = preset_find(cs->preset);
+    return id < 0 ? NULL : preset_take(id, dev_key);
+}
+
+/* The profile of this very microphone, the identity without a file */
+static int load_dev_calibration(libusb_device_handle *handle,
+                                const char *path, struct calibration *cal)
+{
+    struct dev_ident id;
+    cal_identity(cal);
+    if(!path)
+        return 0;
+    if(dev_ident(handle, &id)) /* the file is still checked */
+        id.vid = id.pid = 0;
+    return load_calibration(path, id.vid, id.pid, id.serial, cal);
+}
@@ -0,0 +1,157 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File analyzer.c
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#include <math.h> /* for cos, sin, sqrt, log */
+
+#include "analyzer.h"
+
+#define PI 3.14159265358979323846
+
+/* The band edges in Hz */
+static const unsigned int band_edges[AN_BANDS+1] = { 30, 250, 2000, 12000 };
+
+static void spectrum(struct analyzer *an);
+static void fft(struct analyzer *an);
+
+/* Functions */
+void analyzer_init(struct analyzer *an, int rate)
+{
+    unsigned int i, b;
+    an->rate = rate;
+    an->pos = an->fresh = 0;
+    an->rms = an->flux = an->onset_lag = 0;
+    an->since_window = an->peak_pos = 0;
+    an->hop_flux = an->hop_peak = 0;
+    for(i = 0; i < AN_FFT_SIZE; i++) {
+        unsigned int rev = 0, bit;
+        for(bit = 0; bit < AN_FFT_BITS; bit++) /* mirror the index bits */
+            rev |= ((i >> bit) & 1) << (AN_FFT_BITS-1 - bit);
+        an->bitrev[i] = (unsigned short)rev;
+        an->hann[i] = (float)(0.5 - 0.5*cos(2*PI*i / AN_FFT_SIZE));
+        an->ring[i] = 0;
+    }
+    for(i = 0; i < AN_BINS; i++) {
+        an->cosines[i] = (float)cos(2*PI*i / AN_FFT_SIZE);
+        an->sines[i] = (float)-sin(2*PI*i / AN_FFT_SIZE);
+        an->mag[i] = an->logmag[i] = 0;
+    }
+    for(b = 0; b < AN_BANDS; b++) {
+        an->band_lo[b] = band_edges[b] * AN_FFT_SIZE / rate;
+        an->band_hi[b] = band_edges[b+1] * AN_FFT_SIZE / rate;
+        if(an->band_lo[b] < 1) /* no DC */
+            an->band_lo[b] = 1;
+        if(an->band_hi[b] > AN_BINS)
+            an->band_hi[b] = AN_BINS;
+        if(an->band_hi[b] <= an->band_lo[b]) /* at least a bin per band */
+            an->band_hi[b] = an->band_lo[b]+1;
+        an->energy[b] = 0;
+    }
+}
+
+void analyzer_push(struct analyzer *an, const float *smp, int cnt)
+{
+    for(; cnt > 0; smp++, cnt--) {
+        an->ring[an->pos] = *smp;
+        an->pos = (an->pos+1) & (AN_FFT_SIZE-1);
+        an->fresh++;
+        if(++an->since_window == AN_FLUX_HOP)
+            spectrum(an);
+    }
+}
+
+void analyzer_run(struct analyzer *an)
+{
+    unsigned int i, b, hop;
+    float sum = 0;
+
+    /* The RMS of the new samples only, so it follows every hop */
+    hop = an->fresh < AN_FFT_SIZE ? an->fresh : AN_FFT_SIZE;
+    for(i = 1; i <= hop; i++) {
+        float s = an->ring[(an->pos - i) & (AN_FFT_SIZE-1)];
+        sum += s*s;
+    }
+    an->rms = hop ? (float)sqrt(sum / hop) : 0;
+
+    if(an->since_window > 0 || an->fresh == 0) /* the bands are the newest */
+        spectrum(an);
+    an->flux = an->hop_flux;
+    /* An onset is in the newer half of the window that found it */
+    an->onset_lag = (float)(an->fresh - an->peak_pos + AN_FLUX_HOP/2) /
+                    an->rate;
+    an->hop_flux = an->hop_peak = 0;
+    an->peak_pos = an->fresh = 0;
+    for(b = 0; b < AN_BANDS; b++) {
+        an->energy[b] = 0;
+        for(i = an->band_lo[b]; i < an->band_hi[b]; i++)
+            an->energy[b] += an->mag[i]*an->mag[i];
+    }
+}
+
+/* The magnitudes of the window and the flux against the window before */
+static void spectrum(struct analyzer *an)
+{
+    unsigned int i;
+    float flux = 0;
+    /* The oldest sample first */
+    for(i = 0; i < AN_FFT_SIZE; i++) {
+        an->re[an->bitrev[i]] =
+            an->ring[(an->pos + i) & (AN_FFT_SIZE-1)] * an->hann[i];
+        an->im[an->bitrev[i]] = 0;
+    }
+    fft(an);
+    for(i = 0; i < AN_BINS; i++) {
+        float lm;
+        an->mag[i] = (float)sqrt(an->re[i]*an->re[i] + an->im[i]*an->im[i]);
+        lm = (float)log(1.0f + AN_FLUX_GAIN*an->mag[i]);
+        if(lm > an->logmag[i]) /* the onsets only, not the decays */
+            flux += lm - an->logmag[i];
+        an->logmag[i] = lm;
+    }
+    an->hop_flux += flux;
+    if(flux > an->hop_peak) {
+        an->hop_peak = flux;
+        an->peak_pos = an->fresh;
+    }
+    an->since_window = 0;
+}
+
+/* In place, radix-2; the input is already in the bit-reversed order */
+static void fft(struct analyzer *an)
+{
+    unsigned int len, half, step, i, j;
+    for(len = 2; len <= AN_FFT_SIZE; len <<= 1) {
+        half = len >> 1;
+        step = AN_FFT_SIZE / len;
+        for(i = 0; i < AN_FFT_SIZE; i += len) {
+            for(j = 0; j < half; j++) {
+                float wr = an->cosines[j*step], wi = an->sines[j*step];
+                float *ar = &an->re[i+j], *ai = &an->im[i+j];
+                float *br = &an->re[i+j+half], *bi = &an->im[i+j+half];
+                float tr = *br*wr - *bi*wi, ti = *br*wi + *bi*wr;
+                *br = *ar - tr;
+                *bi = *ai - ti;
+                *ar += tr;
+                *ai += ti;
+            }
+        }
+    }
+}
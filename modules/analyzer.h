@@ -0,0 +1,71 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File analyzer.h
+ * Streaming audio analysis: the newest samples are kept in a ring and
+ * every hop (a frame sent to the microphone) the window is weighted,
+ * transformed with an FFT and summed into bands; the RMS of the hop and
+ * the spectral flux (how much louder the spectrum has got) are taken too.
+ * The flux is summed over windows every half a window while pushing, so
+ * no onset falls between the hops and its time is known finer.
+ * All the buffers and tables are inside the struct, made once.
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#ifndef ANALYZER_SENTRY
+#define ANALYZER_SENTRY
+
+/* Constants */
+#define AN_FFT_BITS 9
+#define AN_FFT_SIZE (1 << AN_FFT_BITS) /* 11.6 ms at 44.1 kHz */
+#define AN_BINS (AN_FFT_SIZE/2)
+#define AN_BANDS 3
+#define AN_FLUX_GAIN 10.0f /* of the log compression, log(1 + gain*mag) */
+#define AN_FLUX_HOP (AN_FFT_SIZE/2) /* samples between the flux windows */
+
+enum an_band { band_bass, band_mid, band_treble }; /* the order of edges */
+
+/* Structs */
+struct analyzer {
+    int rate;
+    float ring[AN_FFT_SIZE]; /* the newest samples */
+    unsigned int pos; /* where the next sample goes */
+    unsigned int fresh; /* samples pushed since the last hop */
+    float rms; /* of the last hop */
+    float energy[AN_BANDS]; /* of the last window */
+    float mag[AN_BINS]; /* the magnitudes of the last window */
+    float flux; /* the onset strength of the last hop */
+    float onset_lag; /* s, from the strongest onset of the hop to its end */
+    float logmag[AN_BINS]; /* compressed magnitudes of the window before */
+    unsigned int since_window; /* samples pushed since the last window */
+    float hop_flux, hop_peak; /* the sum and the strongest so far */
+    unsigned int peak_pos; /* the fresh samples at the strongest */
+    /* The preallocated work */
+    float re[AN_FFT_SIZE], im[AN_FFT_SIZE];
+    float hann[AN_FFT_SIZE];
+    float cosines[AN_BINS], sines[AN_BINS];
+    unsigned short bitrev[AN_FFT_SIZE];
+    unsigned int band_lo[AN_BANDS], band_hi[AN_BANDS]; /* the bins */
+};
+
+/* Functions */
+void analyzer_init(struct analyzer *an, int rate);
+void analyzer_push(struct analyzer *an, const float *smp, int cnt);
+void analyzer_run(struct analyzer *an); /* analyses one hop */
+
+#endif
@@ -24,6 +24,8 @@
  * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA. 
  */
 #include "argparser.h"
+#include "plugins.h" /* for load_plugin, find_plugin */
+#include "audio.h" /* for audio_is_file */
 
 /* Static declarations */
 static void set_arg(const char ***arg_pp, const char **argv_end,
@@ -34,13 +36,41 @@ static void set_mode(const char ***arg_pp, const char **argv_end,
                      int state, struct colschemes *cs);
 static void set_colors(const char ***arg_pp, const char **argv_end,
                        int state, struct colschemes *cs);
-static void write_default_cols(struct colschemes *cs, int state);
+static void set_file(const char ***arg_pp, const char **argv_end,
+                     int state, struct colschemes *cs);
+static void write_default_cols(struct colscheme *u, struct colscheme *l,
+                               int state);
+static void add_layer(const char **arg_p, const char **argv_end, int state,
+                      struct colschemes *cs);
+static void init_layer(struct colscheme *layer, int blend, int alpha);
+static void set_seed(const char **arg_p, const char **argv_end,
+                     struct colschemes *cs);
+static void set_phase(const char **arg_p, const char **argv_end,
+                      struct colschemes *cs);
+static void set_dim(const char **arg_p, const char **argv_end, int state,
+                    struct colschemes *cs);
+static void set_fade(const char **arg_p, const char **argv_end,
+                     struct colschemes *cs);
+static void set_rate(const char **arg_p, const char **argv_end,
+                     struct colschemes *cs);
+static void set_merge(const char **arg_p, const char **argv_end,
+                      struct colschemes *cs);
+static void set_cache(const char **arg_p, const char **argv_end,
+                      struct colschemes *cs);
+static void set_ahead(const char **arg_p, const char **argv_end,
+                      struct colschemes *cs);
+static void set_osc(const char **arg_p, const char **argv_end,
+                    struct colschemes *cs);
+static void set_path(const char **arg_p, const char **argv_end,
+                     struct colschemes *cs, const char **path);
 /* Bool functions */
 static int no_opt_param(const char **arg_p, const char **argv_end);
 static int is_color(const char **arg_p, const char **argv_end);
 static int ishexnumber(const char *str);
 static int is_number(const char *str);
 static int is_mode(const char *str);
+static int is_path_opt(const char *str);
+static int takes_param(const char *str);
 
 #define WRITE_PARAM(TYPE, FUNNAME) \
     static void FUNNAME(TYPE *u, TYPE *l, TYPE value, int state) \
@@ -56,9 +86,18 @@ static int is_mode(const char *str);
 WRITE_PARAM(int, write_int_param)
 WRITE_PARAM(const char *, write_str_param)
 
+/* The topmost layer of a group, all the options are written to it */
+#define TOP(CS, GROUP) \
+    ((CS)->GROUP##_ovl_cnt ? &((CS)->GROUP##_ovl[(CS)->GROUP##_ovl_cnt-1]) \
+                           : &((CS)->GROUP))
+
 /* Const arrays */
 const char *modes[MODES_CNT] = {
-    "solid", "blink", "cycle", "wave", "lightning", "pulse", "visualizer"
+    "solid", "blink", "cycle", "wave", "lightning", "pulse", "visualizer",
+    "keyframes", "beat", "shm", "openrgb"
+};
+static const char *blends[BLENDS_CNT] = {
+    "normal", "add", "multiply", "screen", "lighten"
 };
 static const int rainbow[RAINBOW_CNT] = {
     0xff0000, 0xff009e, 0xcd00ff,
@@ -66,29 +105,99 @@ static const int rainbow[RAINBOW_CNT] = {
     0x00ff67, 0x32ff00, 0xceff00,
     nocolor
 };
+static const int levels[LEVELS_CNT] = { /* visualizer, from quiet to loud */
+    0x2b00ff, 0xcd00ff, 0xff0000, nocolor
+};
 
 /* Functions */
 struct colschemes *parse_arg(int argc, const char **argv, int *verbose)
+{
+    struct colschemes *cs = parse_opts(argc, argv, verbose);
+    check_modes(cs);
+    if(cs->upper_dim == NOT_GIVEN)
+        cs->upper_dim = MAX_BR_SPD_DLY;
+    if(cs->lower_dim == NOT_GIVEN)
+        cs->lower_dim = MAX_BR_SPD_DLY;
+    if(cs->fade == NOT_GIVEN)
+        cs->fade = FADE_DEFAULT;
+    if(cs->rate == NOT_GIVEN)
+        cs->rate = RATE_DEFAULT;
+    if(cs->merge == NOT_GIVEN)
+        cs->merge = 0;
+    if(cs->cache == NOT_GIVEN)
+        cs->cache = CACHE_DEFAULT;
+    if(cs->ahead == NOT_GIVEN)
+        cs->ahead = 0;
+    return cs;
+}
+
+/* The playback options that aren't given stay NOT_GIVEN */
+struct colschemes *parse_opts(int argc, const char **argv, int *verbose)
 {
     struct colschemes *cs = malloc(sizeof(*cs));
     const char **arg_p;
     int cs_state = all;
 
     /* Set defaults */
-    cs->upper.br = cs->lower.br = MAX_BR_SPD_DLY;
-    cs->upper.spd = cs->lower.spd = SPD_DEFAULT;
-    cs->upper.dly = cs->lower.dly = DLY_DEFAULT;
-    cs->upper.mode = cs->lower.mode = NULL;
+    init_layer(&cs->upper, blend_normal, MAX_BR_SPD_DLY);
+    init_layer(&cs->lower, blend_normal, MAX_BR_SPD_DLY);
+    cs->upper_ovl_cnt = cs->lower_ovl_cnt = 0;
+    cs->seed = (unsigned long)time(NULL);
+    cs->phase = -1;
+    cs->scene_opts = 0;
+    cs->upper_dim = cs->lower_dim = NOT_GIVEN;
+    cs->fade = cs->rate = cs->merge = cs->cache = cs->ahead = NOT_GIVEN;
+    cs->image = cs->output = cs->calib = NULL;
+    cs->presets = cs->preset = NULL;
+    cs->osc = 0;
+    cs->midi = NULL;
+    cs->hotkeys = NULL;
 
     for(arg_p = argv+1; arg_p < argv+argc; arg_p++)
         set_arg(&arg_p, argv+argc-1, cs, &cs_state, verbose);
+    return cs;
+}
 
-    if(!(cs->upper.mode)) { /* any chosen group sets also the other */
+void check_modes(struct colschemes *cs)
+{
+    if(cs->image || cs->preset) /* the modes are in the file or preset */
+        return;
+    /* Any chosen group sets also the other, but a layer needs a base */
+    if(!(cs->upper.mode) || !(cs->lower.mode)) {
         fprintf(stderr, NOMODE_MSG);
         free(cs); exit(argerr);
     }
+    if(!(TOP(cs, upper)->mode) || !(TOP(cs, lower)->mode)) {
+        fprintf(stderr, NOLAYERMODE_MSG);
+        free(cs); exit(argerr);
+    }
+}
 
-    return cs;
+int has_scene(const struct colschemes *cs)
+{
+    return cs->image || cs->preset || cs->upper.mode || cs->lower.mode ||
+           cs->upper_ovl_cnt || cs->lower_ovl_cnt;
+}
+
+/* A plugin without a slash is looked for as dlopen does it */
+void find_paths(int argc, const char **argv, char *paths)
+{
+    const char *opt;
+    int i;
+    for(i = 0; i < argc; i++)
+        paths[i] = 0;
+    for(i = 1; i+1 < argc; i++) {
+        opt = argv[i];
+        if(is_path_opt(opt) || strequ(opt, modes[7])) /* keyframes too */
+            paths[i+1] = 1;
+        else if(strequ(opt, "-p") || strequ(opt, "--plugin"))
+            paths[i+1] = strchr(argv[i+1], '/') != NULL;
+        else if(strequ(opt, modes[6]) || strequ(opt, modes[8]))
+            paths[i+1] = audio_is_file(argv[i+1]);
+        else if(!takes_param(opt))
+            continue;
+        i++; /* skip option's parameter */
+    }
 }
 
 int strequ(const char *str1, const char *str2)
@@ -114,13 +223,84 @@ static void set_arg(const char ***arg_pp, const char **argv_end,
         *state = upper;
     } else if(strequ(**arg_pp, "-l") || strequ(**arg_pp, "--lower")) {
         *state = lower;
+    } else if(strequ(**arg_pp, "--merge")) {
+        set_merge(*arg_pp, argv_end, cs);
+        (*arg_pp)++; /* skip option's parameter */
+    } else if(strequ(**arg_pp, "--ahead")) {
+        set_ahead(*arg_pp, argv_end, cs);
+        (*arg_pp)++; /* skip option's parameter */
+    } else if(strequ(**arg_pp, "--osc")) {
+        set_osc(*arg_pp, argv_end, cs);
+        (*arg_pp)++; /* skip option's parameter */
+    } else if(strequ(**arg_pp, "--midi")) {
+        set_path(*arg_pp, argv_end, cs, &cs->midi); /* not a path, alike */
+        (*arg_pp)++; /* skip option's parameter */
+    } else if(strequ(**arg_pp, "--hotkeys")) {
+        set_path(*arg_pp, argv_end, cs, &cs->hotkeys);
+        (*arg_pp)++; /* skip option's parameter */
     } else if(strequ(**arg_pp, "-b") || strequ(**arg_pp, "-s") ||
                                         strequ(**arg_pp, "-d")) {
         set_br_spd_dly(*arg_pp, argv_end, *state, cs);
+        cs->scene_opts = 1;
+        (*arg_pp)++; /* skip option's parameter */
+    } else if(strequ(**arg_pp, "-L") || strequ(**arg_pp, "--layer")) {
+        add_layer(*arg_pp, argv_end, *state, cs);
+        (*arg_pp)++; /* skip option's parameter */
+    } else if(strequ(**arg_pp, "--seed")) {
+        set_seed(*arg_pp, argv_end, cs);
+        cs->scene_opts = 1;
+        (*arg_pp)++; /* skip option's parameter */
+    } else if(strequ(**arg_pp, "--phase")) {
+        set_phase(*arg_pp, argv_end, cs);
+        cs->scene_opts = 1;
+        (*arg_pp)++; /* skip option's parameter */
+    } else if(strequ(**arg_pp, "--dim")) {
+        set_dim(*arg_pp, argv_end, *state, cs);
+        (*arg_pp)++; /* skip option's parameter */
+    } else if(strequ(**arg_pp, "--fade")) {
+        set_fade(*arg_pp, argv_end, cs);
         (*arg_pp)++; /* skip option's parameter */
+    } else if(strequ(**arg_pp, "--rate")) {
+        set_rate(*arg_pp, argv_end, cs);
+        (*arg_pp)++; /* skip option's parameter */
+    } else if(strequ(**arg_pp, "-f") || strequ(**arg_pp, "--file")) {
+        set_path(*arg_pp, argv_end, cs, &cs->image);
+        (*arg_pp)++; /* skip option's parameter */
+    } else if(strequ(**arg_pp, "-o") || strequ(**arg_pp, "--output")) {
+        set_path(*arg_pp, argv_end, cs, &cs->output);
+        (*arg_pp)++; /* skip option's parameter */
+    } else if(strequ(**arg_pp, "--calib")) {
+        set_path(*arg_pp, argv_end, cs, &cs->calib);
+        (*arg_pp)++; /* skip option's parameter */
+    } else if(strequ(**arg_pp, "--presets")) {
+        set_path(*arg_pp, argv_end, cs, &cs->presets);
+        (*arg_pp)++; /* skip option's parameter */
+    } else if(strequ(**arg_pp, "-P") || strequ(**arg_pp, "--preset")) {
+        set_path(*arg_pp, argv_end, cs, &cs->preset); /* not a path, alike */
+        (*arg_pp)++; /* skip option's parameter */
+    } else if(strequ(**arg_pp, "--preset-cache")) {
+        set_cache(*arg_pp, argv_end, cs);
+        (*arg_pp)++; /* skip option's parameter */
+    } else if(strequ(**arg_pp, "-p") || strequ(**arg_pp, "--plugin")) {
+        if(*arg_pp == argv_end) {
+            fprintf(stderr, NOPARAM_LONG_MSG, **arg_pp);
+            free(cs); exit(argerr);
+        }
+        (*arg_pp)++;
+        if(load_plugin(**arg_pp)) { /* the reason is already printed */
+            free(cs); exit(argerr);
+        }
     } else if(is_mode(**arg_pp)) {
         set_mode(arg_pp, argv_end, *state, cs);
-        set_colors(arg_pp, argv_end, *state, cs);
+        if(strequ(**arg_pp, modes[7]) || strequ(**arg_pp, modes[9]) ||
+                                        strequ(**arg_pp, modes[10])) {
+            /* keyframes: a file, shm: a name, openrgb: a port, no colors */
+            set_file(arg_pp, argv_end, *state, cs);
+        } else {
+            if(strequ(**arg_pp, modes[6]) || strequ(**arg_pp, modes[8]))
+                set_file(arg_pp, argv_end, *state, cs); /* audio, colors */
+            set_colors(arg_pp, argv_end, *state, cs);
+        }
     } else {
         fprintf(stderr, BADARG_MSG, **arg_pp);
         free(cs); exit(argerr);
@@ -134,12 +314,36 @@ static int is_mode(const char *str)
         if(strequ(modes[i], str))
             return 1;
     }
-    return 0;
+    return find_plugin(str) != NULL;
+}
+
+static int is_path_opt(const char *str)
+{
+    return strequ(str, "-f") || strequ(str, "--file") || strequ(str, "-o") ||
+           strequ(str, "--output") || strequ(str, "--calib") ||
+           strequ(str, "--presets") || strequ(str, "--hotkeys");
+}
+
+/* Of the others, the shm name and the openrgb port too */
+static int takes_param(const char *str)
+{
+    static const char *opts[] = {
+        "--merge", "--ahead", "--osc", "--midi", "-b", "-s", "-d", "-L",
+        "--layer", "--seed", "--phase", "--dim", "--fade", "--rate", "-P",
+        "--preset", "--preset-cache", NULL
+    };
+    const char **opt;
+    for(opt = opts; *opt; opt++) {
+        if(strequ(*opt, str))
+            return 1;
+    }
+    return strequ(str, modes[9]) || strequ(str, modes[10]);
 }
 
 static void set_br_spd_dly(const char **arg_p, const char **argv_end,
                            int state, struct colschemes *cs)
 {
+    struct colscheme *u = TOP(cs, upper), *l = TOP(cs, lower);
     short num;
     if(no_opt_param(arg_p, argv_end)) {
         fprintf(stderr, NOPARAM_SHORT_MSG, *arg_p);
@@ -151,14 +355,208 @@ static void set_br_spd_dly(const char **arg_p, const char **argv_end,
         free(cs); exit(argerr);
     }
     if(strequ(*arg_p, "-b")) {        /* brightness */
-        write_int_param(&(cs->upper.br), &(cs->lower.br), num, state);
+        write_int_param(&(u->br), &(l->br), num, state);
     } else if(strequ(*arg_p, "-s")) { /* speed */
-        write_int_param(&(cs->upper.spd), &(cs->lower.spd), num, state);
+        write_int_param(&(u->spd), &(l->spd), num, state);
     } else if(strequ(*arg_p, "-d")) { /* delay */
-        write_int_param(&(cs->upper.dly), &(cs->lower.dly), num, state);
+        write_int_param(&(u->dly), &(l->dly), num, state);
     }
 }
 
+/* Any base is accepted: 42, 0x2a, 052 */
+static void set_seed(const char **arg_p, const char **argv_end,
+                     struct colschemes *cs)
+{
+    char *end;
+    if(arg_p == argv_end) {
+        fprintf(stderr, NOPARAM_LONG_MSG, *arg_p);
+        free(cs); exit(argerr);
+    }
+    cs->seed = strtoul(*(arg_p+1), &end, 0);
+    if(**(arg_p+1) == '-' || **(arg_p+1) == '\0' || *end != '\0') {
+        fprintf(stderr, BADSEED_MSG, *arg_p);
+        free(cs); exit(argerr);
+    }
+}
+
+static void set_phase(const char **arg_p, const char **argv_end,
+                      struct colschemes *cs)
+{
+    if(no_opt_param(arg_p, argv_end)) {
+        fprintf(stderr, NOPARAM_SHORT_MSG, *arg_p);
+        free(cs); exit(argerr);
+    }
+    cs->phase = atoi(*(arg_p+1));
+    if(cs->phase > MAX_BR_SPD_DLY) {
+        fprintf(stderr, BS_BADPARAM_MSG, *arg_p);
+        free(cs); exit(argerr);
+    }
+}
+
+/* Unlike -b, it's for the whole group and applied while playing */
+static void set_dim(const char **arg_p, const char **argv_end, int state,
+                    struct colschemes *cs)
+{
+    int num;
+    if(no_opt_param(arg_p, argv_end)) {
+        fprintf(stderr, NOPARAM_SHORT_MSG, *arg_p);
+        free(cs); exit(argerr);
+    }
+    num = atoi(*(arg_p+1));
+    if(num > MAX_BR_SPD_DLY) {
+        fprintf(stderr, BS_BADPARAM_MSG, *arg_p);
+        free(cs); exit(argerr);
+    }
+    write_int_param(&cs->upper_dim, &cs->lower_dim, num, state);
+}
+
+static void set_fade(const char **arg_p, const char **argv_end,
+                     struct colschemes *cs)
+{
+    if(no_opt_param(arg_p, argv_end)) {
+        fprintf(stderr, NOPARAM_SHORT_MSG, *arg_p);
+        free(cs); exit(argerr);
+    }
+    cs->fade = atoi(*(arg_p+1));
+    if(cs->fade > MAX_FADE_MS) {
+        fprintf(stderr, BADFADE_MSG, *arg_p, MAX_FADE_MS);
+        free(cs); exit(argerr);
+    }
+}
+
+/* Unlike -s, it's for the whole scene and applied while playing */
+static void set_rate(const char **arg_p, const char **argv_end,
+                     struct colschemes *cs)
+{
+    if(no_opt_param(arg_p, argv_end)) {
+        fprintf(stderr, NOPARAM_SHORT_MSG, *arg_p);
+        free(cs); exit(argerr);
+    }
+    cs->rate = atoi(*(arg_p+1));
+    if(cs->rate < 1 || cs->rate > MAX_RATE) {
+        fprintf(stderr, BADRATE_MSG, *arg_p, MAX_RATE);
+        free(cs); exit(argerr);
+    }
+}
+
+static void set_merge(const char **arg_p, const char **argv_end,
+                      struct colschemes *cs)
+{
+    if(no_opt_param(arg_p, argv_end)) {
+        fprintf(stderr, NOPARAM_SHORT_MSG, *arg_p);
+        free(cs); exit(argerr);
+    }
+    cs->merge = atoi(*(arg_p+1));
+    if(cs->merge > MAX_BR_SPD_DLY) {
+        fprintf(stderr, BS_BADPARAM_MSG, *arg_p);
+        free(cs); exit(argerr);
+    }
+}
+
+static void set_cache(const char **arg_p, const char **argv_end,
+                      struct colschemes *cs)
+{
+    if(no_opt_param(arg_p, argv_end)) {
+        fprintf(stderr, NOPARAM_SHORT_MSG, *arg_p);
+        free(cs); exit(argerr);
+    }
+    cs->cache = atoi(*(arg_p+1));
+    if(cs->cache > MAX_CACHE) {
+        fprintf(stderr, BADCACHE_MSG, *arg_p, MAX_CACHE);
+        free(cs); exit(argerr);
+    }
+}
+
+static void set_ahead(const char **arg_p, const char **argv_end,
+                      struct colschemes *cs)
+{
+    if(no_opt_param(arg_p, argv_end)) {
+        fprintf(stderr, NOPARAM_SHORT_MSG, *arg_p);
+        free(cs); exit(argerr);
+    }
+    cs->ahead = atoi(*(arg_p+1));
+    if(cs->ahead > MAX_AHEAD) {
+        fprintf(stderr, BADAHEAD_MSG, *arg_p, MAX_AHEAD);
+        free(cs); exit(argerr);
+    }
+}
+
+static void set_osc(const char **arg_p, const char **argv_end,
+                    struct colschemes *cs)
+{
+    if(no_opt_param(arg_p, argv_end)) {
+        fprintf(stderr, NOPARAM_SHORT_MSG, *arg_p);
+        free(cs); exit(argerr);
+    }
+    cs->osc = atoi(*(arg_p+1));
+    if(cs->osc < 1 || cs->osc > MAX_PORT) {
+        fprintf(stderr, BADPORT_MSG, *arg_p, MAX_PORT);
+        free(cs); exit(argerr);
+    }
+}
+
+static void set_path(const char **arg_p, const char **argv_end,
+                     struct colschemes *cs, const char **path)
+{
+    if(arg_p == argv_end) {
+        fprintf(stderr, NOPARAM_LONG_MSG, *arg_p);
+        free(cs); exit(argerr);
+    }
+    *path = *(arg_p+1);
+}
+
+/* Stacks a new layer over the selected group(s), "-L blend[:alpha]" */
+static void add_layer(const char **arg_p, const char **argv_end, int state,
+                      struct colschemes *cs)
+{
+    const char *colon;
+    int blend, alpha = MAX_BR_SPD_DLY;
+    size_t name_len;
+    if(arg_p == argv_end) {
+        fprintf(stderr, NOPARAM_LONG_MSG, *arg_p);
+        free(cs); exit(argerr);
+    }
+    colon = strchr(*(arg_p+1), ':');
+    name_len = colon ? (size_t)(colon - *(arg_p+1)) : strlen(*(arg_p+1));
+    for(blend = 0; blend < BLENDS_CNT; blend++) {
+        if(strlen(blends[blend]) == name_len &&
+                            0 == strncmp(blends[blend], *(arg_p+1), name_len))
+            break;
+    }
+    if(colon) {
+        if(!*(colon+1) || !is_number(colon+1) ||
+                                      atoi(colon+1) > MAX_BR_SPD_DLY)
+            blend = BLENDS_CNT; /* report as a bad parameter */
+        else
+            alpha = atoi(colon+1);
+    }
+    if(blend == BLENDS_CNT) {
+        fprintf(stderr, BADLAYER_MSG, *(arg_p+1));
+        free(cs); exit(argerr);
+    }
+    if((state != lower && cs->upper_ovl_cnt >= MAX_LAYERS-1) ||
+       (state != upper && cs->lower_ovl_cnt >= MAX_LAYERS-1)) {
+        fprintf(stderr, MAXLAYER_MSG, MAX_LAYERS);
+        free(cs); exit(argerr);
+    }
+    if(state != lower)
+        init_layer(&cs->upper_ovl[cs->upper_ovl_cnt++], blend, alpha);
+    if(state != upper)
+        init_layer(&cs->lower_ovl[cs->lower_ovl_cnt++], blend, alpha);
+}
+
+static void init_layer(struct colscheme *layer, int blend, int alpha)
+{
+    layer->mode = NULL;
+    layer->colors[0] = nocolor;
+    layer->br = MAX_BR_SPD_DLY;
+    layer->spd = SPD_DEFAULT;
+    layer->dly = DLY_DEFAULT;
+    layer->file = NULL;
+    layer->blend = blend;
+    layer->alpha = alpha;
+}
+
 static int is_number(const char *str)
 {
     /* Very primitive check, but enough for no_opt_param */
@@ -177,9 +575,11 @@ static int no_opt_param(const char **arg_p, const char **argv_end)
 static void set_mode(const char ***arg_pp, const char **argv_end,
                      int state, struct colschemes *cs)
 {
-    write_str_param(&(cs->upper.mode), &(cs->lower.mode), **arg_pp, state);
-    if(!(cs->upper.mode) || !(cs->lower.mode)) { /* write solid to the other */
-        int swap = (state == upper) ? lower : upper; /* state != all */
+    write_str_param(&(TOP(cs, upper)->mode), &(TOP(cs, lower)->mode),
+                    **arg_pp, state);
+    if(state != all && (!(cs->upper.mode) || !(cs->lower.mode))) {
+        /* write solid to the other */
+        int swap = (state == upper) ? lower : upper;
         write_str_param(&(cs->upper.mode), &(cs->lower.mode), modes[0], swap);
         write_int_param(cs->upper.colors, cs->lower.colors, black, swap);
         write_int_param(cs->upper.colors+1, cs->lower.colors+1, nocolor,
@@ -190,8 +590,9 @@ static void set_mode(const char ***arg_pp, const char **argv_end,
 static void set_colors(const char ***arg_pp, const char **argv_end,
                        int state, struct colschemes *cs)
 {
+    struct colscheme *u = TOP(cs, upper), *l = TOP(cs, lower);
     if(!is_color(*arg_pp+1, argv_end)) {
-        write_default_cols(cs, state);
+        write_default_cols(u, l, state);
     } else {
         int col_cnt = 0;
 
@@ -203,32 +604,50 @@ static void set_colors(const char ***arg_pp, const char **argv_end,
             else
                 hexnum = (int)strtol(**arg_pp, NULL, 16);
 
-            write_int_param(&(cs->upper.colors[col_cnt]),
-                            &(cs->lower.colors[col_cnt]), hexnum, state);
+            write_int_param(&(u->colors[col_cnt]), &(l->colors[col_cnt]),
+                            hexnum, state);
             col_cnt++;
         } while(is_color(*arg_pp+1, argv_end) && col_cnt < COLORS_CNT);
 
-        write_int_param(&(cs->upper.colors[col_cnt]),
-                        &(cs->lower.colors[col_cnt]), nocolor, state);
+        write_int_param(&(u->colors[col_cnt]), &(l->colors[col_cnt]),
+                        nocolor, state);
+    }
+}
+
+static void set_file(const char ***arg_pp, const char **argv_end,
+                     int state, struct colschemes *cs)
+{
+    struct colscheme *u = TOP(cs, upper), *l = TOP(cs, lower);
+    if(*arg_pp == argv_end) {
+        fprintf(stderr, NOPARAM_LONG_MSG, **arg_pp);
+        free(cs); exit(argerr);
     }
+    (*arg_pp)++;
+    write_str_param(&(u->file), &(l->file), **arg_pp, state);
+    write_int_param(&(u->colors[0]), &(l->colors[0]), nocolor, state);
 }
 
-static void write_default_cols(struct colschemes *cs, int state)
+static void write_default_cols(struct colscheme *u, struct colscheme *l,
+                               int state)
 {
-    const char *md = (state == upper) ? cs->upper.mode : cs->lower.mode;
+    const char *md = (state == upper) ? u->mode : l->mode;
     if(strequ(md, modes[2]) || strequ(md, modes[3])) { /* cycle or wave */
         int i;
         for(i = 0; i < RAINBOW_CNT; i++) {
-            write_int_param(&(cs->upper.colors[i]), &(cs->lower.colors[i]),
+            write_int_param(&(u->colors[i]), &(l->colors[i]),
                             rainbow[i], state);
         }
     } else if(strequ(md, modes[1])) { /* blink */
-        write_int_param(cs->upper.colors, cs->lower.colors,
-                        nocolor, state);
-    } else { /* solid, lightning, pulse */
-        write_int_param(cs->upper.colors, cs->lower.colors, red, state);
-        write_int_param(cs->upper.colors+1, cs->lower.colors+1, nocolor,
-                        state);
+        write_int_param(u->colors, l->colors, nocolor, state);
+    } else if(strequ(md, modes[6])) { /* visualizer */
+        int i;
+        for(i = 0; i < LEVELS_CNT; i++) {
+            write_int_param(&(u->colors[i]), &(l->colors[i]),
+                            levels[i], state);
+        }
+    } else { /* solid, lightning, pulse, beat */
+        write_int_param(u->colors, l->colors, red, state);
+        write_int_param(u->colors+1, l->colors+1, nocolor, state);
     }
 }
 
@@ -31,17 +31,30 @@
 #define ARGPARSER_SENTRY
 
 #include <stdio.h> /* for fprintf */
-#include <stdlib.h> /* for malloc, exit, atoi */
-#include <string.h> /* for strcmp */
+#include <stdlib.h> /* for malloc, exit, atoi, strtoul */
+#include <string.h> /* for strcmp, strchr */
+#include <time.h> /* for time, the default seed */
 #include "locale_macros.h"
 
 /* Constants */
 #define COLORS_CNT 11
-#define MODES_CNT 7
+#define MODES_CNT 11
 #define RAINBOW_CNT 10
+#define LEVELS_CNT 4
 #define MAX_BR_SPD_DLY 100
 #define SPD_DEFAULT 81
 #define DLY_DEFAULT 10
+#define FADE_DEFAULT 500 /* ms */
+#define MAX_FADE_MS 60000
+#define RATE_DEFAULT 100 /* percents of the normal playback rate */
+#define MAX_RATE 1000
+#define CACHE_DEFAULT 4096 /* KiB of the built presets kept */
+#define MAX_CACHE 1048576
+#define MAX_AHEAD 15 /* frames, the ring of the pipeline has one more */
+#define MAX_PORT 65535
+#define MAX_LAYERS 4 /* per diode group, the base layer included */
+#define BLENDS_CNT 5
+#define NOT_GIVEN (-1) /* the playback options left for parse_arg */
 
 enum hexcolors {
     red = 0xf20000,
@@ -53,20 +66,51 @@ enum arg_exitcodes { success, argerr }; /* exitcodes */
 
 enum diode_group { all, upper, lower }; /* state values */
 
+enum blend_mode { /* the order of the blends array */
+    blend_normal, blend_add, blend_multiply, blend_screen, blend_lighten
+};
+
 /* Messages */
 #ifndef VERSION
 #define VERSION "unknown"
 #endif
 #define VERSION_MESSAGE "quadcastrgb version " VERSION
-#define HELP_MESSAGE _("Usage: quadcastrgb [-h] [-v] [-a|-u|-l] [-b bright] "\
-                     "[-s speed] mode [COLORS]...\nAvailable modes: "\
-                     "solid, blink, cycle, lightning, wave. Colors are hex "\
-                     "numbers.\nSee 'man quadcastrgb' for details.")
+#define HELP_MESSAGE _("Usage: quadcastrgb [-h] [-v] [-p plugin.so]... "\
+                     "[--seed N] [--phase N] [--calib FILE] "\
+                     "[--fade MS] [--rate N] [--merge N] [--ahead N] "\
+                     "[--osc PORT] [--midi SOURCE] [--hotkeys FILE] "\
+                     "[-a|-u|-l] [--dim N] "\
+                     "[-L blend[:alpha]] "\
+                     "[-b bright] [-s speed] mode [COLORS]...\n"\
+                     "       quadcastrgb compile [OPTIONS] mode [COLORS]... "\
+                     "-o scene.qrgb\n"\
+                     "       quadcastrgb [-v] [--calib FILE] [--dim N] "\
+                     "-f scene.qrgb\n"\
+                     "       quadcastrgb [-v] [--presets FILE] "\
+                     "[--preset-cache KIB] -P NAME|ID\n"\
+                     "       quadcastrgb stats [OPTIONS] mode [COLORS]...\n"\
+                     "       quadcastrgb ctl [OPTIONS] [mode [COLORS]...]\n"\
+                     "       quadcastrgb beattest clicks.wav\n"\
+                     "Available modes: solid, blink, cycle, lightning, wave, "\
+                     "pulse, keyframes FILE, visualizer AUDIO, beat AUDIO, "\
+                     "shm NAME, openrgb PORT and the ones of loaded plugins. "\
+                     "Colors are hex numbers.\n"\
+                     "See 'man quadcastrgb' for details.")
 #define BADARG_MSG   _("Unknown option: %s\n")
 #define NOPARAM_LONG_MSG _("%s: no parameter(s) specified\n")
 #define NOPARAM_SHORT_MSG _("%s: no parameter or it isn't a natural number\n")
 #define BS_BADPARAM_MSG _("%s: the parameter must be an integer 0-100\n")
 #define NOMODE_MSG _("No mode specified (solid|blink|cycle|lightning|wave)\n")
+#define BADLAYER_MSG _("%s: expected blend[:alpha], blend is one of normal, "\
+                       "add, multiply, screen, lighten; alpha is 0-100\n")
+#define MAXLAYER_MSG _("Too many layers, the limit is %d per group\n")
+#define NOLAYERMODE_MSG _("A layer has no mode specified\n")
+#define BADSEED_MSG _("%s: the parameter must be a non-negative integer\n")
+#define BADFADE_MSG _("%s: the parameter must be 0-%d ms\n")
+#define BADRATE_MSG _("%s: the parameter must be 1-%d percent\n")
+#define BADCACHE_MSG _("%s: the parameter must be 0-%d KiB\n")
+#define BADAHEAD_MSG _("%s: the parameter must be 0-%d frames\n")
+#define BADPORT_MSG _("%s: the parameter must be a port 1-%d\n")
 
 /* Structs */
 struct colscheme {
@@ -75,15 +119,46 @@ struct colscheme {
     int br;
     int spd; /* ignored in solid */
     int dly; /* blink-only */
+    const char *file; /* keyframes: the file, visualizer, beat: the audio */
+    int blend; /* how the layer covers the ones below, enum blend_mode */
+    int alpha; /* 0-100, the opacity of the layer */
 };
 
 struct colschemes {
     struct colscheme upper; /* for the upper diode */
     struct colscheme lower; /* for the lower diodes */
+    /* Layers stacked over the ones above, the bottom one goes first */
+    struct colscheme upper_ovl[MAX_LAYERS-1];
+    struct colscheme lower_ovl[MAX_LAYERS-1];
+    int upper_ovl_cnt, lower_ovl_cnt;
+    unsigned long seed; /* for the random colors, the same seed - same show */
+    int phase; /* 0-100% of a color the lower group is ahead, -1: mode's */
+    int scene_opts; /* -b, -s, -d, --seed or --phase given, they need modes */
+    int upper_dim, lower_dim; /* 0-100%, the master brightness of a group */
+    const char *image; /* a compiled scene to play instead */
+    const char *output; /* where compile writes the scene */
+    const char *calib; /* the color correction profiles, NULL if none */
+    const char *presets; /* the library of presets to load */
+    const char *preset; /* the name or the number of one to play instead */
+    int cache; /* KiB of the built presets kept */
+    int fade; /* ms of a crossfade when the running scene is replaced */
+    int rate; /* percents of the normal rate the scene is played at */
+    int merge; /* L* the frames may differ by to be sent as one, 0-100 */
+    int ahead; /* frames made in advance by a thread of their own, 0: none */
+    int osc; /* the UDP port of the live control, 0 if none */
+    const char *midi; /* the ALSA sequencer source of it, NULL if none */
+    const char *hotkeys; /* the key combinations switching presets */
 };
 
 /* Functions */
 struct colschemes *parse_arg(int argc, const char **argv, int *verbose);
+/* The parts of parse_arg for a change of the running scene */
+struct colschemes *parse_opts(int argc, const char **argv, int *verbose);
+void check_modes(struct colschemes *cs);
+int has_scene(const struct colschemes *cs); /* modes, file or preset */
+/* paths[i] is 1 for the arguments naming files as parse_opts takes them,
+ * nothing is checked or loaded */
+void find_paths(int argc, const char **argv, char *paths);
 int strequ(const char *str1, const char *str2);
 
 #endif
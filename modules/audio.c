@@ -0,0 +1,313 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File audio.c
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#include <stdio.h> /* for fprintf */
+#include <string.h> /* for strcmp, strncmp, memcmp, memcpy, strerror */
+#include <errno.h> /* for errno */
+#include <fcntl.h> /* for open, fcntl */
+#include <unistd.h> /* for read, lseek, close, dup */
+#include <sys/stat.h> /* for fstat */
+
+#include "audio.h"
+
+#define WAV_HEAD_LEN 12 /* "RIFF", size, "WAVE" */
+#define WAV_FMT_LEN 16
+#define WAV_PCM 1
+#define WAV_EXTENSIBLE 0xfffe
+
+static int open_alsa(struct audio *au, const char *dev);
+static int parse_wav(struct audio *au, const char *src);
+static int set_blocking(int fd, int blocking);
+static int read_full(int fd, unsigned char *buf, int len);
+static int skip_bytes(int fd, unsigned long len);
+static int frames_due(struct audio *au);
+static int read_frames(struct audio *au, int frames);
+#ifdef WITH_ALSA
+static int read_alsa(struct audio *au, int frames);
+#endif
+static unsigned long get_le(const unsigned char *mem, int bytes);
+
+/* Functions */
+int audio_open(struct audio *au, const char *src)
+{
+    struct stat st;
+    unsigned char head[WAV_HEAD_LEN];
+    int got, is_stdin = (0 == strcmp(src, "-"));
+
+    au->rate = AUDIO_RATE;
+    au->channels = AUDIO_CHANNELS;
+    au->paced = au->seekable = 0;
+    au->data_start = 0;
+    au->started = 0;
+    au->consumed = 0;
+    au->carry_len = 0;
+    au->fd = -1;
+    #ifdef WITH_ALSA
+    au->pcm = NULL;
+    #endif
+    if(0 == strncmp(src, AUDIO_ALSA_PREFIX, strlen(AUDIO_ALSA_PREFIX)))
+        return open_alsa(au, src + strlen(AUDIO_ALSA_PREFIX));
+
+    /* stdin is duplicated as the daemon closes it; a FIFO mustn't wait
+     * for its writer */
+    au->fd = is_stdin ? dup(STDIN_FILENO) : open(src, O_RDONLY | O_NONBLOCK);
+    if(au->fd < 0 || fstat(au->fd, &st)) {
+        fprintf(stderr, AUDIO_OPEN_ERR_MSG, src, strerror(errno));
+        audio_close(au);
+        return 1;
+    }
+    au->seekable = S_ISREG(st.st_mode);
+    if(S_ISFIFO(st.st_mode) && !is_stdin) /* live raw PCM */
+        return 0;
+
+    set_blocking(au->fd, 1);
+    got = read_full(au->fd, head, WAV_HEAD_LEN);
+    if(got == WAV_HEAD_LEN && 0 == memcmp(head, "RIFF", 4) &&
+                              0 == memcmp(head+8, "WAVE", 4)) {
+        if(parse_wav(au, src)) {
+            audio_close(au);
+            return 1;
+        }
+        au->paced = 1;
+    } else if(au->seekable) { /* a raw recording */
+        lseek(au->fd, 0, SEEK_SET);
+        au->paced = 1;
+    } else { /* these are samples already */
+        memcpy(au->carry, head, got > 0 ? got : 0);
+        au->carry_len = got > 0 ? got : 0;
+    }
+    if(!au->paced)
+        set_blocking(au->fd, 0);
+    return 0;
+}
+
+void audio_close(struct audio *au)
+{
+    if(au->fd >= 0)
+        close(au->fd);
+    au->fd = -1;
+    #ifdef WITH_ALSA
+    if(au->pcm)
+        snd_pcm_close(au->pcm);
+    au->pcm = NULL;
+    #endif
+}
+
+int audio_is_file(const char *src)
+{
+    return strcmp(src, "-") != 0 &&
+           strncmp(src, AUDIO_ALSA_PREFIX, strlen(AUDIO_ALSA_PREFIX)) != 0;
+}
+
+int audio_read(struct audio *au, float *out, int max)
+{
+    int i, c, n, frames = max;
+    const unsigned char *smp;
+
+    if(frames > AUDIO_BUF_FRAMES)
+        frames = AUDIO_BUF_FRAMES;
+    if(au->paced) {
+        n = frames_due(au);
+        if(n < frames)
+            frames = n;
+    }
+    if(frames <= 0)
+        return 0;
+    #ifdef WITH_ALSA
+    if(au->pcm)
+        n = read_alsa(au, frames);
+    else
+    #endif
+        n = read_frames(au, frames);
+    for(i = 0, smp = au->buf; i < n; i++) {
+        long sum = 0;
+        for(c = 0; c < au->channels; c++, smp += 2)
+            sum += (short)(smp[0] | (smp[1] << 8));
+        out[i] = (float)sum / (32768.0f * au->channels);
+    }
+    au->consumed += n;
+    return n;
+}
+
+/* How many frames a recording should have played by now */
+static int frames_due(struct audio *au)
+{
+    struct timespec now;
+    double elapsed;
+    unsigned long played;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if(!au->started) { /* pacing starts with the first frame sent */
+        au->start = now;
+        au->started = 1;
+    }
+    elapsed = (double)(now.tv_sec - au->start.tv_sec) +
+              (now.tv_nsec - au->start.tv_nsec) / 1e9;
+    played = (unsigned long)(elapsed * au->rate);
+    if(played <= au->consumed)
+        return 0;
+    if(played - au->consumed > (unsigned long)au->rate*AUDIO_MAX_CATCHUP)
+        au->consumed = played - au->rate*AUDIO_MAX_CATCHUP; /* skip a stall */
+    return (int)(played - au->consumed);
+}
+
+/* Reads into buf, a partial frame is carried over to the next time */
+static int read_frames(struct audio *au, int frames)
+{
+    int fsize = au->channels*2, want = frames*fsize;
+    int got = au->carry_len, looped = 0;
+    memcpy(au->buf, au->carry, au->carry_len);
+    while(got < want) {
+        ssize_t r = read(au->fd, au->buf+got, want-got);
+        if(r > 0) {
+            got += (int)r;
+            looped = 0;
+        } else if(r == 0 && au->seekable && !looped) { /* loop the file */
+            lseek(au->fd, au->data_start, SEEK_SET);
+            looped = 1;
+        } else { /* no more for now, the end of a stream, or an error */
+            break;
+        }
+        if(!au->paced) /* live: take what's there, the caller asks again */
+            break;
+    }
+    au->carry_len = got % fsize;
+    memcpy(au->carry, au->buf + got - au->carry_len, au->carry_len);
+    return got / fsize;
+}
+
+/* Goes through the chunks up to the samples, takes the format on the way */
+static int parse_wav(struct audio *au, const char *src)
+{
+    unsigned char hdr[8], fmt[WAV_FMT_LEN];
+    unsigned long size, pos = WAV_HEAD_LEN;
+    int has_fmt = 0, bits = 0;
+
+    while(read_full(au->fd, hdr, 8) == 8) {
+        pos += 8;
+        size = get_le(hdr+4, 4);
+        if(0 == memcmp(hdr, "data", 4)) {
+            if(!has_fmt)
+                break;
+            au->data_start = (long)pos;
+            return 0;
+        }
+        if(0 == memcmp(hdr, "fmt ", 4) && size >= WAV_FMT_LEN) {
+            unsigned long format;
+            if(read_full(au->fd, fmt, WAV_FMT_LEN) != WAV_FMT_LEN)
+                break;
+            format = get_le(fmt, 2);
+            au->channels = (int)get_le(fmt+2, 2);
+            au->rate = (int)get_le(fmt+4, 4);
+            bits = (int)get_le(fmt+14, 2);
+            if((format != WAV_PCM && format != WAV_EXTENSIBLE) ||
+               bits != 16 || au->channels < 1 ||
+               au->channels > AUDIO_MAX_CHANNELS || au->rate <= 0)
+                break;
+            has_fmt = 1;
+            pos += WAV_FMT_LEN;
+            size -= WAV_FMT_LEN;
+        }
+        size += size & 1; /* chunks are word-aligned */
+        if(skip_bytes(au->fd, size))
+            break;
+        pos += size;
+    }
+    fprintf(stderr, AUDIO_WAV_ERR_MSG, src);
+    return 1;
+}
+
+static int open_alsa(struct audio *au, const char *dev)
+{
+    #ifdef WITH_ALSA
+    int err;
+    err = snd_pcm_open(&au->pcm, dev, SND_PCM_STREAM_CAPTURE,
+                       SND_PCM_NONBLOCK);
+    if(err >= 0)
+        err = snd_pcm_set_params(au->pcm, SND_PCM_FORMAT_S16_LE,
+                                 SND_PCM_ACCESS_RW_INTERLEAVED, au->channels,
+                                 au->rate, 1, AUDIO_ALSA_LATENCY);
+    if(err >= 0)
+        err = snd_pcm_start(au->pcm);
+    if(err < 0) {
+        fprintf(stderr, AUDIO_ALSA_ERR_MSG, dev, snd_strerror(err));
+        audio_close(au);
+        return 1;
+    }
+    return 0;
+    #else
+    fprintf(stderr, AUDIO_NOALSA_ERR_MSG, dev);
+    return 1;
+    #endif
+}
+
+#ifdef WITH_ALSA
+static int read_alsa(struct audio *au, int frames)
+{
+    snd_pcm_sframes_t n = snd_pcm_readi(au->pcm, au->buf, frames);
+    if(n == -EPIPE || n == -ESTRPIPE) { /* an overrun, start over */
+        snd_pcm_recover(au->pcm, (int)n, 1);
+        return 0;
+    }
+    return n < 0 ? 0 : (int)n;
+}
+#endif
+
+static int set_blocking(int fd, int blocking)
+{
+    int flags = fcntl(fd, F_GETFL);
+    if(flags < 0)
+        return 1;
+    flags = blocking ? (flags & ~O_NONBLOCK) : (flags | O_NONBLOCK);
+    return fcntl(fd, F_SETFL, flags) < 0;
+}
+
+static int read_full(int fd, unsigned char *buf, int len)
+{
+    int got = 0;
+    while(got < len) {
+        ssize_t r = read(fd, buf+got, len-got);
+        if(r <= 0)
+            break;
+        got += (int)r;
+    }
+    return got;
+}
+
+static int skip_bytes(int fd, unsigned long len)
+{
+    unsigned char tmp[256];
+    while(len > 0) {
+        int part = len > sizeof(tmp) ? (int)sizeof(tmp) : (int)len;
+        if(read_full(fd, tmp, part) != part)
+            return 1;
+        len -= part;
+    }
+    return 0;
+}
+
+static unsigned long get_le(const unsigned char *mem, int bytes)
+{
+    unsigned long num = 0;
+    while(bytes-- > 0)
+        num = (num << 8) | mem[bytes];
+    return num;
+}
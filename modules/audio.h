@@ -0,0 +1,81 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File audio.h
+ * PCM input for the audio-reactive modes: stdin ("-"), a file or FIFO, or
+ * an ALSA capture device ("alsa:DEVICE", if built with ALSA=1).
+ * A WAV file or stream is played at its own pace, as if it were heard;
+ * raw 16-bit little-endian PCM (44100 Hz stereo unless said otherwise)
+ * from a FIFO, stdin or ALSA is live: everything is read at once and only
+ * the newest samples matter.
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#ifndef AUDIO_SENTRY
+#define AUDIO_SENTRY
+
+#include <time.h> /* for struct timespec */
+#include "locale_macros.h"
+#ifdef WITH_ALSA
+#include <alsa/asoundlib.h>
+#endif
+
+/* Constants */
+#define AUDIO_RATE 44100 /* of raw PCM */
+#define AUDIO_CHANNELS 2
+#define AUDIO_MAX_CHANNELS 8
+#define AUDIO_BUF_FRAMES 1024 /* the most audio_read gives at once */
+#define AUDIO_MAX_CATCHUP 1 /* second, a paced stream never rushes more */
+#define AUDIO_ALSA_PREFIX "alsa:"
+#define AUDIO_ALSA_LATENCY 10000 /* us */
+
+/* Messages */
+#define AUDIO_OPEN_ERR_MSG _("Couldn't open the audio: %s: %s\n")
+#define AUDIO_WAV_ERR_MSG _("%s: only 16-bit PCM WAV is supported\n")
+#define AUDIO_NOALSA_ERR_MSG _("%s: built without ALSA, rebuild with ALSA=1 "\
+                               "or pipe arecord -t raw -f cd\n")
+#define AUDIO_ALSA_ERR_MSG _("ALSA: %s: %s\n")
+
+/* Structs */
+struct audio {
+    int fd;
+    int rate;
+    int channels;
+    int paced; /* a recording: read as fast as it's played */
+    int seekable; /* loops at the end */
+    long data_start; /* the first sample in a seekable file */
+    int started; /* pacing has started */
+    struct timespec start;
+    unsigned long consumed; /* frames read since start */
+    unsigned char carry[AUDIO_MAX_CHANNELS*2]; /* a partial frame */
+    int carry_len;
+    unsigned char buf[AUDIO_BUF_FRAMES*AUDIO_MAX_CHANNELS*2];
+#ifdef WITH_ALSA
+    snd_pcm_t *pcm;
+#endif
+};
+
+/* Functions */
+int audio_open(struct audio *au, const char *src); /* 0 or message */
+void audio_close(struct audio *au);
+int audio_is_file(const char *src); /* not stdin or a device */
+/* Gives up to max new frames, the channels mixed into one sample -1..1;
+ * 0 if there are no more for now */
+int audio_read(struct audio *au, float *out, int max);
+
+#endif
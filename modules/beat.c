@@ -0,0 +1,309 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File beat.c
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#include <stdio.h> /* for printf, fprintf */
+#include <stdlib.h> /* for malloc, realloc, free */
+#include <math.h> /* for fabs, exp, log */
+
+#include "beat.h"
+#include "audio.h" /* for the test: audio_open, audio_read */
+#include "analyzer.h" /* for the test: struct analyzer */
+#include "scene.h" /* for the test: FRAME_MS */
+
+/* Structs */
+struct times { /* of the test */
+    double *t;
+    unsigned int cnt, cap;
+};
+
+static void pull_phase(struct beat_tracker *bt, double t);
+static void estimate_tempo(struct beat_tracker *bt);
+static double tempo_score(const struct beat_tracker *bt, int lag);
+static double autocorr(const struct beat_tracker *bt, int lag);
+static void add_time(struct times *tm, double t);
+static int report(const char *path, const struct beat_tracker *bt,
+                  const struct times *clicks, const struct times *peaks);
+
+/* Functions */
+void bt_init(struct beat_tracker *bt)
+{
+    int i;
+    for(i = 0; i < BT_HIST; i++)
+        bt->env[i] = 0;
+    bt->hop_s = bt->prev_now = 0;
+    bt->pos = bt->filled = 0;
+    bt->avg = bt->dev = bt->last[0] = bt->last[1] = 0;
+    bt->last_at = bt->last_onset = 0;
+    bt->since_tempo = 0;
+    bt->period = bt->candidate = 0;
+    bt->votes = 0;
+    bt->next_beat = 0;
+    bt->misses = 0;
+}
+
+void bt_update(struct beat_tracker *bt, float flux, double onset,
+               double now)
+{
+    float e;
+    if(now <= bt->prev_now) /* no new samples */
+        return;
+    if(bt->prev_now > 0) /* the hops follow the frames, not the audio */
+        bt->hop_s = bt->hop_s > 0 ?
+                    bt->hop_s + (now - bt->prev_now - bt->hop_s)*BT_AVG_FALL :
+                    now - bt->prev_now;
+    e = flux - bt->avg;
+    bt->dev += ((e > 0 ? e : -e) - bt->dev)*BT_AVG_FALL;
+    bt->avg += e*BT_AVG_FALL;
+    e = flux - bt->avg - bt->dev; /* the noise doesn't make a rhythm */
+    bt->env[bt->pos] = e > 0 ? e : 0;
+    bt->pos = (bt->pos + 1) % BT_HIST;
+    if(bt->filled < BT_HIST)
+        bt->filled++;
+
+    /* The hop before has an onset if it's a strong enough peak */
+    if(bt->last[0] > bt->last[1] && bt->last[0] >= flux &&
+       bt->last[0] > bt->avg + bt->dev*BT_PEAK_DEVS &&
+       (bt->last_onset == 0 || bt->last_at - bt->last_onset > BT_PEAK_GAP))
+        pull_phase(bt, bt->last_at);
+    bt->last[1] = bt->last[0];
+    bt->last[0] = flux;
+    bt->last_at = onset;
+    bt->prev_now = now;
+
+    if(++bt->since_tempo >= BT_TEMPO_EVERY && bt->filled >= BT_HIST*3/4) {
+        estimate_tempo(bt);
+        bt->since_tempo = 0;
+    }
+    while(bt->period > 0 && bt->next_beat <= now)
+        bt->next_beat += bt->period;
+}
+
+int bt_flash_due(const struct beat_tracker *bt, double now,
+                 unsigned int lead_frames, double *fired)
+{
+    double start;
+    if(bt->period <= 0)
+        return 0;
+    start = bt->next_beat - lead_frames*bt->hop_s - BT_OUTPUT_LATENCY;
+    if(start > now + bt->hop_s/2) /* a later frame is nearer */
+        return 0;
+    if(*fired > 0 && fabs(bt->next_beat - *fired) < bt->period/2)
+        return 0;
+    *fired = bt->next_beat;
+    return 1;
+}
+
+/* Pulls the beat towards the onset if it's near one: the phase, and a
+ * little of the period too, so a slightly wrong tempo doesn't lag; if the
+ * onsets keep missing, the phase is lost and starts from this one */
+static void pull_phase(struct beat_tracker *bt, double t)
+{
+    double err;
+    bt->last_onset = t;
+    if(bt->period <= 0)
+        return;
+    err = t - (bt->next_beat - bt->period);
+    if(fabs(t - bt->next_beat) < fabs(err))
+        err = t - bt->next_beat;
+    if(fabs(err) < BT_PLL_WINDOW*bt->period) {
+        bt->next_beat += BT_PLL_GAIN*err;
+        bt->period += BT_PLL_FREQ_GAIN*err;
+        bt->misses = 0;
+    } else if(++bt->misses >= BT_PLL_MISSES) {
+        bt->next_beat = t;
+        bt->misses = 0;
+    }
+}
+
+/* The autocorrelation of the onset strength peaks at the beat period and
+ * its multiples; the prior picks the likeliest one */
+static void estimate_tempo(struct beat_tracker *bt)
+{
+    int lag, lo, hi, best = 0;
+    double s, s_prev, s_next, best_s = 0, shift = 0, period;
+    if(bt->hop_s <= 0)
+        return;
+    lo = (int)(60.0/BT_MAX_BPM/bt->hop_s);
+    hi = (int)(60.0/BT_MIN_BPM/bt->hop_s) + 1;
+    if(lo < 2)
+        lo = 2;
+    if(hi > (int)bt->filled/2)
+        hi = bt->filled/2;
+    for(lag = lo; lag <= hi; lag++) {
+        s = tempo_score(bt, lag);
+        if(s > best_s) {
+            best_s = s;
+            best = lag;
+        }
+    }
+    if(best == 0) /* no rhythm, silence */
+        return;
+    s_prev = tempo_score(bt, best-1);
+    s_next = tempo_score(bt, best+1);
+    if(s_prev <= best_s && s_next <= best_s && s_prev - 2*best_s + s_next < 0)
+        shift = 0.5*(s_prev - s_next)/(s_prev - 2*best_s + s_next);
+    period = (best + shift)*bt->hop_s;
+
+    if(bt->period <= 0) { /* the first beat follows the last onset */
+        bt->period = period;
+        bt->next_beat = bt->last_onset > 0 ? bt->last_onset : bt->prev_now;
+    } else if(fabs(period/bt->period - 1) < BT_TEMPO_AGREE) {
+        bt->votes = 0; /* the same tempo, the onsets refine it */
+    } else if(bt->votes > 0 &&
+              fabs(period/bt->candidate - 1) < BT_TEMPO_AGREE) {
+        if(++bt->votes >= BT_TEMPO_VOTES) { /* the tempo has changed */
+            bt->period = period;
+            bt->next_beat = bt->last_onset > 0 ? bt->last_onset
+                                               : bt->prev_now;
+            bt->votes = 0;
+        }
+    } else {
+        bt->candidate = period;
+        bt->votes = 1;
+    }
+}
+
+/* A period between two lags splits its peak, the neighbours count too */
+static double tempo_score(const struct beat_tracker *bt, int lag)
+{
+    double bpm, oct;
+    if(lag <= 0)
+        return 0;
+    bpm = 60.0/(lag*bt->hop_s);
+    oct = log(bpm/BT_PRIOR_BPM)/log(2.0)/BT_PRIOR_WIDTH;
+    return (autocorr(bt, lag) +
+            0.5*(autocorr(bt, lag-1) + autocorr(bt, lag+1))) *
+           exp(-0.5*oct*oct);
+}
+
+/* Not normalized by the overlap: a shorter lag wins a tie */
+static double autocorr(const struct beat_tracker *bt, int lag)
+{
+    unsigned int i, first = (bt->pos + BT_HIST - bt->filled) % BT_HIST;
+    double sum = 0;
+    if(lag <= 0 || (unsigned int)lag >= bt->filled)
+        return 0;
+    for(i = lag; i < bt->filled; i++)
+        sum += bt->env[(first + i) % BT_HIST] *
+               bt->env[(first + i - lag) % BT_HIST];
+    return sum;
+}
+
+int beat_test(const char *path, unsigned int lead_frames)
+{
+    struct audio *au = malloc(sizeof(*au));
+    struct analyzer *an = malloc(sizeof(*an));
+    struct beat_tracker bt;
+    struct times clicks = { NULL, 0, 0 }, peaks = { NULL, 0, 0 };
+    float smp[AUDIO_BUF_FRAMES];
+    double fired = 0, last_click = -1, now;
+    int hop, got, n, i, res;
+    if(audio_open(au, path)) {
+        free(au);
+        free(an);
+        return 1;
+    }
+    au->paced = au->seekable = 0; /* as fast as it reads, once */
+    analyzer_init(an, au->rate);
+    bt_init(&bt);
+    hop = au->rate * FRAME_MS / 1000;
+    if(hop > AUDIO_BUF_FRAMES)
+        hop = AUDIO_BUF_FRAMES;
+    for(;;) { /* a hop is a frame, as if it were played */
+        unsigned long first = au->consumed;
+        for(got = 0; got < hop; got += n) {
+            n = audio_read(au, smp+got, hop-got);
+            if(n <= 0)
+                break;
+        }
+        if(got == 0)
+            break;
+        for(i = 0; i < got; i++) {
+            double t = (double)(first + i) / au->rate;
+            if(fabs(smp[i]) > BT_CLICK_LEVEL &&
+               (last_click < 0 || t - last_click > BT_CLICK_GAP)) {
+                add_time(&clicks, t);
+                last_click = t;
+            }
+        }
+        analyzer_push(an, smp, got);
+        analyzer_run(an);
+        now = (double)au->consumed / au->rate;
+        bt_update(&bt, an->flux, now - an->onset_lag, now);
+        if(bt_flash_due(&bt, bt.prev_now, lead_frames, &fired))
+            add_time(&peaks, bt.prev_now + lead_frames*bt.hop_s +
+                             BT_OUTPUT_LATENCY);
+    }
+    audio_close(au);
+    res = report(path, &bt, &clicks, &peaks);
+    free(clicks.t);
+    free(peaks.t);
+    free(au);
+    free(an);
+    return res;
+}
+
+static void add_time(struct times *tm, double t)
+{
+    if(tm->cnt == tm->cap) {
+        tm->cap += BT_TEST_CHUNK;
+        tm->t = realloc(tm->t, tm->cap*sizeof(*tm->t));
+    }
+    tm->t[tm->cnt++] = t;
+}
+
+/* Every flash peak after the warm-up is matched with the nearest click */
+static int report(const char *path, const struct beat_tracker *bt,
+                  const struct times *clicks, const struct times *peaks)
+{
+    unsigned int i, c = 0, matched = 0;
+    double interval, sum = 0, abs_sum = 0, max = 0;
+    if(peaks->cnt == 0 || clicks->cnt < 2 || bt->period <= 0) {
+        fprintf(stderr, BT_TEST_NOBEAT_MSG, path);
+        return 1;
+    }
+    interval = (clicks->t[clicks->cnt-1] - clicks->t[0]) / (clicks->cnt-1);
+    for(i = 0; i < peaks->cnt; i++) {
+        double err;
+        if(peaks->t[i] < BT_WARMUP)
+            continue;
+        while(c+1 < clicks->cnt && fabs(clicks->t[c+1] - peaks->t[i]) <
+                                   fabs(clicks->t[c] - peaks->t[i]))
+            c++;
+        err = peaks->t[i] - clicks->t[c];
+        if(fabs(err) > interval/2) /* past the last click */
+            continue;
+        matched++;
+        sum += err;
+        abs_sum += fabs(err);
+        if(fabs(err) > max)
+            max = fabs(err);
+    }
+    if(matched == 0) {
+        fprintf(stderr, BT_TEST_NOBEAT_MSG, path);
+        return 1;
+    }
+    printf(BT_TEST_RESULT_MSG, clicks->cnt, 60.0/interval,
+           60.0/bt->period, matched, BT_WARMUP,
+           1000*abs_sum/matched, 1000*max, 1000*sum/matched);
+    return 0;
+}
@@ -0,0 +1,93 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File beat.h
+ * Tempo tracking: the onset strength of every hop is kept in a short
+ * ring, its autocorrelation gives the beat period and the onsets pull the
+ * predicted beat into phase, so a flash can be started before the beat and
+ * peak right on it. The memory is constant, a stream may be endless.
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#ifndef BEAT_SENTRY
+#define BEAT_SENTRY
+
+#include "locale_macros.h"
+
+/* Constants */
+#define BT_HIST 256 /* hops of the onset strength, 5 s at 50 Hz */
+#define BT_MIN_BPM 60
+#define BT_MAX_BPM 200
+#define BT_PRIOR_BPM 120.0 /* the likeliest tempo, against octave errors */
+#define BT_PRIOR_WIDTH 1.5 /* octaves */
+#define BT_TEMPO_EVERY 25 /* hops between the tempo estimates */
+#define BT_TEMPO_AGREE 0.08 /* the relative difference of the same tempo */
+#define BT_TEMPO_VOTES 3 /* estimates in a row to take a new tempo */
+#define BT_PEAK_DEVS 2.5 /* an onset is that many mean deviations strong */
+#define BT_PEAK_GAP 0.1 /* s, the least time between onsets */
+#define BT_AVG_FALL 0.02 /* the part of a hop in the means of the flux */
+#define BT_PLL_GAIN 0.2 /* the part of the phase error corrected */
+#define BT_PLL_FREQ_GAIN 0.03 /* the part of it the period is corrected by */
+#define BT_PLL_WINDOW 0.2 /* of the period, the farther onsets are off */
+#define BT_PLL_MISSES 4 /* onsets off in a row, the beat follows the last */
+#define BT_OUTPUT_LATENCY 0.008 /* s, the USB transfer and the diodes */
+#define BT_WARMUP 8.0 /* s, the test ignores the beats before */
+#define BT_CLICK_LEVEL 0.25f /* a louder sample is a click of a track */
+#define BT_CLICK_GAP 0.1 /* s, the least time between clicks */
+#define BT_TEST_CHUNK 256 /* times, the test's arrays grow by */
+
+/* Messages */
+#define BT_TEST_RESULT_MSG _("Clicks: %u, %.1f BPM\n"\
+                             "Tracked: %.1f BPM, %u beats after %.0f s\n"\
+                             "Timing error: mean %.1f ms, max %.1f ms, "\
+                             "bias %+.1f ms\n")
+#define BT_TEST_NOBEAT_MSG _("%s: no beat found\n")
+
+/* Structs */
+struct beat_tracker {
+    double hop_s; /* s, the measured time between the hops */
+    double prev_now; /* the time of the hop before, 0 before the first */
+    float env[BT_HIST]; /* the onset strength above the usual */
+    unsigned int pos, filled;
+    float avg, dev; /* the running mean of the flux, its mean deviation */
+    float last[2]; /* the flux of the two hops before, the newer first */
+    double last_at; /* s, the onset of the hop before */
+    double last_onset; /* s, 0 if none yet */
+    unsigned int since_tempo; /* hops */
+    double period; /* s, 0 while the tempo isn't known */
+    double candidate; /* a new tempo, a period, being voted for */
+    unsigned int votes;
+    double next_beat; /* s, always ahead of the last hop */
+    unsigned int misses; /* onsets off the beat in a row */
+};
+
+/* Functions */
+void bt_init(struct beat_tracker *bt);
+/* The flux of a hop whose newest sample is at now, in seconds, and its
+ * strongest onset was at onset */
+void bt_update(struct beat_tracker *bt, float flux, double onset,
+               double now);
+/* If a flash peaking lead_frames hops after its start must start at this
+ * hop to peak on the beat; fired keeps the beat flashed, initially 0 */
+int bt_flash_due(const struct beat_tracker *bt, double now,
+                 unsigned int lead_frames, double *fired);
+/* Plays a click track through the tracker, prints the timing error;
+ * lead_frames is the rise of a flash. 0 if tracked, message otherwise */
+int beat_test(const char *path, unsigned int lead_frames);
+
+#endif
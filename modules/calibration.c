@@ -0,0 +1,235 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File calibration.c
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#include <stdio.h> /* for fopen, fgets, fprintf, sscanf */
+#include <stdlib.h> /* for strtod */
+#include <string.h> /* for strchr, strcmp, strerror, strtok, strlen */
+#include <errno.h> /* for errno */
+#include <math.h> /* for pow, floor */
+
+#include "calibration.h"
+
+/* The settings of a section as they are written */
+struct cal_settings {
+    double gain[3];
+    double gamma[3];
+    double matrix[9];
+};
+
+enum { no_match, model_match, unit_match }; /* the better, the greater */
+
+static void default_settings(struct cal_settings *st);
+static int section_rank(const char *line, unsigned short vid,
+                        unsigned short pid, const char *serial,
+                        const char *path, int lineno);
+static int parse_setting(char *line, const char *path, int lineno,
+                         struct cal_settings *st);
+static int parse_numbers(double *nums, int max);
+static void build_calibration(const struct cal_settings *st,
+                              struct calibration *cal);
+static int fixed_coef(double coef);
+
+/* Functions */
+void cal_identity(struct calibration *cal)
+{
+    struct cal_settings st;
+    default_settings(&st);
+    build_calibration(&st, cal);
+}
+
+int load_calibration(const char *path, unsigned short vid,
+                     unsigned short pid, const char *serial,
+                     struct calibration *cal)
+{
+    FILE *f;
+    char line[CAL_LINE_LEN], *p;
+    int lineno = 0, rank = -1, best = no_match, err = 0;
+    struct cal_settings cur, found;
+
+    cal_identity(cal);
+    f = fopen(path, "r");
+    if(!f) {
+        fprintf(stderr, CAL_OPEN_ERR_MSG, path, strerror(errno));
+        return 1;
+    }
+    default_settings(&cur);
+    while(!err && fgets(line, sizeof(line), f)) {
+        lineno++;
+        if((p = strchr(line, '#')))
+            *p = '\0';
+        for(p = line; *p == ' ' || *p == '\t'; p++)
+            {}
+        if(*p == '\0' || *p == '\n' || *p == '\r')
+            continue;
+        if(*p == '[') {
+            if(rank > best) { /* the first of the best ones is taken */
+                found = cur;
+                best = rank;
+            }
+            rank = section_rank(p, vid, pid, serial, path, lineno);
+            err = rank < 0;
+            default_settings(&cur);
+            continue;
+        }
+        if(rank < 0) {
+            fprintf(stderr, CAL_SECTION_ERR_MSG, path, lineno);
+            err = 1;
+            continue;
+        }
+        err = parse_setting(p, path, lineno, &cur);
+    }
+    fclose(f);
+    if(!err && rank > best) {
+        found = cur;
+        best = rank;
+    }
+    if(!err && best != no_match)
+        build_calibration(&found, cal);
+    return err;
+}
+
+int cal_color(const struct calibration *cal, int color)
+{
+    int in[3], i, out = 0;
+    if(cal->identity)
+        return color;
+    in[0] = (color >> 16) & 0xff;
+    in[1] = (color >> 8) & 0xff;
+    in[2] = color & 0xff;
+    for(i = 0; i < 3; i++) {
+        const int *m = cal->matrix[i];
+        int v = m[0]*in[0] + m[1]*in[1] + m[2]*in[2] + CAL_ONE/2;
+        v = v < 0 ? 0 : v >> CAL_SHIFT;
+        out = (out << 8) | cal->lut[i][v > 0xff ? 0xff : v];
+    }
+    return out;
+}
+
+static void default_settings(struct cal_settings *st)
+{
+    int i;
+    for(i = 0; i < 3; i++)
+        st->gain[i] = st->gamma[i] = 1.0;
+    for(i = 0; i < 9; i++)
+        st->matrix[i] = (i % 4 == 0) ? 1.0 : 0.0; /* the diagonal */
+}
+
+/* "[VID:PID]" in hex or "[SERIAL]", returns how well it matches or -1 */
+static int section_rank(const char *line, unsigned short vid,
+                        unsigned short pid, const char *serial,
+                        const char *path, int lineno)
+{
+    const char *end = strchr(line, ']');
+    unsigned int sec_vid, sec_pid;
+    char name[CAL_LINE_LEN];
+    size_t len;
+    if(!end || end == line+1) {
+        fprintf(stderr, CAL_SECTION_ERR_MSG, path, lineno);
+        return -1;
+    }
+    len = end - (line+1);
+    memcpy(name, line+1, len);
+    name[len] = '\0';
+    if(len == 9 && name[4] == ':' &&
+             sscanf(name, "%4x:%4x", &sec_vid, &sec_pid) == 2 &&
+             strspn(name, "0123456789abcdefABCDEF:") == len)
+        return (sec_vid == vid && sec_pid == pid) ? model_match : no_match;
+    return (*serial && 0 == strcmp(name, serial)) ? unit_match : no_match;
+}
+
+/* "gain R [G B]", "gamma R [G B]" or "matrix" and 9 numbers by rows */
+static int parse_setting(char *line, const char *path, int lineno,
+                         struct cal_settings *st)
+{
+    const char *key = strtok(line, " \t\r\n");
+    double nums[9];
+    int i, cnt = parse_numbers(nums, 9), bad = 0;
+    int is_gain = 0 == strcmp(key, "gain");
+
+    if(is_gain || 0 == strcmp(key, "gamma")) {
+        if(cnt != 1 && cnt != 3) {
+            fprintf(stderr, CAL_SYNTAX_ERR_MSG, path, lineno);
+            return 1;
+        }
+        for(i = 0; i < 3; i++) {
+            double v = nums[cnt == 1 ? 0 : i];
+            if(is_gain)
+                bad = bad || v < 0 || v > CAL_MAX_GAIN;
+            else
+                bad = bad || v < CAL_MIN_GAMMA || v > CAL_MAX_GAMMA;
+            (is_gain ? st->gain : st->gamma)[i] = v;
+        }
+    } else if(0 == strcmp(key, "matrix") && cnt == 9) {
+        for(i = 0; i < 9; i++) {
+            bad = bad || nums[i] < -CAL_MAX_COEF || nums[i] > CAL_MAX_COEF;
+            st->matrix[i] = nums[i];
+        }
+    } else {
+        fprintf(stderr, CAL_SYNTAX_ERR_MSG, path, lineno);
+        return 1;
+    }
+    if(bad)
+        fprintf(stderr, CAL_RANGE_ERR_MSG, path, lineno);
+    return bad;
+}
+
+/* The rest of the strtok'ed line, -1 if something isn't a number */
+static int parse_numbers(double *nums, int max)
+{
+    const char *s;
+    char *end;
+    int cnt = 0;
+    while((s = strtok(NULL, " \t\r\n"))) {
+        if(cnt == max)
+            return -1;
+        nums[cnt] = strtod(s, &end);
+        if(*end != '\0')
+            return -1;
+        cnt++;
+    }
+    return cnt;
+}
+
+static void build_calibration(const struct cal_settings *st,
+                              struct calibration *cal)
+{
+    int c, v, identity = 1;
+    for(c = 0; c < 3; c++) {
+        for(v = 0; v < 3; v++) {
+            cal->matrix[c][v] = fixed_coef(st->matrix[c*3+v]);
+            identity = identity &&
+                       cal->matrix[c][v] == (c == v ? CAL_ONE : 0);
+        }
+        for(v = 0; v < 256; v++) {
+            double out = 255.0*st->gain[c]*pow(v/255.0, st->gamma[c]);
+            out = floor(out + 0.5);
+            cal->lut[c][v] = out > 255.0 ? 255 : (unsigned char)out;
+            identity = identity && cal->lut[c][v] == v;
+        }
+    }
+    cal->identity = identity;
+}
+
+static int fixed_coef(double coef)
+{
+    return (int)floor(coef*CAL_ONE + 0.5);
+}
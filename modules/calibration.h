@@ -0,0 +1,72 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File calibration.h
+ * The color correction of one microphone model or unit, so the same hex
+ * color looks the same on all of them. A color goes through a 3x3 matrix,
+ * then through the lookup table of every channel made of its gain and
+ * gamma. Applied right before packing, the scenes stay device-independent.
+ * The profiles file has a section per device:
+ *     [03f0:098c]      # VID:PID, every DuoCast
+ *     gain 1 0.85 0.9  # one value for all channels or one per channel
+ *     gamma 1.1
+ *     matrix 1 0 0  0 1 0  0 0.05 0.95
+ *     [FAKE0001]       # a serial number, wins over VID:PID
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#ifndef CALIBRATION_SENTRY
+#define CALIBRATION_SENTRY
+
+#include "locale_macros.h"
+
+/* Constants */
+#define CAL_SHIFT 12
+#define CAL_ONE (1 << CAL_SHIFT) /* fixed point 1.0 of the matrix */
+#define CAL_LINE_LEN 256
+#define CAL_MAX_GAIN 4.0
+#define CAL_MIN_GAMMA 0.1
+#define CAL_MAX_GAMMA 10.0
+#define CAL_MAX_COEF 4.0 /* of the matrix, either sign */
+
+/* Messages */
+#define CAL_OPEN_ERR_MSG _("Couldn't read the calibration: %s: %s\n")
+#define CAL_SYNTAX_ERR_MSG _("%s:%d: expected 'gain R [G B]', "\
+                             "'gamma R [G B]' or 'matrix' and 9 numbers\n")
+#define CAL_RANGE_ERR_MSG _("%s:%d: gain must be 0-4, gamma 0.1-10, "\
+                            "the matrix -4 through 4\n")
+#define CAL_SECTION_ERR_MSG _("%s:%d: expected [VID:PID] or [SERIAL] "\
+                              "before the settings\n")
+
+/* Structs */
+struct calibration {
+    int identity; /* nothing to correct, the colors pass as they are */
+    int matrix[3][3]; /* fixed point, the rows make red, green and blue */
+    unsigned char lut[3][256]; /* the gain and gamma of every channel */
+};
+
+/* Functions */
+void cal_identity(struct calibration *cal);
+/* Takes the section of the device from the profiles file, the identity
+ * if none matches; 0 on success, message on failure */
+int load_calibration(const char *path, unsigned short vid,
+                     unsigned short pid, const char *serial,
+                     struct calibration *cal);
+int cal_color(const struct calibration *cal, int color);
+
+#endif
@@ -0,0 +1,165 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File compositor.c
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#include "compositor.h"
+
+static int blend_channel(int below, int above, int blend);
+
+/* Functions */
+void compositor_init(struct compositor *comp)
+{
+    comp->cnt = 0;
+    comp->len = 0;
+    comp->frame = 0;
+    comp->left = 0;
+    comp->color = black;
+}
+
+void compositor_free(struct compositor *comp)
+{
+    int i;
+    for(i = 0; i < comp->cnt; i++)
+        seq_free(&comp->layers[i].seq);
+    compositor_init(comp);
+}
+
+void compositor_add(struct compositor *comp, struct sequence *seq,
+                    int blend, int alpha)
+{
+    struct layer *lr;
+    if(comp->cnt >= MAX_LAYERS || seq->len == 0) {
+        seq_free(seq);
+        return;
+    }
+    lr = &comp->layers[comp->cnt];
+    lr->seq = *seq;
+    cur_init(&lr->cur, &lr->seq);
+    lr->blend = blend;
+    lr->alpha = alpha;
+    comp->seen[comp->cnt] = nocolor; /* forces blending in the 1st frame */
+    comp->cnt++;
+    comp->len = seq_loop(comp->len, seq_length(seq));
+    comp->left = 0;
+}
+
+/* Gives the color under the cursors and how many frames it stays */
+int compose(struct compositor *comp, unsigned int *hold)
+{
+    int i, changed;
+    unsigned int h;
+    if(comp->left > 0) { /* nothing has changed since the last time */
+        *hold = comp->left;
+        return comp->color;
+    }
+    if(comp->cnt == 0) {
+        *hold = (unsigned int)-1;
+        return black;
+    }
+    changed = comp->cnt; /* the lowest layer that has changed */
+    h = comp->len - comp->frame;
+    for(i = 0; i < comp->cnt; i++) {
+        struct layer *lr = &comp->layers[i];
+        int col;
+        unsigned int lr_hold;
+        cur_prepare(&lr->cur);
+        col = cur_color(&lr->cur);
+        lr_hold = cur_hold(&lr->cur);
+        if(col != comp->seen[i]) {
+            comp->seen[i] = col;
+            if(changed == comp->cnt)
+                changed = i;
+        }
+        if(lr_hold < h)
+            h = lr_hold;
+    }
+    /* Everything below the changed layer stays as it was */
+    for(i = changed; i < comp->cnt; i++) {
+        int below = (i == 0) ? black : comp->mix[i-1];
+        comp->mix[i] = blend_colors(below, comp->seen[i],
+                                    comp->layers[i].blend,
+                                    comp->layers[i].alpha);
+    }
+    comp->color = comp->mix[comp->cnt-1];
+    comp->left = h;
+    *hold = h;
+    return comp->color;
+}
+
+/* A cursor wraps at the end of its own layer, never in the middle of it */
+void compositor_skip(struct compositor *comp, unsigned int frames)
+{
+    unsigned int cycle;
+    int i;
+    if(comp->len == 0)
+        return;
+    for(i = 0; i < comp->cnt; i++)
+        cur_skip(&comp->layers[i].cur, frames);
+    cycle = frames % comp->len;
+    if(comp->frame >= comp->len - cycle)
+        comp->frame -= comp->len - cycle;
+    else
+        comp->frame += cycle;
+    comp->left = (comp->left > frames) ? comp->left - frames : 0;
+}
+
+void compositor_rewind(struct compositor *comp)
+{
+    int i;
+    for(i = 0; i < comp->cnt; i++) {
+        if(!comp->layers[i].seq.gen) /* endless layers never restart */
+            cur_init(&comp->layers[i].cur, &comp->layers[i].seq);
+    }
+    comp->frame = 0;
+    comp->left = 0;
+}
+
+int blend_colors(int below, int above, int blend, int alpha)
+{
+    int shift, result = 0;
+    if(blend == blend_normal && alpha == MAX_BR_SPD_DLY) /* the usual case */
+        return above;
+    for(shift = 16; shift >= 0; shift -= 8) {
+        int b, a, mixed;
+        b = (below >> shift) & 0xff;
+        a = (above >> shift) & 0xff;
+        mixed = blend_channel(b, a, blend);
+        mixed = b + (mixed - b)*alpha/MAX_BR_SPD_DLY;
+        result |= mixed << shift;
+    }
+    return result;
+}
+
+static int blend_channel(int below, int above, int blend)
+{
+    switch(blend) {
+    case blend_add:
+        return (below + above > 0xff) ? 0xff : below + above;
+    case blend_multiply:
+        return below*above/0xff;
+    case blend_screen:
+        return 0xff - (0xff - below)*(0xff - above)/0xff;
+    case blend_lighten:
+        return (below > above) ? below : above;
+    default: /* blend_normal */
+        return above;
+    }
+}
@@ -0,0 +1,65 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File compositor.h
+ * Stacks the layers of a diode group and blends them while playing.
+ * A layer whose color hasn't changed since the previous frame isn't
+ * blended again: the result below it is kept from the last frame. While
+ * every layer holds its color, nothing is evaluated at all.
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#ifndef COMPOSITOR_SENTRY
+#define COMPOSITOR_SENTRY
+
+#include "argparser.h" /* for MAX_LAYERS, enum blend_mode, nocolor */
+#include "sequence.h" /* for struct sequence, struct seqcur */
+
+/* Structs */
+struct layer {
+    struct sequence seq; /* looped if shorter than the longest layer */
+    struct seqcur cur;
+    int blend; /* enum blend_mode */
+    int alpha; /* 0-100 */
+};
+
+struct compositor {
+    struct layer layers[MAX_LAYERS]; /* the bottom one goes first */
+    int cnt;
+    /* Each layer loops on its own, all of them repeat together after len
+     * frames; SEQ_ENDLESS if there's an endless one */
+    unsigned int len;
+    unsigned int frame; /* the frame under the cursors */
+    unsigned int left; /* how long the last composed color holds yet */
+    int color; /* the last composed color */
+    int seen[MAX_LAYERS]; /* the colors of the layers in the last frame */
+    int mix[MAX_LAYERS]; /* mix[i] is layers 0..i blended together */
+};
+
+/* Functions */
+void compositor_init(struct compositor *comp);
+void compositor_free(struct compositor *comp);
+/* Takes the ownership of the sequence */
+void compositor_add(struct compositor *comp, struct sequence *seq,
+                    int blend, int alpha);
+int compose(struct compositor *comp, unsigned int *hold);
+void compositor_skip(struct compositor *comp, unsigned int frames);
+void compositor_rewind(struct compositor *comp);
+int blend_colors(int below, int above, int blend, int alpha);
+
+#endif
@@ -0,0 +1,479 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File control.c
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#include <stdio.h> /* for fprintf, snprintf, sprintf, fflush */
+#include <stdlib.h> /* for malloc, free, getenv */
+#include <string.h> /* for strlen, memchr, memcpy */
+#include <errno.h> /* for errno */
+#include <time.h> /* for clock_gettime */
+#include <unistd.h> /* for read, write, fork, getcwd */
+#include <fcntl.h> /* for fcntl */
+#include <poll.h> /* for poll */
+#include <sys/socket.h> /* for socket, bind, accept */
+#include <sys/file.h> /* for flock */
+#include <sys/stat.h> /* for umask, lstat */
+#include <sys/un.h> /* for struct sockaddr_un */
+#include <sys/wait.h> /* for waitpid */
+
+#include "control.h"
+
+/* Constants */
+#define PROG_NAME "quadcastrgb"
+#define CHECKED_EXIT 125 /* the check has returned, no one exits so */
+#define STATUS_CHAR(S) ((char)('0' + (S)))
+#define REQ_DONE 0 /* the client has shut its side */
+#define REQ_PARTIAL 1 /* more is to come */
+#define REQ_WRONG 2
+
+/* The client being read, its request may come over several frames */
+static struct {
+    int fd; /* -1 if none */
+    char *buf;
+    size_t len;
+    struct timespec start; /* of the connection */
+} client; /* set up by ctl_listen */
+
+static int runtime_path(char *buf, size_t size, const char *suffix);
+static int sock_path(struct sockaddr_un *addr);
+static int write_all(int fd, const char *buf, size_t len);
+static int accept_client(int fd);
+static void drop_client(void);
+static int read_request(int fd, char *buf, size_t *len);
+static int pack_request(char *buf, size_t *len, int argc, const char **argv);
+static int split_request(struct ctl_request *req, size_t len);
+static long ms_since(const struct timespec *start);
+
+/* Functions */
+int ctl_listen(void)
+{
+    struct sockaddr_un addr;
+    struct stat st;
+    mode_t mask;
+    int fd, err;
+    memset(&client, 0, sizeof(client));
+    client.fd = -1;
+    if(sock_path(&addr))
+        return -1;
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(fd < 0)
+        return -1;
+    /* Somebody answers: it isn't a stale socket of a killed program */
+    if(0 == connect(fd, (struct sockaddr *)&addr, sizeof(addr))) {
+        fprintf(stderr, CTL_LISTEN_ERR_MSG, addr.sun_path);
+        close(fd);
+        return -1;
+    }
+    if(0 == lstat(addr.sun_path, &st) && S_ISSOCK(st.st_mode))
+        unlink(addr.sun_path);
+    mask = umask(077); /* only the user may change the colors */
+    err = bind(fd, (struct sockaddr *)&addr, sizeof(addr));
+    umask(mask);
+    if(err || listen(fd, CTL_BACKLOG) ||
+                      fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK)) {
+        fprintf(stderr, CTL_LISTEN_ERR_MSG, addr.sun_path);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+void ctl_unlisten(int fd)
+{
+    struct sockaddr_un addr;
+    if(fd < 0)
+        return;
+    drop_client();
+    close(fd);
+    if(0 == sock_path(&addr))
+        unlink(addr.sun_path);
+}
+
+/* A stalled client is given up after CTL_TIMEOUT_MS, the others wait in
+ * the backlog meanwhile */
+int ctl_accept(int fd, struct ctl_request *req)
+{
+    int status;
+    if(client.fd < 0 && accept_client(fd))
+        return 0;
+    status = read_request(client.fd, client.buf, &client.len);
+    if(status == REQ_PARTIAL && ms_since(&client.start) < CTL_TIMEOUT_MS)
+        return 0;
+    req->fd = client.fd;
+    req->buf = client.buf;
+    client.fd = -1;
+    client.buf = NULL;
+    if(status != REQ_DONE || split_request(req, client.len)) {
+        ctl_reply(req, 1, CTL_BADREQ_MSG);
+        ctl_free_request(req);
+        return 0;
+    }
+    return 1;
+}
+
+int ctl_fd(int fd)
+{
+    return client.fd >= 0 ? client.fd : fd;
+}
+
+void ctl_reply(struct ctl_request *req, int status, const char *msg)
+{
+    char st = STATUS_CHAR(status);
+    if(req->fd < 0)
+        return;
+    /* The client might have gone already, it's no reason to stop */
+    if(0 == write_all(req->fd, &st, 1))
+        write_all(req->fd, msg, strlen(msg));
+    close(req->fd);
+    req->fd = -1;
+}
+
+void ctl_free_request(struct ctl_request *req)
+{
+    if(req->fd >= 0)
+        close(req->fd);
+    req->fd = -1;
+    free(req->buf);
+    req->buf = NULL;
+}
+
+/* Waits for the child, the same as a frame loop would */
+int ctl_check(void (*check)(int argc, const char **argv),
+              int argc, const char **argv, char *msg, size_t len)
+{
+    struct ctl_checker ck;
+    struct pollfd pfd;
+    int status = 1;
+    if(ctl_check_start(&ck, check, argc, argv) == 0) {
+        pfd.fd = ck.fd;
+        pfd.events = POLLIN;
+        while((status = ctl_check_poll(&ck)) < 0)
+            poll(&pfd, 1, -1);
+    }
+    snprintf(msg, len, "%s", ck.msg);
+    return status;
+}
+
+/* The check may exit, as the parsing does on the first wrong argument */
+int ctl_check_start(struct ctl_checker *ck,
+                    void (*check)(int argc, const char **argv),
+                    int argc, const char **argv)
+{
+    int fds[2];
+    ck->pid = -1;
+    ck->fd = -1;
+    ck->len = 0;
+    ck->msg[0] = '\0';
+    if(pipe(fds)) {
+        snprintf(ck->msg, sizeof(ck->msg), "%s", CTL_BADREQ_MSG);
+        return 1;
+    }
+    fflush(NULL); /* or the child would print it once more */
+    ck->pid = fork();
+    if(ck->pid == 0) {
+        close(fds[0]);
+        dup2(fds[1], 1);
+        dup2(fds[1], 2);
+        close(fds[1]);
+        check(argc, argv);
+        fflush(NULL);
+        _exit(CHECKED_EXIT);
+    }
+    close(fds[1]);
+    if(ck->pid < 0) {
+        close(fds[0]);
+        snprintf(ck->msg, sizeof(ck->msg), "%s", CTL_BADREQ_MSG);
+        return 1;
+    }
+    ck->fd = fds[0];
+    fcntl(ck->fd, F_SETFL, fcntl(ck->fd, F_GETFL) | O_NONBLOCK);
+    return 0;
+}
+
+/* The child is waited for once its side of the pipe is closed, at exit */
+int ctl_check_poll(struct ctl_checker *ck)
+{
+    char rest[256];
+    ssize_t n;
+    int status;
+    for(;;) { /* the child mustn't block on a full pipe */
+        if(ck->len+1 < sizeof(ck->msg))
+            n = read(ck->fd, ck->msg + ck->len, sizeof(ck->msg)-1-ck->len);
+        else
+            n = read(ck->fd, rest, sizeof(rest));
+        if(n < 0 && errno == EINTR)
+            continue;
+        if(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return -1;
+        if(n <= 0)
+            break;
+        if(ck->len+1 < sizeof(ck->msg))
+            ck->len += n;
+    }
+    close(ck->fd);
+    ck->fd = -1;
+    ck->msg[ck->len] = '\0';
+    while(waitpid(ck->pid, &status, 0) < 0 && errno == EINTR)
+        {}
+    ck->pid = -1;
+    if(WIFEXITED(status) && WEXITSTATUS(status) == CHECKED_EXIT)
+        return 0;
+    if(ck->len == 0)
+        snprintf(ck->msg, sizeof(ck->msg), "%s", CTL_BADREQ_MSG);
+    return 1;
+}
+
+int ctl_send(int argc, const char **argv)
+{
+    struct sockaddr_un addr;
+    char buf[CTL_MAX_REQUEST], reply[CTL_MAX_REPLY];
+    size_t len;
+    ssize_t n;
+    int fd, status = -1;
+    if(sock_path(&addr))
+        return -1;
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(fd < 0)
+        return -1;
+    if(connect(fd, (struct sockaddr *)&addr, sizeof(addr))) {
+        close(fd);
+        return -1;
+    }
+    if(pack_request(buf, &len, argc, argv)) {
+        fprintf(stderr, CTL_BADREQ_MSG);
+        close(fd);
+        return 1;
+    }
+    write_all(fd, buf, len);
+    shutdown(fd, SHUT_WR);
+    while((n = read(fd, reply, sizeof(reply)-1)) > 0 ||
+                                                 (n < 0 && errno == EINTR)) {
+        char *text = reply;
+        if(n < 0)
+            continue;
+        if(status < 0) {
+            status = reply[0] - '0';
+            text++;
+            n--;
+        }
+        reply[text - reply + n] = '\0';
+        fputs(text, status ? stderr : stdout);
+    }
+    close(fd);
+    if(status < 0 || status > 9) {
+        fprintf(stderr, CTL_NOREPLY_MSG);
+        return 1;
+    }
+    return status;
+}
+
+int ctl_make_request(struct ctl_request *req, int argc, const char **argv)
+{
+    size_t len;
+    req->fd = -1;
+    req->buf = malloc(CTL_MAX_REQUEST);
+    if(pack_request(req->buf, &len, argc, argv) || split_request(req, len)) {
+        ctl_free_request(req);
+        return 1;
+    }
+    return 0;
+}
+
+/* Packed anew, the arguments that stay are copied */
+int ctl_rebase(struct ctl_request *req, const char *paths)
+{
+    char *buf = malloc(CTL_MAX_REQUEST);
+    size_t len, arg_len, dir_len = strlen(req->cwd);
+    int i, join;
+    if(!buf)
+        return 1;
+    memcpy(buf, req->cwd, dir_len+1);
+    len = dir_len+1;
+    for(i = 1; i < req->argc; i++) {
+        join = paths[i] && dir_len && req->argv[i][0] != '/';
+        arg_len = strlen(req->argv[i])+1 + (join ? dir_len+1 : 0);
+        if(arg_len >= CTL_MAX_REQUEST - len) { /* as read_request wants */
+            free(buf);
+            return 1;
+        }
+        if(join)
+            sprintf(buf + len, "%s/%s", req->cwd, req->argv[i]);
+        else
+            memcpy(buf + len, req->argv[i], arg_len);
+        len += arg_len;
+    }
+    free(req->buf);
+    req->buf = buf;
+    return split_request(req, len); /* it's been split once */
+}
+
+int ctl_send_wait(int argc, const char **argv, int ms)
+{
+    int status;
+    for(; (status = ctl_send(argc, argv)) < 0 && ms > 0; ms -= CTL_RETRY_MS)
+        usleep(CTL_RETRY_MS*1000);
+    return status;
+}
+
+int ctl_lock(const char *name)
+{
+    char suffix[CTL_PATH_LEN], path[CTL_PATH_LEN];
+    int fd, busy;
+    snprintf(suffix, sizeof(suffix), CTL_LOCK_SUFFIX, name);
+    if(runtime_path(path, sizeof(path), suffix))
+        return 0;
+    fd = open(path, O_RDWR | O_CREAT, 0600);
+    if(fd < 0)
+        return 0;
+    if(0 == flock(fd, LOCK_EX | LOCK_NB))
+        return 0; /* fd stays open, the lock goes with the process */
+    busy = errno == EWOULDBLOCK;
+    close(fd);
+    return busy;
+}
+
+/* Private to the user: $XDG_RUNTIME_DIR, or /tmp with the user id */
+static int runtime_path(char *buf, size_t size, const char *suffix)
+{
+    const char *dir = getenv("XDG_RUNTIME_DIR");
+    char base[CTL_PATH_LEN];
+    int len;
+    if(dir && *dir)
+        snprintf(base, sizeof(base), "%s/%s", dir, CTL_RUNTIME_NAME);
+    else
+        snprintf(base, sizeof(base), CTL_TMP_NAME, (unsigned long)getuid());
+    len = snprintf(buf, size, "%s%s", base, suffix);
+    return len < 0 || (size_t)len >= size;
+}
+
+static int sock_path(struct sockaddr_un *addr)
+{
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    return runtime_path(addr->sun_path, sizeof(addr->sun_path),
+                        CTL_SOCK_SUFFIX);
+}
+
+static int write_all(int fd, const char *buf, size_t len)
+{
+    ssize_t n;
+    while(len > 0) {
+        n = write(fd, buf, len);
+        if(n < 0 && errno == EINTR)
+            continue;
+        if(n <= 0)
+            return 1;
+        buf += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/* 1 if there's no one, or no memory for the request */
+static int accept_client(int fd)
+{
+    client.fd = accept(fd, NULL, NULL);
+    if(client.fd < 0)
+        return 1;
+    client.buf = malloc(CTL_MAX_REQUEST);
+    if(!client.buf ||
+       fcntl(client.fd, F_SETFL, fcntl(client.fd, F_GETFL) | O_NONBLOCK)) {
+        drop_client();
+        return 1;
+    }
+    client.len = 0;
+    clock_gettime(CLOCK_MONOTONIC, &client.start);
+    return 0;
+}
+
+static void drop_client(void)
+{
+    if(client.fd >= 0)
+        close(client.fd);
+    client.fd = -1;
+    free(client.buf);
+    client.buf = NULL;
+}
+
+/* What the client has sent since the last time, however it splits it */
+static int read_request(int fd, char *buf, size_t *len)
+{
+    ssize_t n;
+    for(;;) {
+        n = read(fd, buf + *len, CTL_MAX_REQUEST - *len);
+        if(n < 0 && errno == EINTR)
+            continue;
+        if(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return REQ_PARTIAL;
+        if(n < 0)
+            return REQ_WRONG;
+        if(n == 0)
+            return REQ_DONE;
+        *len += n;
+        if(*len == CTL_MAX_REQUEST) /* no room for the end */
+            return REQ_WRONG;
+    }
+}
+
+/* The working directory first, then the arguments, as split_request wants */
+static int pack_request(char *buf, size_t *len, int argc, const char **argv)
+{
+    size_t arg_len;
+    int i;
+    if(!getcwd(buf, CTL_MAX_REQUEST))
+        buf[0] = '\0'; /* the relative paths just won't work */
+    *len = strlen(buf)+1;
+    for(i = 1; i < argc; i++) {
+        arg_len = strlen(argv[i])+1;
+        if(arg_len >= CTL_MAX_REQUEST - *len) /* as read_request wants */
+            return 1;
+        memcpy(buf + *len, argv[i], arg_len);
+        *len += arg_len;
+    }
+    return 0;
+}
+
+/* The working directory first, then the arguments */
+static int split_request(struct ctl_request *req, size_t len)
+{
+    char *p = req->buf, *end = req->buf + len;
+    if(len == 0 || end[-1] != '\0')
+        return 1;
+    req->cwd = p;
+    p += strlen(p)+1;
+    req->argv[0] = PROG_NAME;
+    for(req->argc = 1; p < end; req->argc++) {
+        if(req->argc == CTL_MAX_ARGS)
+            return 1;
+        req->argv[req->argc] = p;
+        p += strlen(p)+1;
+    }
+    req->argv[req->argc] = NULL;
+    return 0;
+}
+
+static long ms_since(const struct timespec *start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long)(now.tv_sec - start->tv_sec)*1000L +
+           (now.tv_nsec - start->tv_nsec)/1000000L;
+}
@@ -0,0 +1,108 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File control.h
+ * The control socket of the running program. A request is the working
+ * directory of the client and the arguments of its command line, each
+ * ended by '\0', then the client shuts its writing side down. The reply is
+ * the exit status as a digit and the messages the request has caused.
+ * The program checks a request in a child process first, so a wrong one
+ * is reported back and never stops the program.
+ * A lock file per microphone keeps two programs from claiming it at once:
+ * the one that comes second hands its request over instead.
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#ifndef CONTROL_SENTRY
+#define CONTROL_SENTRY
+
+#include <stddef.h> /* for size_t */
+#include "locale_macros.h"
+
+/* Constants */
+#define CTL_RUNTIME_NAME "quadcastrgb" /* in $XDG_RUNTIME_DIR */
+#define CTL_TMP_NAME "/tmp/quadcastrgb-%lu" /* else, per user id */
+#define CTL_SOCK_SUFFIX ".sock"
+#define CTL_LOCK_SUFFIX "-%s.lock" /* with the name of the microphone */
+#define CTL_PATH_LEN 256
+#define CTL_BACKLOG 4
+#define CTL_MAX_REQUEST 4096 /* bytes */
+#define CTL_MAX_ARGS 128
+#define CTL_MAX_REPLY 1024
+#define CTL_TIMEOUT_MS 100 /* for a client to say everything */
+#define CTL_WAIT_MS 3000 /* for a program starting to open the socket */
+#define CTL_RETRY_MS 10
+
+/* Messages */
+#define CTL_NODAEMON_MSG _("No running quadcastrgb to control\n")
+#define CTL_BADREQ_MSG _("The request can't be carried out\n")
+#define CTL_NOREPLY_MSG _("The running quadcastrgb hasn't replied\n")
+#define CTL_BUSY_MSG _("Another quadcastrgb has the microphone, but it " \
+                       "doesn't take requests\n")
+#define CTL_LISTEN_ERR_MSG _("Couldn't open the control socket %s, " \
+                             "the colors can't be changed while running\n")
+
+/* Structs */
+struct ctl_request {
+    int fd; /* the client */
+    char *buf; /* where the strings are, owned */
+    const char *cwd; /* the client's working directory */
+    int argc; /* argv[0] is the program name, like in main */
+    const char *argv[CTL_MAX_ARGS+1];
+};
+
+struct ctl_checker { /* a check running in a child */
+    int pid; /* -1 if none */
+    int fd; /* to poll, the child's messages come through it */
+    size_t len;
+    char msg[CTL_MAX_REPLY];
+};
+
+/* Functions */
+/* The running program */
+int ctl_listen(void); /* -1 if there's no socket, it isn't fatal */
+void ctl_unlisten(int fd);
+/* 1 if a request has come, the frames mustn't wait for one: what a client
+ * has sent so far is kept, the rest is read on the next calls */
+int ctl_accept(int fd, struct ctl_request *req);
+int ctl_fd(int fd); /* to poll: the client being read, else the socket */
+void ctl_reply(struct ctl_request *req, int status, const char *msg);
+void ctl_free_request(struct ctl_request *req); /* the buf may be taken */
+/* Runs check in a child, 0 if it has returned; its messages go to msg */
+int ctl_check(void (*check)(int argc, const char **argv),
+              int argc, const char **argv, char *msg, size_t len);
+/* The same without waiting: 0, or 1 and ck->msg if it can't be started */
+int ctl_check_start(struct ctl_checker *ck,
+                    void (*check)(int argc, const char **argv),
+                    int argc, const char **argv);
+/* -1 while the child runs, then as ctl_check; the messages are in ck->msg */
+int ctl_check_poll(struct ctl_checker *ck);
+/* A client, prints the reply and returns the status of the request, or
+ * -1 if there's nothing to send it to */
+int ctl_send(int argc, const char **argv);
+/* A request made in place, as if it had come: 0, or 1 if it's too long */
+int ctl_make_request(struct ctl_request *req, int argc, const char **argv);
+/* The relative paths among the arguments, where paths[i] is 1, are joined
+ * to the working directory of the request: 0, or 1 if it's too long */
+int ctl_rebase(struct ctl_request *req, const char *paths);
+int ctl_send_wait(int argc, const char **argv, int ms); /* -1 after ms */
+/* The lock of a microphone: 1 if another program holds it, else it's held
+ * until the exit. Without a place for the lock file it's 0 anyway */
+int ctl_lock(const char *name);
+
+#endif
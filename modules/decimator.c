@@ -0,0 +1,115 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File decimator.c
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#include <stdio.h> /* for printf */
+#include <math.h> /* for pow */
+
+#include "decimator.h"
+
+/* The lightness of every channel value (BE CAREFUL: GLOBAL VARIABLES) */
+static int lightness[256];
+static int lightness_ready = 0;
+
+static void fill_lightness(void);
+static int distance(int col1, int col2);
+
+/* Functions */
+void dec_init(struct decimator *dc, int merge)
+{
+    if(!lightness_ready)
+        fill_lightness();
+    dec_set_merge(dc, merge);
+    dc->since = 0;
+    dc->upper = dc->lower = 0;
+    dc->primed = 0;
+    dc->frames = dc->sent = 0;
+    dc->upper_changes = dc->lower_changes = 0;
+}
+
+void dec_set_merge(struct decimator *dc, int merge)
+{
+    dc->threshold = merge*DEC_L_SCALE;
+}
+
+int dec_frame(struct decimator *dc, int upper_col, int lower_col)
+{
+    int du, dl, send;
+    du = distance(upper_col, dc->upper);
+    dl = distance(lower_col, dc->lower);
+    dc->frames++;
+    if(du > 0 && du >= dc->threshold)
+        dc->upper_changes++;
+    if(dl > 0 && dl >= dc->threshold)
+        dc->lower_changes++;
+    send = !dc->primed || du >= dc->threshold || dl >= dc->threshold ||
+           dc->since+1 >= DEC_MAX_SKIP;
+    if(!send) {
+        dc->since++;
+        return 0;
+    }
+    dc->upper = upper_col;
+    dc->lower = lower_col;
+    dc->primed = 1;
+    dc->since = 0;
+    dc->sent++;
+    return 1;
+}
+
+void dec_report(const struct decimator *dc, const char *upper_mode,
+                const char *lower_mode)
+{
+    unsigned long saved = dc->frames - dc->sent;
+    printf(DEC_GROUP_MSG, DEC_UPPER_NAME, upper_mode, dc->frames,
+           dc->upper_changes);
+    printf(DEC_GROUP_MSG, DEC_LOWER_NAME, lower_mode, dc->frames,
+           dc->lower_changes);
+    printf(DEC_TOTAL_MSG, dc->frames, dc->sent, saved,
+           dc->frames ? saved*100/dc->frames : 0);
+}
+
+/* The diodes are driven linearly, so a channel value is the luminance */
+static void fill_lightness(void)
+{
+    int v;
+    for(v = 0; v < 256; v++) {
+        double y = v/255.0, l;
+        l = (y > 216.0/24389.0) ? 116.0*pow(y, 1.0/3.0) - 16.0
+                                : y*24389.0/27.0;
+        lightness[v] = (int)(l*DEC_L_SCALE + 0.5);
+    }
+    lightness_ready = 1;
+}
+
+/* The largest lightness difference of the three channels */
+static int distance(int col1, int col2)
+{
+    int shift, d, max = 0;
+    for(shift = 16; shift >= 0; shift -= 8) {
+        d = lightness[(col1 >> shift) & 0xff] -
+            lightness[(col2 >> shift) & 0xff];
+        if(d < 0)
+            d = -d;
+        if(d > max)
+            max = d;
+    }
+    return max;
+}
@@ -0,0 +1,64 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File decimator.h
+ * Decides which frames are worth the transfers: a frame the eye can't
+ * tell from the one sent last isn't sent, the diodes just hold the colors
+ * longer. The colors are compared by the lightness of every channel
+ * (CIE L*), so a step of one in the dark counts more than in the bright.
+ * The frames are still counted on the clock, so the timing stays exact.
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#ifndef DECIMATOR_SENTRY
+#define DECIMATOR_SENTRY
+
+#include "locale_macros.h"
+
+/* Constants */
+#define DEC_L_SCALE 16 /* the lightness is kept in 1/16 of L* */
+#define DEC_MAX_MERGE 100 /* L* */
+#define DEC_MAX_SKIP 50 /* frames, the colors are sent again after them */
+
+/* Messages */
+#define DEC_GROUP_MSG _("%s (%s): %lu frames, changed in %lu\n")
+#define DEC_TOTAL_MSG _("Transfers: %lu frames, %lu sent, %lu saved (%lu%%)\n")
+#define DEC_UPPER_NAME _("Upper diode")
+#define DEC_LOWER_NAME _("Lower diodes")
+
+/* Structs */
+struct decimator {
+    int threshold; /* in DEC_L_SCALE of L*, 0 sends every frame */
+    unsigned int since; /* frames since the last one sent */
+    int upper, lower; /* the colors sent last */
+    int primed; /* something is sent already */
+    /* Statistics */
+    unsigned long frames, sent;
+    unsigned long upper_changes, lower_changes; /* frames a group changed */
+};
+
+/* Functions */
+void dec_init(struct decimator *dc, int merge); /* merge: L*, 0-100 */
+void dec_set_merge(struct decimator *dc, int merge); /* the stats go on */
+/* Counts the frame of the given colors, 1 if it must be sent */
+int dec_frame(struct decimator *dc, int upper_col, int lower_col);
+/* Prints the statistics, the modes name the groups */
+void dec_report(const struct decimator *dc, const char *upper_mode,
+                const char *lower_mode);
+
+#endif
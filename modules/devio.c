@@ -23,9 +23,14 @@
  * Also, you may visit the Free Software Foundation at
  * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
  */
+#include <string.h> /* for strlen, memcpy */
 #include <unistd.h> /* for usleep */
+#include <time.h> /* for clock_gettime */
 #include <fcntl.h> /* for daemonization */
 #include <signal.h> /* for signal handling */
+#include <syslog.h> /* for syslog, a daemon has no stderr */
+#include <pthread.h> /* for the generator thread */
+#include <poll.h> /* for poll, waiting for a request or a key */
 
 #include "locale_macros.h"
 
@@ -53,6 +58,18 @@
 #define BREQUEST_IN 0x01
 #define WVALUE 0x0300
 #define WINDEX 0x0000
+/* Device keys */
+#define FNV_OFFSET 14695019685272060421ULL
+#define FNV_PRIME 1099511628211ULL
+/* What has come while waiting for a frame, bits */
+#define INPUT_CTL 1
+#define INPUT_KEYS 2
+#define INPUT_CHECK 4
+#define PROG_NAME "quadcastrgb" /* argv[0] of the requests made */
+/* How long the generator sleeps when enough frames wait */
+#define PIPE_IDLE_US (FRAME_MS*1000L/4)
+/* The budget of a library loaded while running */
+#define CACHE_KIB(CS) ((CS)->cache == NOT_GIVEN ? CACHE_DEFAULT : (CS)->cache)
 /* Messages */
 #define DEVLIST_ERR_MSG _("Couldn't get the list of USB devices.\n")
 #define NODEV_ERR_MSG _("HyperX Quadcast S/DuoCast isn't connected or accessible through USB.\n")
@@ -66,6 +83,13 @@
 #define SIZEPCK_ERR_MSG _("Size packet error: %s\n")
 #define DATAPCK_ERR_MSG _("Data packet error: %s\n")
 #define PID_MSG _("Started with pid %d\n")
+#define RELOAD_ERR_MSG _("The scene isn't reloaded, the old one plays: %s")
+#define BUILD_ERR_MSG _("The scene couldn't be made from its files, the old " \
+                        "one plays.\n")
+#define RELOAD_BUILD_MSG _("The scene isn't reloaded, its files have " \
+                           "changed since the check.\n")
+#define THREAD_ERR_MSG _("Couldn't start the generator thread, the frames " \
+                         "are made as they're sent.\n")
 /* Error codes */
 enum {
     libusberr = 2,
@@ -77,7 +101,7 @@ enum {
 /* For open_micro */
 #define FREE_AND_EXIT() \
     libusb_free_device_list(devs, 1); \
-    free(data_arr); \
+    free(cs); \
     libusb_exit(NULL); \
     exit(libusberr)
 
@@ -92,7 +116,7 @@ enum {
         fprintf(stderr, TRANSFER_ERR_MSG); \
         libusb_close(handle); \
         libusb_exit(NULL); \
-        free(data_arr); \
+        free_scene(sc); \
         exit(transfererr); \
     }
 
@@ -111,15 +135,68 @@ const unsigned short product_ids_hp[] = {
     0x098c  /* Duocast */
 };
 
+/* Structs */
+struct sender { /* kept while reconnecting */
+    struct player pl;
+    struct dimmer dims[2]; /* upper, lower */
+    struct decimator dc;
+    const struct calibration *cal;
+    unsigned int fade; /* frames of a crossfade to a requested scene */
+    int ctl; /* the control socket, -1 if none */
+    const char *upper_mode, *lower_mode; /* of the scene, for statistics */
+    struct ctl_request scene; /* the one the modes are from, owned */
+    struct ctl_request waiting; /* being checked, owned */
+    struct ctl_checker check; /* of the waiting one, pid -1 if none */
+    int reloading; /* the waiting one is a copy of the scene */
+    int reload_due; /* its files have changed while another was checked */
+    struct watch wt; /* the files of the scene */
+    int preset; /* the one playing, -1 if the scene isn't a preset */
+    uint64_t key; /* of the microphone, for the seeds of the scenes */
+    byte_t packet[PACKET_SIZE]; /* the colors of the last frame made */
+    int repack; /* the colors have changed since the packet was made */
+    int upper_out, lower_out; /* the colors in the packet */
+    struct pipeline *pipe; /* of the generator thread, NULL if there's none */
+    pthread_t generator; /* runs while there's the pipe */
+    int halt; /* asks the generator to return, atomic */
+};
+
 /* Microphone opening */
 static int claim_dev_interface(libusb_device_handle *handle);
 static libusb_device *dev_search(libusb_device **devs, ssize_t cnt);
 static int is_compatible_mic(libusb_device *dev);
+static uint64_t fnv1a(uint64_t hash, const unsigned char *data, size_t len);
+static int lock_micro(libusb_device_handle *handle);
 /* Packet transfer */
 static short send_display_command(byte_t *packet,
                                   libusb_device_handle *handle);
-static int display_data_arr(libusb_device_handle *handle,
-                             const byte_t *colcommand, const byte_t *end);
+static int display_scene(libusb_device_handle *handle, struct sender *snd);
+static int make_frame(struct sender *snd);
+static void start_generator(struct sender *snd, unsigned int ahead);
+static void halt_generator(struct sender *snd);
+static void resume_generator(struct sender *snd);
+static void *generate(void *arg);
+static int fill_pipe(struct sender *snd);
+static void poll_dim_signals(struct dimmer *dims);
+static void poll_inputs(struct sender *snd);
+static void poll_control(struct sender *snd);
+static int rebase_request(struct ctl_request *req);
+static void poll_check(struct sender *snd);
+static void poll_live(struct sender *snd);
+static int poll_hotkeys(struct sender *snd);
+static void check_request(int argc, const char **argv);
+static int apply_request(struct sender *snd, struct ctl_request *req,
+                         char *msg, size_t len);
+static void load_presets(struct sender *snd, const struct colschemes *cs);
+static int preset_of(const struct colschemes *cs);
+static void poll_reload(struct sender *snd);
+static void finish_reload(struct sender *snd, int status);
+static int same_args(const struct ctl_request *a,
+                     const struct ctl_request *b);
+static struct scene *build_scene(struct colschemes *cs, uint64_t key);
+static void switch_scene(struct sender *snd, struct scene *sc);
+static void watch_scene(struct sender *snd, const struct colschemes *cs);
+static void wait_frame(struct sender *snd, struct timespec *deadline);
+static int wait_input(int ctl, int keys, int check, long usec);
 #if !defined(DEBUG) && !defined(OS_MAC)
 static void daemonize(int verbose);
 #endif
@@ -127,17 +204,39 @@ static void daemonize(int verbose);
 static void print_packet(byte_t *pck, char *str);
 #endif
 
-/* Signal handling */
+/* Signal handling. The handlers run in the sending thread only; the
+ * generator thread reads what they write atomically, GCC and Clang builtins */
+#define SIG_LOAD(V) __atomic_load_n(&(V), __ATOMIC_RELAXED)
+#define SIG_STORE(V, N) __atomic_store_n(&(V), (N), __ATOMIC_RELAXED)
+#define SIG_COUNT(V) __atomic_add_fetch(&(V), 1, __ATOMIC_RELAXED)
 volatile static sig_atomic_t nonstop = 0; /* BE CAREFUL: GLOBAL VARIABLE */
 static void nonstop_reset_handler(int s)
 {
     /* No need in saving errno or setting the handler again
      * because the program just frees memory and exits */
-    nonstop = 0;
+    SIG_STORE(nonstop, 0);
+}
+/* Counted, so that no press is lost while a frame is being sent */
+static volatile sig_atomic_t dim_downs = 0, dim_ups = 0;
+static void dim_down_handler(int s)
+{
+    SIG_COUNT(dim_downs);
+    signal(SIGUSR1, dim_down_handler);
+}
+static void dim_up_handler(int s)
+{
+    SIG_COUNT(dim_ups);
+    signal(SIGUSR2, dim_up_handler);
+}
+static volatile sig_atomic_t reloads = 0;
+static void reload_handler(int s)
+{
+    SIG_COUNT(reloads);
+    signal(SIGHUP, reload_handler);
 }
 
 /* Functions */
-libusb_device_handle *open_micro(datpack *data_arr)
+libusb_device_handle *open_micro(struct colschemes *cs)
 {
     libusb_device **devs;
     libusb_device *micro_dev = NULL;
@@ -149,7 +248,7 @@ libusb_device_handle *open_micro(datpack *data_arr)
     errcode = libusb_init(NULL);
     if(errcode) {
         perror("libusb_init");
-        free(data_arr); exit(libusberr);
+        free(cs); exit(libusberr);
     }
 
     /* Set libusb options for better USB hub compatibility */
@@ -218,6 +317,12 @@ libusb_device_handle *open_micro(datpack *data_arr)
         fprintf(stderr, "%s\n%s", libusb_strerror(errcode), OPEN_ERR_MSG);
         FREE_AND_EXIT();
     }
+    if(lock_micro(handle)) { /* not a USB error, the caller decides */
+        libusb_close(handle);
+        libusb_free_device_list(devs, 1);
+        libusb_exit(NULL);
+        return NULL;
+    }
     errcode = claim_dev_interface(handle);
     if(errcode) {
         libusb_close(handle); FREE_AND_EXIT();
@@ -226,6 +331,64 @@ libusb_device_handle *open_micro(datpack *data_arr)
     return handle;
 }
 
+/* Before claiming: the interfaces of a microphone another program is
+ * starting with would be taken from under it */
+static int lock_micro(libusb_device_handle *handle)
+{
+    char name[17];
+    sprintf(name, "%016llx", (unsigned long long)dev_key(handle));
+    return ctl_lock(name);
+}
+
+/* VID:PID and the serial number, or the USB port path if there's no serial.
+ * Two identical microphones get different keys and so different colors */
+uint64_t dev_key(libusb_device_handle *handle)
+{
+    libusb_device *dev = libusb_get_device(handle);
+    struct dev_ident id;
+    unsigned char buf[SERIAL_LEN];
+    uint64_t hash = FNV_OFFSET;
+    int len;
+
+    if(dev_ident(handle, &id) == 0) {
+        buf[0] = id.vid >> 8; buf[1] = id.vid & 0xff;
+        buf[2] = id.pid >> 8; buf[3] = id.pid & 0xff;
+        hash = fnv1a(hash, buf, 4);
+        if(id.serial[0])
+            return fnv1a(hash, (unsigned char *)id.serial,
+                         strlen(id.serial));
+    }
+    buf[0] = libusb_get_bus_number(dev);
+    len = libusb_get_port_numbers(dev, buf+1, SERIAL_LEN-1);
+    return fnv1a(hash, buf, len > 0 ? len+1 : 1);
+}
+
+int dev_ident(libusb_device_handle *handle, struct dev_ident *id)
+{
+    struct libusb_device_descriptor descr;
+    int len = 0;
+
+    id->serial[0] = '\0';
+    if(libusb_get_device_descriptor(libusb_get_device(handle), &descr))
+        return 1;
+    id->vid = descr.idVendor;
+    id->pid = descr.idProduct;
+    if(descr.iSerialNumber)
+        len = libusb_get_string_descriptor_ascii(handle, descr.iSerialNumber,
+                                     (unsigned char *)id->serial, SERIAL_LEN);
+    id->serial[len > 0 && len < SERIAL_LEN ? len : 0] = '\0';
+    return 0;
+}
+
+static uint64_t fnv1a(uint64_t hash, const unsigned char *data, size_t len)
+{
+    for(; len > 0; data++, len--) {
+        hash ^= *data;
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
 static int claim_dev_interface(libusb_device_handle *handle)
 {
     int errcode0, errcode1;
@@ -335,25 +498,61 @@ static int is_compatible_mic(libusb_device *dev)
 
 static libusb_device_handle *attempt_reconnect(void);
 
-void send_packets(libusb_device_handle *handle, const datpack *data_arr,
-                  int pck_cnt, int verbose)
+void send_packets(libusb_device_handle *handle, struct scene *sc,
+                  const struct output_opts *opt, int verbose)
 {
-    short command_cnt;
     int reconnect_attempts = 0;
     libusb_device_handle *current_handle = handle;
+    struct sender snd;
+    struct colschemes *cs;
+    char msg[CTL_MAX_REPLY];
+    int v = 0;
+    player_init(&snd.pl, sc);
+    player_set_rate(&snd.pl, opt->rate);
+    dim_init(&snd.dims[0], opt->upper_dim);
+    dim_init(&snd.dims[1], opt->lower_dim);
+    dec_init(&snd.dc, opt->merge);
+    snd.cal = &opt->cal;
+    snd.fade = opt->fade;
+    snd.upper_mode = opt->upper_mode;
+    snd.lower_mode = opt->lower_mode;
+    watch_init(&snd.wt);
+    snd.preset = -1;
+    snd.key = dev_key(handle); /* the same after a reconnection */
+    snd.repack = 1; /* the packet is empty */
+    snd.upper_out = snd.lower_out = 0;
+    snd.pipe = NULL;
+    snd.waiting.fd = -1;
+    snd.waiting.buf = NULL;
+    snd.check.pid = snd.check.fd = -1;
+    snd.reloading = snd.reload_due = 0;
+    if(ctl_make_request(&snd.scene, opt->argc, opt->argv) == 0 &&
+       rebase_request(&snd.scene) == 0) {
+        /* Parsed before, it can't fail */
+        cs = parse_opts(snd.scene.argc, snd.scene.argv, &v);
+        watch_scene(&snd, cs);
+        snd.preset = preset_of(cs);
+        free(cs);
+    }
     #ifdef DEBUG
     puts("Entering display mode...");
     #endif
     #if !defined(DEBUG) && !defined(OS_MAC)
     daemonize(verbose);
     #endif
-    command_cnt = count_color_commands(data_arr, pck_cnt, 0);
     signal(SIGINT, nonstop_reset_handler);
     signal(SIGTERM, nonstop_reset_handler);
+    signal(SIGUSR1, dim_down_handler);
+    signal(SIGUSR2, dim_up_handler);
+    signal(SIGHUP, reload_handler);
+    signal(SIGPIPE, SIG_IGN); /* a client may leave before the reply */
+    snd.ctl = ctl_listen(); /* by the process that stays */
     /* The loop works until a signal handler resets the variable */
     nonstop = 1; /* set to 1 only here */
+    if(opt->ahead) /* after the daemonization, a thread doesn't survive it */
+        start_generator(&snd, opt->ahead);
     while(nonstop) {
-        int display_result = display_data_arr(current_handle, *data_arr, *data_arr+2*BYTE_STEP*command_cnt);
+        int display_result = display_scene(current_handle, &snd);
         if(display_result != 0 && nonstop) {
             /* USB error occurred, try to reconnect */
             #ifdef DEBUG
@@ -390,6 +589,23 @@ void send_packets(libusb_device_handle *handle, const datpack *data_arr,
     }
 
     /* Clean up when exiting */
+    if(snd.pipe) /* it sees nonstop reset too */
+        pthread_join(snd.generator, NULL);
+    ctl_unlisten(snd.ctl);
+    player_free(&snd.pl);
+    if(verbose) {
+        dec_report(&snd.dc, snd.upper_mode, snd.lower_mode);
+        if(0 == preset_stats(msg, sizeof(msg)))
+            fputs(msg, stdout);
+        if(snd.pipe) {
+            pipe_report(snd.pipe, msg, sizeof(msg));
+            fputs(msg, stdout);
+        }
+    }
+    free(snd.pipe);
+    ctl_free_request(&snd.scene);
+    ctl_free_request(&snd.waiting); /* a check left runs out by itself */
+    watch_free(&snd.wt);
     if(current_handle) {
         libusb_release_interface(current_handle, 0);
         libusb_release_interface(current_handle, 1);
@@ -423,39 +639,557 @@ static void daemonize(int verbose)
 }
 #endif
 
-static int display_data_arr(libusb_device_handle *handle,
-                             const byte_t *colcommand, const byte_t *end)
+/* Plays the scene until a signal comes or a transfer fails. The frames are
+ * made here or taken from the generator thread, which has them ready; the
+ * inputs are taken here anyway */
+static int display_scene(libusb_device_handle *handle, struct sender *snd)
 {
     short sent;
-    byte_t *packet;
+    const byte_t *packet;
+    const struct pipe_frame *fr = NULL;
+    struct timespec deadline;
     byte_t header_packet[PACKET_SIZE] = {
         HEADER_CODE, DISPLAY_CODE, 0, 0, 0, 0, 0, 0, PACKET_CNT, 0, 0, 0,
         0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
     };
-    packet = calloc(PACKET_SIZE, 1);
-    while(colcommand < end && nonstop) {
+    /* The device might have forgotten the colors */
+    if(snd->pipe)
+        pipe_resend(snd->pipe);
+    else
+        snd->dc.primed = 0;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    while(nonstop) {
+        if(snd->pipe) { /* none on an underrun, the colors stay */
+            poll_inputs(snd);
+            fr = pipe_peek(snd->pipe);
+            packet = fr && fr->send ? fr->packet : NULL;
+        } else {
+            packet = make_frame(snd) ? snd->packet : NULL;
+        }
+        if(!packet) { /* held longer */
+            if(fr)
+                pipe_pop(snd->pipe);
+            wait_frame(snd, &deadline);
+            continue;
+        }
+        /* A frame that fails stays in the pipeline for the next device */
         sent = send_display_command(header_packet, handle);
-        if(sent != PACKET_SIZE) {
-            free(packet);
+        if(sent != PACKET_SIZE)
             return -1; /* Return error instead of setting nonstop */
-        }
-        memcpy(packet, colcommand, 2*BYTE_STEP);
         sent = libusb_control_transfer(handle, BMREQUEST_TYPE_OUT,
-                   BREQUEST_OUT, WVALUE, WINDEX, packet, PACKET_SIZE, TIMEOUT);
-        if(sent != PACKET_SIZE) {
-            free(packet);
+                   BREQUEST_OUT, WVALUE, WINDEX, (byte_t *)packet,
+                   PACKET_SIZE, TIMEOUT);
+        if(sent != PACKET_SIZE)
             return -1; /* Return error instead of setting nonstop */
-        }
         #ifdef DEBUG
-        print_packet(packet, "Data:");
+        print_packet((byte_t *)packet, "Data:");
         #endif
-        colcommand += 2*BYTE_STEP;
-        usleep(1000*20);  /* Reduced from 55ms to 20ms for faster color updates */
+        if(fr)
+            pipe_pop(snd->pipe);
+        wait_frame(snd, &deadline);
     }
-    free(packet);
     return 0; /* Success */
 }
 
+/* The colors of the next frame into snd->packet, 0 if it's not to be sent.
+ * The inputs and the signals since the last frame are taken first; with
+ * the generator thread, the sending one takes the inputs */
+static int make_frame(struct sender *snd)
+{
+    struct dimmer *dims = snd->dims;
+    int upper_col, lower_col, repack;
+    if(!snd->pipe)
+        poll_inputs(snd);
+    poll_dim_signals(dims);
+    repack = player_next(&snd->pl, &upper_col, &lower_col) | snd->repack;
+    /* Both ramps must move, so no short-circuit */
+    repack = dim_tick(&dims[0]) | dim_tick(&dims[1]) | repack;
+    if(repack) { /* the dimmed colors are corrected for the device */
+        snd->upper_out = cal_color(snd->cal, dim_color(&dims[0], upper_col));
+        snd->lower_out = cal_color(snd->cal, dim_color(&dims[1], lower_col));
+        pack_colpair(snd->upper_out, snd->lower_out, snd->packet);
+    }
+    snd->repack = 0;
+    return dec_frame(&snd->dc, snd->upper_out, snd->lower_out);
+}
+
+/* The first frames are made before the thread starts, so the sender has
+ * them at once. Without the thread, they're sent as they're made */
+static void start_generator(struct sender *snd, unsigned int ahead)
+{
+    snd->pipe = malloc(sizeof(*snd->pipe));
+    pipe_init(snd->pipe, ahead);
+    resume_generator(snd);
+}
+
+/* The sending thread stops it to fork or to change what it has, so the
+ * two never share the player, the dimmers or the presets */
+static void halt_generator(struct sender *snd)
+{
+    if(!snd->pipe)
+        return;
+    SIG_STORE(snd->halt, 1);
+    pthread_join(snd->generator, NULL);
+}
+
+/* The pipeline is filled up first, a change shows as soon as it can */
+static void resume_generator(struct sender *snd)
+{
+    sigset_t handled, old;
+    int err;
+    if(!snd->pipe)
+        return;
+    SIG_STORE(snd->halt, 0);
+    fill_pipe(snd);
+    /* The thread inherits the mask, so the signals come to this one */
+    sigemptyset(&handled);
+    sigaddset(&handled, SIGINT);
+    sigaddset(&handled, SIGTERM);
+    sigaddset(&handled, SIGUSR1);
+    sigaddset(&handled, SIGUSR2);
+    sigaddset(&handled, SIGHUP);
+    pthread_sigmask(SIG_BLOCK, &handled, &old);
+    err = pthread_create(&snd->generator, NULL, generate, snd);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    if(err == 0)
+        return;
+    fprintf(stderr, THREAD_ERR_MSG);
+    syslog(LOG_ERR, THREAD_ERR_MSG);
+    free(snd->pipe);
+    snd->pipe = NULL;
+}
+
+/* The generator thread has the player, the dimmers and the decimator
+ * while it runs. While enough frames wait, it sleeps */
+static void *generate(void *arg)
+{
+    struct sender *snd = arg;
+    while(SIG_LOAD(nonstop) && !SIG_LOAD(snd->halt)) {
+        if(!fill_pipe(snd))
+            usleep(PIPE_IDLE_US);
+    }
+    return NULL;
+}
+
+/* The number of frames made, 0 if the pipeline is full */
+static int fill_pipe(struct sender *snd)
+{
+    struct pipe_frame *fr;
+    int cnt = 0;
+    while(SIG_LOAD(nonstop) && (fr = pipe_slot(snd->pipe))) {
+        if(pipe_resent(snd->pipe))
+            snd->dc.primed = 0;
+        fr->send = make_frame(snd);
+        if(fr->send)
+            memcpy(fr->packet, snd->packet, PACKET_SIZE);
+        pipe_push(snd->pipe);
+        cnt++;
+    }
+    return cnt;
+}
+
+/* Sleeps until the next frame is due, however long the transfers took.
+ * A request is taken as soon as it comes and carried out once its check
+ * is done, the frame stays on time. A hotkey doesn't wait for the frame,
+ * the new scene is sent at once and the frames go on from it; the ones
+ * the generator thread has made ahead are dropped */
+static void wait_frame(struct sender *snd, struct timespec *deadline)
+{
+    struct timespec now;
+    long left;
+    int keys = hotkey_fd(), ctl, ready;
+    deadline->tv_nsec += FRAME_MS*1000000L;
+    if(deadline->tv_nsec >= 1000000000L) {
+        deadline->tv_sec++;
+        deadline->tv_nsec -= 1000000000L;
+    }
+    for(;;) {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        left = (long)(deadline->tv_sec - now.tv_sec)*1000000L +
+               (deadline->tv_nsec - now.tv_nsec)/1000;
+        if(left <= 0)
+            break;
+        /* poll counts milliseconds */
+        if((snd->ctl < 0 && keys < 0 && snd->check.fd < 0) || left < 1000) {
+            usleep(left);
+            return;
+        }
+        /* A client waits until the check before it is done */
+        ctl = snd->ctl < 0 || snd->check.pid >= 0 ? -1 : ctl_fd(snd->ctl);
+        ready = wait_input(ctl, keys, snd->check.fd, left);
+        if(ready & INPUT_CHECK)
+            poll_check(snd);
+        if(ready & INPUT_CTL)
+            poll_control(snd);
+        if(ready & INPUT_KEYS && poll_hotkeys(snd)) {
+            clock_gettime(CLOCK_MONOTONIC, deadline);
+            return;
+        }
+    }
+    if(left < -1000L*FRAME_MS) /* too late to catch up, go on from now */
+        *deadline = now;
+}
+
+/* The descriptors are optional, poll skips the negative ones */
+static int wait_input(int ctl, int keys, int check, long usec)
+{
+    struct pollfd pfd[3];
+    pfd[0].fd = ctl;
+    pfd[1].fd = keys;
+    pfd[2].fd = check;
+    pfd[0].events = pfd[1].events = pfd[2].events = POLLIN;
+    pfd[0].revents = pfd[1].revents = pfd[2].revents = 0;
+    if(poll(pfd, 3, (int)(usec / 1000)) <= 0)
+        return 0;
+    return (pfd[0].revents ? INPUT_CTL : 0) |
+           (pfd[1].revents ? INPUT_KEYS : 0) |
+           (pfd[2].revents ? INPUT_CHECK : 0);
+}
+
+/* Starts the ramps for the signals that came since the last frame */
+static void poll_dim_signals(struct dimmer *dims)
+{
+    static sig_atomic_t seen_downs = 0, seen_ups = 0;
+    sig_atomic_t downs = SIG_LOAD(dim_downs), ups = SIG_LOAD(dim_ups);
+    int i, delta;
+    if(downs == seen_downs && ups == seen_ups)
+        return;
+    delta = DIM_SIGNAL_STEP*((ups - seen_ups) - (downs - seen_downs));
+    seen_downs = downs;
+    seen_ups = ups;
+    for(i = 0; i < 2; i++)
+        dim_set(&dims[i], dim_percent(&dims[i]) + delta, DIM_RAMP_FRAMES);
+}
+
+/* The requests, the live changes, the hotkeys and the reloads */
+static void poll_inputs(struct sender *snd)
+{
+    poll_check(snd);
+    poll_control(snd);
+    poll_live(snd);
+    poll_hotkeys(snd);
+    poll_reload(snd);
+}
+
+/* Takes a request from the control socket and starts its check, one at
+ * a time. The relative paths in it are the client's ones */
+static void poll_control(struct sender *snd)
+{
+    struct ctl_request *req = &snd->waiting;
+    int status;
+    if(snd->ctl < 0 || snd->check.pid >= 0 || !ctl_accept(snd->ctl, req))
+        return;
+    if(rebase_request(req)) {
+        ctl_reply(req, argerr, CTL_BADREQ_MSG);
+        ctl_free_request(req);
+        return;
+    }
+    halt_generator(snd); /* the child mustn't copy it amid a frame */
+    status = ctl_check_start(&snd->check, check_request,
+                             req->argc, req->argv);
+    resume_generator(snd);
+    if(status) {
+        ctl_reply(req, argerr, snd->check.msg);
+        ctl_free_request(req);
+    } else {
+        snd->reloading = 0;
+    }
+}
+
+/* Its paths made absolute: the daemon runs in /, and it keeps the request
+ * for the reloads. 0, or 1 if it gets too long */
+static int rebase_request(struct ctl_request *req)
+{
+    char paths[CTL_MAX_ARGS+1];
+    find_paths(req->argc, req->argv, paths);
+    return ctl_rebase(req, paths);
+}
+
+/* The frames go on while the child checks the waiting request, it's
+ * carried out on the frame the child is done */
+static void poll_check(struct sender *snd)
+{
+    struct ctl_request *req = &snd->waiting;
+    char msg[CTL_MAX_REPLY];
+    int status;
+    if(snd->check.pid < 0 || (status = ctl_check_poll(&snd->check)) < 0)
+        return;
+    halt_generator(snd);
+    if(snd->reloading) {
+        finish_reload(snd, status);
+    } else if(status) {
+        ctl_reply(req, argerr, snd->check.msg);
+    } else {
+        status = apply_request(snd, req, msg, sizeof(msg));
+        ctl_reply(req, status ? argerr : success, msg);
+    }
+    resume_generator(snd);
+    ctl_free_request(req);
+}
+
+/* The newest of the OSC and MIDI changes since the last frame, carried out
+ * as a request of the same options. They're made valid, no check needed */
+static void poll_live(struct sender *snd)
+{
+    struct live_args la;
+    struct ctl_request req;
+    char msg[CTL_MAX_REPLY];
+    int argc = live_poll(&la);
+    if(!argc || ctl_make_request(&req, argc, la.argv))
+        return;
+    halt_generator(snd);
+    if(apply_request(snd, &req, msg, sizeof(msg)))
+        syslog(LOG_ERR, "%s", msg);
+    resume_generator(snd);
+    ctl_free_request(&req);
+}
+
+/* The preset of the newest hotkey pressed is played as -P would do it.
+ * 1 if there was one */
+static int poll_hotkeys(struct sender *snd)
+{
+    struct ctl_request req;
+    char msg[CTL_MAX_REPLY];
+    const char *argv[3];
+    argv[0] = PROG_NAME;
+    argv[1] = "-P";
+    argv[2] = hotkey_poll();
+    if(!argv[2] || ctl_make_request(&req, 3, argv))
+        return 0;
+    halt_generator(snd);
+    if(apply_request(snd, &req, msg, sizeof(msg)))
+        syslog(LOG_ERR, "%s", msg);
+    resume_generator(snd);
+    ctl_free_request(&req);
+    return 1;
+}
+
+/* Exits as parse_arg does if the request can't be carried out.
+ * It's run in a child, so the exit only tells what's wrong */
+static void check_request(int argc, const char **argv)
+{
+    struct colschemes *cs;
+    struct scene *sc;
+    int verbose = 0, id;
+    cs = parse_opts(argc, argv, &verbose);
+    /* The options of the modes would change nothing without them */
+    if(cs->output || (cs->scene_opts && !has_scene(cs))) {
+        fprintf(stderr, CTL_BADREQ_MSG);
+        free(cs); exit(argerr);
+    }
+    if(cs->presets && preset_load(cs->presets, CACHE_KIB(cs))) {
+        free(cs); exit(argerr);
+    }
+    if(cs->image) {
+        sc = load_scene(cs->image);
+        if(!sc) {
+            free(cs); exit(argerr);
+        }
+        free_scene(sc);
+    } else if(cs->preset) { /* a kept scene is only rewound, it's cheap */
+        id = preset_find(cs->preset);
+        sc = id < 0 ? NULL : preset_take(id, 0);
+        if(!sc) {
+            free(cs); exit(argerr);
+        }
+        free_scene(sc);
+    } else if(has_scene(cs)) {
+        check_modes(cs);
+        if(check_colorscheme(cs)) {
+            free(cs); exit(NOSUPPORT_EXIT);
+        }
+    }
+    free(cs);
+}
+
+/* Only the given options change, a new scene fades in. The statistics of
+ * the presets and the pipeline are the reply to -v. 1 and the message if
+ * the scene can't be made, the old one plays on then */
+static int apply_request(struct sender *snd, struct ctl_request *req,
+                         char *msg, size_t len)
+{
+    struct colschemes *cs;
+    struct scene *sc;
+    int verbose = 0;
+    msg[0] = '\0';
+    cs = parse_opts(req->argc, req->argv, &verbose);
+    if(cs->upper_dim != NOT_GIVEN)
+        dim_set(&snd->dims[0], cs->upper_dim, DIM_RAMP_FRAMES);
+    if(cs->lower_dim != NOT_GIVEN)
+        dim_set(&snd->dims[1], cs->lower_dim, DIM_RAMP_FRAMES);
+    if(cs->fade != NOT_GIVEN)
+        snd->fade = FADE_FRAMES(cs->fade);
+    if(cs->rate != NOT_GIVEN)
+        player_set_rate(&snd->pl, RATE_FIXED(cs->rate));
+    if(cs->merge != NOT_GIVEN)
+        dec_set_merge(&snd->dc, cs->merge);
+    if(cs->presets)
+        load_presets(snd, cs);
+    if(has_scene(cs) && (snd->preset < 0 || preset_of(cs) != snd->preset)) {
+        sc = build_scene(cs, snd->key);
+        if(!sc) {
+            snprintf(msg, len, BUILD_ERR_MSG);
+            free(cs);
+            return 1;
+        }
+        switch_scene(snd, sc);
+        snd->preset = preset_of(cs);
+        snd->upper_mode = cs->image ? cs->image :
+                          cs->preset ? cs->preset : cs->upper.mode;
+        snd->lower_mode = cs->image ? cs->image :
+                          cs->preset ? cs->preset : cs->lower.mode;
+        ctl_free_request(&snd->scene);
+        snd->scene = *req; /* the modes point to its buf */
+        snd->scene.fd = -1; /* the reply is still to go */
+        req->buf = NULL;
+        watch_scene(snd, cs);
+    }
+    if(verbose) {
+        preset_stats(msg, len);
+        if(snd->pipe)
+            pipe_report(snd->pipe, msg + strlen(msg), len - strlen(msg));
+    }
+    free(cs);
+    return 0;
+}
+
+/* Checked, so it loads. The scenes are built at once, as at the start */
+static void load_presets(struct sender *snd, const struct colschemes *cs)
+{
+    if(preset_load(cs->presets, CACHE_KIB(cs)))
+        return;
+    snd->preset = -1; /* the same name might be another scene now */
+    preset_warm(snd->key);
+}
+
+/* The number of the preset the scene is, -1 if it isn't one */
+static int preset_of(const struct colschemes *cs)
+{
+    return cs->preset && !cs->image ? preset_find(cs->preset) : -1;
+}
+
+/* The scene of the last request is built again from its files, fading in
+ * as a requested one. It's checked as a request is, so a file that has
+ * become wrong leaves the playing scene as it is; a request being checked
+ * goes first */
+static void poll_reload(struct sender *snd)
+{
+    static sig_atomic_t seen_reloads = 0;
+    sig_atomic_t signals = SIG_LOAD(reloads);
+    struct ctl_request *req = &snd->waiting;
+    int status;
+    /* All the events are taken, so a reload answers any number of them */
+    if(watch_changed(&snd->wt) || signals != seen_reloads)
+        snd->reload_due = 1;
+    seen_reloads = signals;
+    if(!snd->reload_due || snd->check.pid >= 0 || !snd->scene.buf)
+        return;
+    snd->reload_due = 0;
+    if(ctl_make_request(req, snd->scene.argc, snd->scene.argv))
+        return;
+    halt_generator(snd);
+    status = ctl_check_start(&snd->check, check_request,
+                             req->argc, req->argv);
+    resume_generator(snd);
+    if(status) {
+        finish_reload(snd, 1);
+        ctl_free_request(req);
+        return;
+    }
+    snd->reloading = 1;
+}
+
+/* A scene requested during the check is newer, the reload is dropped */
+static void finish_reload(struct sender *snd, int status)
+{
+    struct colschemes *cs;
+    struct scene *sc;
+    int verbose = 0;
+    if(status) {
+        fprintf(stderr, RELOAD_ERR_MSG, snd->check.msg);
+        syslog(LOG_ERR, RELOAD_ERR_MSG, snd->check.msg);
+        return;
+    }
+    if(!same_args(&snd->waiting, &snd->scene))
+        return;
+    cs = parse_opts(snd->scene.argc, snd->scene.argv, &verbose);
+    if(cs->presets) /* the library is one of the files */
+        load_presets(snd, cs);
+    else
+        preset_flush();
+    sc = build_scene(cs, snd->key);
+    if(sc) { /* it's complete, the player only takes the pointer */
+        switch_scene(snd, sc);
+        snd->preset = preset_of(cs);
+    } else {
+        fprintf(stderr, RELOAD_BUILD_MSG);
+        syslog(LOG_ERR, RELOAD_BUILD_MSG);
+    }
+    watch_scene(snd, cs); /* a new file might be in another place */
+    free(cs);
+}
+
+static int same_args(const struct ctl_request *a,
+                     const struct ctl_request *b)
+{
+    int i;
+    if(!b->buf || a->argc != b->argc)
+        return 0;
+    for(i = 1; i < a->argc; i++) {
+        if(!strequ(a->argv[i], b->argv[i]))
+            return 0;
+    }
+    return 1;
+}
+
+/* NULL keeps the playing scene: a file might have gone since the check */
+static struct scene *build_scene(struct colschemes *cs, uint64_t key)
+{
+    int id;
+    if(cs->image)
+        return load_scene(cs->image);
+    if(cs->preset) {
+        id = preset_find(cs->preset);
+        return id < 0 ? NULL : preset_take(id, key);
+    }
+    return parse_colorscheme(cs, key);
+}
+
+/* The frames made ahead from the old scene aren't sent, the new one starts
+ * on the next frame. The generator must be stopped */
+static void switch_scene(struct sender *snd, struct scene *sc)
+{
+    player_switch(&snd->pl, sc, snd->fade);
+    if(!snd->pipe)
+        return;
+    pipe_drop(snd->pipe);
+    snd->dc.primed = 0; /* the last frame made hasn't been sent */
+}
+
+/* The library, the compiled scene or the keyframe files of every layer,
+ * absolute as the request has been rebased */
+static void watch_scene(struct sender *snd, const struct colschemes *cs)
+{
+    const struct colscheme *layers[2*MAX_LAYERS];
+    int i, cnt = 0;
+    watch_clear(&snd->wt);
+    if(cs->presets)
+        watch_file(&snd->wt, cs->presets);
+    if(cs->image) {
+        watch_file(&snd->wt, cs->image);
+        return;
+    }
+    layers[cnt++] = &cs->upper;
+    layers[cnt++] = &cs->lower;
+    for(i = 0; i < cs->upper_ovl_cnt; i++)
+        layers[cnt++] = &cs->upper_ovl[i];
+    for(i = 0; i < cs->lower_ovl_cnt; i++)
+        layers[cnt++] = &cs->lower_ovl[i];
+    for(i = 0; i < cnt; i++)
+        if(layers[i]->file && strequ(layers[i]->mode, "keyframes"))
+            watch_file(&snd->wt, layers[i]->file);
+}
+
 static short send_display_command(byte_t *packet, libusb_device_handle *handle)
 {
     short sent;
@@ -30,10 +30,52 @@
 #define DEVIO_SENTRY
 
 #include <libusb-1.0/libusb.h>
-#include "rgbmodes.h" /* for datpack & byte_t types, count_color_pairs, defs */
+#include "rgbmodes.h" /* for byte_t type, struct scene, pack_colpair, defs */
+#include "dimmer.h" /* for struct dimmer */
+#include "calibration.h" /* for struct calibration */
+#include "player.h" /* for struct player */
+#include "decimator.h" /* for struct decimator */
+#include "control.h" /* for the control socket */
+#include "watch.h" /* for struct watch */
+#include "preset.h" /* for preset_take */
+#include "pipeline.h" /* for struct pipeline */
+#include "live.h" /* for live_poll */
+#include "hotkey.h" /* for hotkey_poll */
+
+/* Constants */
+#define DIM_SIGNAL_STEP 10 /* percents, SIGUSR1 dims, SIGUSR2 brightens */
+#define SERIAL_LEN 128
+/* The playback options from the arguments */
+#define FADE_FRAMES(MS) (((MS) + FRAME_MS/2) / FRAME_MS)
+#define RATE_FIXED(PERCENT) \
+    ((unsigned int)((unsigned long)(PERCENT)*RATE_ONE/RATE_DEFAULT))
+
+/* Structs */
+struct dev_ident {
+    unsigned short vid, pid;
+    char serial[SERIAL_LEN]; /* empty if the microphone has none */
+};
+
+struct output_opts {
+    int upper_dim, lower_dim; /* the master brightness in percents */
+    unsigned int fade; /* frames of a crossfade to another scene */
+    unsigned int rate; /* of playing the scenes, RATE_ONE is the normal */
+    int merge; /* L* the frames may differ by to be merged, 0: send all */
+    unsigned int ahead; /* frames a thread of their own makes, 0: none */
+    const char *upper_mode, *lower_mode; /* for the statistics */
+    int argc; /* the arguments the scene is from, to build it again */
+    const char **argv;
+    struct calibration cal; /* the color correction of the microphone */
+};
 
 /* Functions */
-libusb_device_handle *open_micro(datpack *data_arr);
-void send_packets(libusb_device_handle *handle, const datpack *data_arr,
-                  int pck_cnt, int verbose);
+/* NULL if another program has locked the microphone */
+libusb_device_handle *open_micro(struct colschemes *cs);
+uint64_t dev_key(libusb_device_handle *handle); /* stable per microphone */
+int dev_ident(libusb_device_handle *handle, struct dev_ident *id); /* 0 ok */
+/* Plays sc and frees it at the end, the control requests change it.
+ * SIGHUP or a write to its files builds it again. With opt->ahead, the
+ * frames are made by another thread, the requests are taken by this one */
+void send_packets(libusb_device_handle *handle, struct scene *sc,
+                  const struct output_opts *opt, int verbose);
 #endif
@@ -0,0 +1,79 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File dimmer.c
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#include "dimmer.h"
+
+/* Functions */
+void dim_init(struct dimmer *dim, int percent)
+{
+    dim->level = dim->target = DIM_ONE; /* dim_set reads them */
+    dim_set(dim, percent, 0);
+}
+
+/* The ramp is linear and ends exactly at the target */
+void dim_set(struct dimmer *dim, int percent, unsigned int frames)
+{
+    int dist;
+    if(percent < 0)
+        percent = 0;
+    else if(percent > DIM_MAX)
+        percent = DIM_MAX;
+    dim->target = (int)((long)percent*DIM_ONE/DIM_MAX);
+    dist = dim->target - dim->level;
+    if(frames == 0 || dist == 0) {
+        dim->level = dim->target;
+        dim->step = 0;
+        return;
+    }
+    dim->step = dist/(int)frames;
+    if(dim->step == 0)
+        dim->step = dist > 0 ? 1 : -1;
+}
+
+int dim_percent(const struct dimmer *dim)
+{
+    return (int)(((long)dim->target*DIM_MAX + DIM_ONE/2) >> DIM_SHIFT);
+}
+
+int dim_tick(struct dimmer *dim)
+{
+    if(dim->step == 0)
+        return 0;
+    dim->level += dim->step;
+    if((dim->step > 0 && dim->level >= dim->target) ||
+       (dim->step < 0 && dim->level <= dim->target)) {
+        dim->level = dim->target;
+        dim->step = 0;
+    }
+    return 1;
+}
+
+int dim_color(const struct dimmer *dim, int color)
+{
+    int r, g, b;
+    if(dim->level == DIM_ONE) /* the usual case costs nothing */
+        return color;
+    r = (((color >> 16) & 0xff)*dim->level) >> DIM_SHIFT;
+    g = (((color >> 8) & 0xff)*dim->level) >> DIM_SHIFT;
+    b = ((color & 0xff)*dim->level) >> DIM_SHIFT;
+    return (r << 16) | (g << 8) | b;
+}
@@ -0,0 +1,49 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File dimmer.h
+ * The master brightness of a diode group, applied to the colors right
+ * before they are packed, so the scene itself never changes. A new level
+ * is reached by a ramp, a frame costs a multiplication per channel.
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#ifndef DIMMER_SENTRY
+#define DIMMER_SENTRY
+
+/* Constants */
+#define DIM_SHIFT 16
+#define DIM_ONE (1 << DIM_SHIFT) /* fixed point 1.0, the full brightness */
+#define DIM_MAX 100 /* in percents */
+#define DIM_RAMP_FRAMES 25 /* a change fades in half a second */
+
+/* Structs */
+struct dimmer {
+    int level; /* the current one, 0 through DIM_ONE */
+    int target; /* the level the ramp goes to */
+    int step; /* added to the level every frame, 0 if it's reached */
+};
+
+/* Functions */
+void dim_init(struct dimmer *dim, int percent); /* no ramp */
+void dim_set(struct dimmer *dim, int percent, unsigned int frames);
+int dim_percent(const struct dimmer *dim); /* of the target */
+int dim_tick(struct dimmer *dim); /* a frame of the ramp, 1 if it moved */
+int dim_color(const struct dimmer *dim, int color);
+
+#endif
@@ -0,0 +1,98 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File easing.c
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#include <string.h> /* for strcmp */
+
+#include "easing.h"
+
+/* The lookup tables (BE CAREFUL: GLOBAL VARIABLES) */
+static unsigned int luts[EASES_CNT][EASE_LUT_SIZE+1];
+static int luts_ready = 0;
+
+static const char *eases[EASES_CNT] = {
+    "linear", "hold", "ease-in", "ease-out", "ease-in-out", "smooth"
+};
+
+static void fill_luts(void);
+static double curve_value(int curve, double t);
+
+/* Functions */
+int find_ease(const char *name)
+{
+    int i;
+    for(i = 0; i < EASES_CNT; i++) {
+        if(0 == strcmp(eases[i], name))
+            return i;
+    }
+    return -1;
+}
+
+unsigned int ease_at(int curve, unsigned int off, unsigned int len)
+{
+    const unsigned int *lut;
+    uint64_t pos;
+    unsigned int i, frac;
+    if(!luts_ready)
+        fill_luts();
+    lut = luts[curve];
+    /* 8 more bits of the position pick a point between two samples */
+    pos = ((uint64_t)off << (EASE_LUT_BITS+8)) / len;
+    i = (unsigned int)(pos >> 8);
+    frac = (unsigned int)(pos & 0xff);
+    return lut[i] + (((lut[i+1] - lut[i]) * frac) >> 8);
+}
+
+static void fill_luts(void)
+{
+    int c, i;
+    for(c = 0; c < EASES_CNT; c++) {
+        for(i = 0; i <= EASE_LUT_SIZE; i++) {
+            double t = (double)i / EASE_LUT_SIZE;
+            luts[c][i] = (unsigned int)(curve_value(c, t)*EASE_ONE + 0.5);
+        }
+    }
+    luts_ready = 1;
+}
+
+/* All the curves go from 0 to 1 and never decrease */
+static double curve_value(int curve, double t)
+{
+    double u;
+    switch(curve) {
+    case ease_hold:
+        return t < 1.0 ? 0.0 : 1.0;
+    case ease_in: /* cubic */
+        return t*t*t;
+    case ease_out:
+        u = 1.0 - t;
+        return 1.0 - u*u*u;
+    case ease_in_out:
+        if(t < 0.5)
+            return 4.0*t*t*t;
+        u = 2.0 - 2.0*t;
+        return 1.0 - u*u*u/2.0;
+    case ease_smooth: /* smoothstep */
+        return t*t*(3.0 - 2.0*t);
+    default: /* ease_linear */
+        return t;
+    }
+}
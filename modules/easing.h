@@ -0,0 +1,46 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File easing.h
+ * Easing curves for the transitions between keyframes. Every curve is
+ * sampled once into a lookup table, a frame costs a table lookup and a
+ * linear interpolation between two neighbouring samples.
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#ifndef EASING_SENTRY
+#define EASING_SENTRY
+
+#include <stdint.h> /* for uint64_t */
+
+/* Constants */
+#define EASE_LUT_BITS 8
+#define EASE_LUT_SIZE (1 << EASE_LUT_BITS) /* the samples, the last excluded */
+#define EASE_ONE 65536 /* fixed point 1.0 of the eased progress */
+#define EASES_CNT 6
+
+enum ease_curve { /* the order of the eases array */
+    ease_linear, ease_hold, ease_in, ease_out, ease_in_out, ease_smooth
+};
+
+/* Functions */
+int find_ease(const char *name); /* enum ease_curve, -1 if unknown */
+/* The progress 0..EASE_ONE of the curve at the frame off of len frames */
+unsigned int ease_at(int curve, unsigned int off, unsigned int len);
+
+#endif
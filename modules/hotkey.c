@@ -0,0 +1,340 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File hotkey.c
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#include <stdio.h> /* for fopen, fgets, sscanf, fprintf, snprintf */
+#include <stdlib.h> /* for malloc, free */
+#include <string.h> /* for strchr, strncmp, strcpy, memset, strerror */
+#include <ctype.h> /* for tolower */
+#include <errno.h> /* for errno */
+#ifdef __linux__
+#include <unistd.h> /* for read, close */
+#include <fcntl.h> /* for open */
+#include <time.h> /* for clock_gettime */
+#include <dirent.h> /* for opendir, readdir */
+#include <limits.h> /* for NAME_MAX */
+#include <sys/stat.h> /* for fstat */
+#include <sys/ioctl.h> /* for ioctl */
+#include <sys/epoll.h> /* for epoll_create1, epoll_ctl, epoll_wait */
+#include <linux/input.h> /* for struct input_event, EVIOCGBIT */
+#endif
+
+#include "hotkey.h"
+#include "keynames.h" /* empty but on Linux */
+#include "argparser.h" /* for strequ */
+#include "preset.h" /* for preset_find */
+
+#ifdef __linux__
+static struct hotkeys *hk = NULL;
+
+static int read_hotkeys(FILE *f, const char *path);
+static int parse_combo(const char *str, struct hotkey *key);
+static int find_name(const struct key_name *names, const char *name);
+static void scan_keyboards(void);
+static void add_keyboard(const char *path);
+static int has_keys(int fd);
+static void read_keyboard(int fd);
+static void drop_keyboard(int fd);
+static void take_key(unsigned short code, int value);
+static long now_s(void);
+
+/* Functions */
+int hotkey_open(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    int err;
+    if(!f) {
+        fprintf(stderr, HOTKEY_OPEN_ERR_MSG, path, strerror(errno));
+        return 1;
+    }
+    hk = malloc(sizeof(*hk));
+    hk->cnt = hk->kbd_cnt = 0;
+    hk->held = 0;
+    hk->pressed = -1;
+    hk->ep = epoll_create1(EPOLL_CLOEXEC);
+    err = read_hotkeys(f, path);
+    fclose(f);
+    if(err || hk->ep < 0) {
+        hotkey_close();
+        return 1;
+    }
+    scan_keyboards();
+    if(hk->kbd_cnt == 0)
+        fprintf(stderr, HOTKEY_NODEV_MSG, HOTKEY_DIR, HOTKEY_RESCAN_S);
+    return 0;
+}
+
+void hotkey_close(void)
+{
+    int i;
+    if(!hk)
+        return;
+    for(i = 0; i < hk->kbd_cnt; i++)
+        close(hk->kbds[i].fd);
+    if(hk->ep >= 0)
+        close(hk->ep);
+    free(hk);
+    hk = NULL;
+}
+
+int hotkey_fd(void)
+{
+    return hk ? hk->ep : -1;
+}
+
+const char *hotkey_poll(void)
+{
+    struct epoll_event evs[HOTKEY_MAX_DEVS];
+    int i, cnt;
+    if(!hk)
+        return NULL;
+    if(now_s() - hk->scanned >= HOTKEY_RESCAN_S)
+        scan_keyboards();
+    cnt = epoll_wait(hk->ep, evs, HOTKEY_MAX_DEVS, 0);
+    for(i = 0; i < cnt; i++)
+        read_keyboard(evs[i].data.fd);
+    if(hk->pressed < 0)
+        return NULL;
+    i = hk->pressed;
+    hk->pressed = -1;
+    return hk->keys[i].preset;
+}
+
+static int read_hotkeys(FILE *f, const char *path)
+{
+    char line[HOTKEY_LINE_LEN], combo[HOTKEY_LINE_LEN];
+    char preset[HOTKEY_LINE_LEN], *comment;
+    struct hotkey *key;
+    int num, cnt;
+    for(num = 1; fgets(line, sizeof(line), f); num++) {
+        comment = strchr(line, '#');
+        if(comment)
+            *comment = '\0';
+        cnt = sscanf(line, "%s %s", combo, preset); /* they fit, as a line */
+        if(cnt <= 0)
+            continue;
+        if(cnt != 2 || strlen(preset) >= HOTKEY_NAME_LEN) {
+            fprintf(stderr, HOTKEY_LINE_ERR_MSG, path, num);
+            return 1;
+        }
+        if(hk->cnt == HOTKEY_MAX) {
+            fprintf(stderr, HOTKEY_MAX_ERR_MSG, path, HOTKEY_MAX);
+            return 1;
+        }
+        key = &hk->keys[hk->cnt];
+        if(parse_combo(combo, key)) {
+            fprintf(stderr, HOTKEY_KEY_ERR_MSG, path, num, combo);
+            return 1;
+        }
+        if(preset_find(preset) < 0) /* it tells why */
+            return 1;
+        strcpy(key->preset, preset);
+        hk->cnt++;
+    }
+    return 0;
+}
+
+/* The case doesn't matter, the key goes last */
+static int parse_combo(const char *str, struct hotkey *key)
+{
+    char name[HOTKEY_LINE_LEN];
+    int len, i;
+    key->mods = 0;
+    for(;;) {
+        for(len = 0; str[len] && str[len] != '+'; len++)
+            name[len] = tolower((unsigned char)str[len]);
+        name[len] = '\0';
+        if(!str[len])
+            break;
+        i = find_name(key_mods, name);
+        if(i < 0)
+            return 1;
+        key->mods |= key_mods[i].code;
+        str += len+1;
+    }
+    i = find_name(key_names, name);
+    if(i < 0)
+        return 1;
+    key->code = key_names[i].code;
+    return 0;
+}
+
+static int find_name(const struct key_name *names, const char *name)
+{
+    int i;
+    for(i = 0; names[i].name; i++)
+        if(strequ(names[i].name, name))
+            return i;
+    return -1;
+}
+
+static void scan_keyboards(void)
+{
+    char path[sizeof(HOTKEY_DIR) + NAME_MAX + 1];
+    struct dirent *ent;
+    DIR *dir = opendir(HOTKEY_DIR);
+    hk->scanned = now_s();
+    if(!dir)
+        return;
+    while(hk->kbd_cnt < HOTKEY_MAX_DEVS && (ent = readdir(dir))) {
+        if(strncmp(ent->d_name, "event", 5))
+            continue;
+        snprintf(path, sizeof(path), "%s/%s", HOTKEY_DIR, ent->d_name);
+        add_keyboard(path);
+    }
+    closedir(dir);
+}
+
+/* Only the devices with a key of the combinations are kept */
+static void add_keyboard(const char *path)
+{
+    struct keyboard *kb = &hk->kbds[hk->kbd_cnt];
+    struct epoll_event ev;
+    struct stat st;
+    int fd, i;
+    fd = open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if(fd < 0)
+        return;
+    if(fstat(fd, &st) || !has_keys(fd)) {
+        close(fd);
+        return;
+    }
+    for(i = 0; i < hk->kbd_cnt; i++) {
+        if(hk->kbds[i].dev == st.st_dev && hk->kbds[i].ino == st.st_ino) {
+            close(fd);
+            return;
+        }
+    }
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if(epoll_ctl(hk->ep, EPOLL_CTL_ADD, fd, &ev)) {
+        close(fd);
+        return;
+    }
+    kb->fd = fd;
+    kb->dev = st.st_dev;
+    kb->ino = st.st_ino;
+    hk->kbd_cnt++;
+}
+
+static int has_keys(int fd)
+{
+    unsigned char bits[KEY_MAX/8 + 1];
+    int i, code;
+    memset(bits, 0, sizeof(bits));
+    if(ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(bits)), bits) < 0)
+        return 0;
+    for(i = 0; i < hk->cnt; i++) {
+        code = hk->keys[i].code;
+        if(bits[code/8] & (1 << code%8))
+            return 1;
+    }
+    return 0;
+}
+
+/* Everything it has, a keyboard unplugged is closed */
+static void read_keyboard(int fd)
+{
+    struct input_event evs[HOTKEY_READ_EVENTS];
+    ssize_t len;
+    int i, cnt;
+    do {
+        len = read(fd, evs, sizeof(evs));
+        if(len == 0 || (len < 0 && errno != EAGAIN && errno != EINTR)) {
+            drop_keyboard(fd);
+            return;
+        }
+        cnt = len < 0 ? 0 : len / sizeof(evs[0]);
+        for(i = 0; i < cnt; i++) {
+            if(evs[i].type == EV_KEY)
+                take_key(evs[i].code, evs[i].value);
+            else if(evs[i].type == EV_SYN && evs[i].code == SYN_DROPPED)
+                hk->held = 0; /* the releases might be lost */
+        }
+    } while(cnt == HOTKEY_READ_EVENTS);
+}
+
+/* Closing removes it from the epoll */
+static void drop_keyboard(int fd)
+{
+    int i;
+    for(i = 0; i < hk->kbd_cnt && hk->kbds[i].fd != fd; i++)
+        ;
+    if(i == hk->kbd_cnt)
+        return;
+    close(fd);
+    hk->kbds[i] = hk->kbds[--hk->kbd_cnt];
+    hk->held = 0;
+}
+
+/* A press is 1, a release 0 and a repeat 2; only presses switch */
+static void take_key(unsigned short code, int value)
+{
+    int i, mods = 0;
+    for(i = 0; mod_keys[i].code; i++) {
+        if(mod_keys[i].code != code)
+            continue;
+        if(value)
+            hk->held |= 1U << i;
+        else
+            hk->held &= ~(1U << i);
+        return;
+    }
+    if(value != 1)
+        return;
+    for(i = 0; mod_keys[i].code; i++)
+        if(hk->held & 1U << i)
+            mods |= mod_keys[i].mod;
+    for(i = 0; i < hk->cnt; i++) {
+        if(hk->keys[i].code == code && hk->keys[i].mods == mods) {
+            hk->pressed = i;
+            return;
+        }
+    }
+}
+
+static long now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long)ts.tv_sec;
+}
+#else
+int hotkey_open(const char *path)
+{
+    fprintf(stderr, HOTKEY_NOEVDEV_ERR_MSG);
+    return 1;
+}
+
+void hotkey_close(void)
+{
+}
+
+int hotkey_fd(void)
+{
+    return -1;
+}
+
+const char *hotkey_poll(void)
+{
+    return NULL;
+}
+#endif
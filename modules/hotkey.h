@@ -0,0 +1,91 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File hotkey.h
+ * Global hotkeys switching the presets. The keyboards (/dev/input/event*)
+ * are read directly, so it works without a desktop and nothing waits for
+ * one; reading them needs root or the input group. Linux only.
+ * A line of the file is a combination, the modifiers and a key joined by
+ * '+' ("ctrl+alt+f1"), then the name or the number of a preset; # starts a
+ * comment. The keyboards are looked for again every few seconds, one
+ * plugged in later works as well.
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#ifndef HOTKEY_SENTRY
+#define HOTKEY_SENTRY
+
+#include <sys/types.h> /* for dev_t, ino_t */
+#include "locale_macros.h"
+
+/* Constants */
+#ifndef HOTKEY_DIR /* may be another one for tests */
+#define HOTKEY_DIR "/dev/input"
+#endif
+#define HOTKEY_MAX 32 /* combinations */
+#define HOTKEY_MAX_DEVS 16 /* keyboards */
+#define HOTKEY_NAME_LEN 64 /* of a preset, NUL included */
+#define HOTKEY_LINE_LEN 256
+#define HOTKEY_READ_EVENTS 64 /* per read */
+#define HOTKEY_RESCAN_S 2
+
+/* Messages */
+#define HOTKEY_OPEN_ERR_MSG _("Couldn't read the hotkeys: %s: %s\n")
+#define HOTKEY_LINE_ERR_MSG _("%s:%d: expected a key combination and " \
+                              "a preset\n")
+#define HOTKEY_KEY_ERR_MSG _("%s:%d: unknown key combination %s\n")
+#define HOTKEY_MAX_ERR_MSG _("%s: too many hotkeys, the limit is %d\n")
+#define HOTKEY_NODEV_MSG _("No keyboard with the hotkeys can be read in %s " \
+                           "yet, they're looked for every %d seconds.\n")
+#define HOTKEY_NOEVDEV_ERR_MSG _("--hotkeys: the keyboards can only be read " \
+                                 "on Linux\n")
+
+/* Structs */
+struct hotkey {
+    int mods; /* enum key_mod, exactly these are held */
+    unsigned short code; /* KEY_* */
+    char preset[HOTKEY_NAME_LEN];
+};
+
+struct keyboard {
+    int fd;
+    dev_t dev; /* with ino, it isn't opened twice */
+    ino_t ino;
+};
+
+struct hotkeys {
+    struct hotkey keys[HOTKEY_MAX];
+    int cnt;
+    struct keyboard kbds[HOTKEY_MAX_DEVS];
+    int kbd_cnt;
+    int ep; /* the epoll of the keyboards */
+    unsigned int held; /* the modifier keys down, the bits of mod_keys */
+    long scanned; /* the second of the last look for keyboards */
+    int pressed; /* the newest combination since the poll, -1 if none */
+};
+
+/* Functions */
+/* The presets must be loaded, every one is checked. 0 or message */
+int hotkey_open(const char *path);
+void hotkey_close(void);
+int hotkey_fd(void); /* readable when a key has come, -1 if none */
+/* The preset of the newest combination pressed since the last call, NULL
+ * if there's none */
+const char *hotkey_poll(void);
+
+#endif
@@ -0,0 +1,249 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File image.c
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#include <stdio.h> /* for fdopen, fwrite, fprintf, rename */
+#include <stdlib.h> /* for malloc, free, mkstemp */
+#include <string.h> /* for memcmp, memcpy, strcpy, strcat, strerror */
+#include <errno.h> /* for errno */
+#include <fcntl.h> /* for open */
+#include <unistd.h> /* for close, unlink */
+#include <sys/mman.h> /* for mmap, munmap */
+#include <sys/stat.h> /* for fstat, fchmod, umask */
+
+#include "image.h"
+#include "rgbmodes.h" /* for pack_colpair, struct scene, FRAME_MS */
+
+/* Header fields */
+enum {
+    hdr_version = 4, hdr_size = 8, hdr_period = 12, hdr_frames = 16,
+    hdr_loop_frame = 20, hdr_loop_run = 24, hdr_upper_len = 28,
+    hdr_lower_len = 32, hdr_runs = 36
+};
+
+static FILE *open_temp(const char *path, char **tmp);
+static int write_runs(struct scene *sc, FILE *f, uint32_t *cnt);
+static void put_le32(unsigned char *mem, uint32_t num);
+static uint32_t get_le32(const unsigned char *mem);
+
+/* Functions */
+/* The scene goes to a new file renamed over the old one at the end, so a
+ * program playing the old one keeps its mapping whole */
+int write_image(struct scene *sc, const char *path)
+{
+    unsigned char hdr[IMG_HEADER_SIZE];
+    uint32_t cnt = 0;
+    char *tmp;
+    FILE *f;
+    int err;
+
+    if(sc->len == SEQ_ENDLESS) {
+        fprintf(stderr, IMG_ENDLESS_ERR_MSG);
+        return 1;
+    }
+    f = open_temp(path, &tmp);
+    if(!f) {
+        fprintf(stderr, IMG_WRITE_ERR_MSG, path, strerror(errno));
+        return 1;
+    }
+    memset(hdr, 0, sizeof(hdr));
+    /* The runs go first, the header is written over the gap then */
+    err = fwrite(hdr, sizeof(hdr), 1, f) != 1 || write_runs(sc, f, &cnt);
+    memcpy(hdr, IMG_MAGIC, 4);
+    put_le32(hdr+hdr_version, IMG_VERSION);
+    put_le32(hdr+hdr_size, IMG_HEADER_SIZE);
+    put_le32(hdr+hdr_period, FRAME_MS);
+    put_le32(hdr+hdr_frames, sc->len);
+    put_le32(hdr+hdr_loop_frame, 0);
+    put_le32(hdr+hdr_loop_run, 0);
+    put_le32(hdr+hdr_upper_len, sc->upper.len);
+    put_le32(hdr+hdr_lower_len, sc->lower.len);
+    put_le32(hdr+hdr_runs, cnt);
+    err = err || fseek(f, 0, SEEK_SET) || fwrite(hdr, sizeof(hdr), 1, f) != 1;
+    err = fclose(f) || err;
+    err = err || rename(tmp, path);
+    if(err) {
+        fprintf(stderr, IMG_WRITE_ERR_MSG, path, strerror(errno));
+        unlink(tmp);
+    }
+    free(tmp);
+    return err;
+}
+
+/* PATH.XXXXXX in the same directory, a rename can't cross file systems.
+ * It gets the mode a new file would have */
+static FILE *open_temp(const char *path, char **tmp)
+{
+    mode_t mask = umask(0);
+    FILE *f;
+    int fd;
+    umask(mask);
+    *tmp = malloc(strlen(path) + sizeof(IMG_TEMP_SUFFIX));
+    strcpy(*tmp, path);
+    strcat(*tmp, IMG_TEMP_SUFFIX);
+    fd = mkstemp(*tmp);
+    if(fd < 0) {
+        free(*tmp);
+        return NULL;
+    }
+    f = fdopen(fd, "wb");
+    if(!f || fchmod(fd, 0666 & ~mask)) {
+        if(f)
+            fclose(f);
+        else
+            close(fd);
+        unlink(*tmp);
+        free(*tmp);
+        return NULL;
+    }
+    return f;
+}
+
+/* The frames of one loop, the equal neighbours are merged into a run */
+static int write_runs(struct scene *sc, FILE *f, uint32_t *cnt)
+{
+    unsigned char run[IMG_RUN_SIZE], cmd[IMG_CMD_SIZE];
+    unsigned int frame = 0, hold = 0;
+    int upper_col, lower_col;
+
+    *cnt = 0;
+    while(frame < sc->len) {
+        unsigned int h = scene_next(sc, &upper_col, &lower_col);
+        pack_colpair(upper_col, lower_col, cmd);
+        if(hold && memcmp(cmd, run+4, IMG_CMD_SIZE) == 0) {
+            hold += h;
+        } else {
+            if(hold) {
+                put_le32(run, hold);
+                if(fwrite(run, sizeof(run), 1, f) != 1)
+                    return 1;
+                (*cnt)++;
+            }
+            memcpy(run+4, cmd, IMG_CMD_SIZE);
+            hold = h;
+        }
+        frame += h;
+    }
+    put_le32(run, hold);
+    if(fwrite(run, sizeof(run), 1, f) != 1)
+        return 1;
+    (*cnt)++;
+    return 0;
+}
+
+int map_image(const char *path, struct image *img)
+{
+    struct stat st;
+    const unsigned char *hdr;
+    uint32_t data_off;
+    int fd;
+
+    fd = open(path, O_RDONLY);
+    if(fd < 0 || fstat(fd, &st)) {
+        fprintf(stderr, IMG_OPEN_ERR_MSG, path, strerror(errno));
+        if(fd >= 0)
+            close(fd);
+        return 1;
+    }
+    img->size = (size_t)st.st_size;
+    if(img->size < IMG_HEADER_SIZE) {
+        fprintf(stderr, IMG_BAD_ERR_MSG, path);
+        close(fd);
+        return 1;
+    }
+    img->map = mmap(NULL, img->size, PROT_READ, MAP_SHARED, fd, 0);
+    if(img->map == MAP_FAILED) {
+        fprintf(stderr, IMG_OPEN_ERR_MSG, path, strerror(errno));
+        img->map = NULL;
+        close(fd);
+        return 1;
+    }
+    img->fd = fd;
+    hdr = img->map;
+    data_off = get_le32(hdr+hdr_size);
+    img->cnt = get_le32(hdr+hdr_runs);
+    img->frames = get_le32(hdr+hdr_frames);
+    img->loop_run = get_le32(hdr+hdr_loop_run);
+    img->run = 0;
+    if(memcmp(hdr, IMG_MAGIC, 4) != 0 || data_off < IMG_HEADER_SIZE ||
+       data_off > img->size || img->cnt == 0 || img->loop_run >= img->cnt ||
+       (img->size - data_off) / IMG_RUN_SIZE < img->cnt) {
+        fprintf(stderr, IMG_BAD_ERR_MSG, path);
+        unmap_image(img);
+        return 1;
+    }
+    if(get_le32(hdr+hdr_version) != IMG_VERSION) {
+        fprintf(stderr, IMG_VERSION_ERR_MSG, path,
+                get_le32(hdr+hdr_version), IMG_VERSION);
+        unmap_image(img);
+        return 1;
+    }
+    if(get_le32(hdr+hdr_period) != FRAME_MS) {
+        fprintf(stderr, IMG_PERIOD_ERR_MSG, path,
+                get_le32(hdr+hdr_period), FRAME_MS);
+        unmap_image(img);
+        return 1;
+    }
+    img->runs = img->map + data_off;
+    return 0;
+}
+
+void unmap_image(struct image *img)
+{
+    if(img->map) {
+        munmap(img->map, img->size);
+        close(img->fd);
+    }
+    img->map = NULL;
+}
+
+/* A file cut short under the mapping would kill the program on reading
+ * it, so its size is checked first; it plays black until it's reloaded */
+unsigned int image_next(struct image *img, int *upper_col, int *lower_col)
+{
+    const unsigned char *run = img->runs + (size_t)img->run*IMG_RUN_SIZE;
+    const unsigned char *cmd = run+4;
+    unsigned int hold;
+    struct stat st;
+    if(fstat(img->fd, &st) || (size_t)st.st_size < img->size) {
+        *upper_col = *lower_col = 0;
+        return 1;
+    }
+    hold = get_le32(run);
+    *upper_col = (cmd[1] << 16) | (cmd[2] << 8) | cmd[3];
+    *lower_col = (cmd[5] << 16) | (cmd[6] << 8) | cmd[7];
+    img->run = (img->run+1 == img->cnt) ? img->loop_run : img->run+1;
+    return hold ? hold : 1; /* a damaged run mustn't stall the stream */
+}
+
+static void put_le32(unsigned char *mem, uint32_t num)
+{
+    mem[0] = num & 0xff;
+    mem[1] = (num >> 8) & 0xff;
+    mem[2] = (num >> 16) & 0xff;
+    mem[3] = (num >> 24) & 0xff;
+}
+
+static uint32_t get_le32(const unsigned char *mem)
+{
+    return (uint32_t)mem[0] | ((uint32_t)mem[1] << 8) |
+           ((uint32_t)mem[2] << 16) | ((uint32_t)mem[3] << 24);
+}
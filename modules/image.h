@@ -0,0 +1,80 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File image.h
+ * Compiled scenes: one loop of the packed commands stored in a file,
+ * 'quadcastrgb compile ... -o FILE' writes it and '-f FILE' plays it.
+ * The file is mapped to memory and streamed as it is: nothing is parsed
+ * or generated, the pages are shared through the page cache.
+ *
+ * The layout, all the numbers are 32-bit little-endian:
+ *     "QRGB", version, header size, frame period in ms, frames in the loop,
+ *     the frame & the run the loop restarts from, upper & lower group
+ *     lengths, the number of runs; then the runs: how many frames a command
+ *     holds and the 8 bytes of the command (0x81 R G B 0x81 R G B).
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#ifndef IMAGE_SENTRY
+#define IMAGE_SENTRY
+
+#include <stddef.h> /* for size_t */
+#include <stdint.h> /* for uint32_t */
+#include "locale_macros.h"
+
+/* Constants */
+#define IMG_MAGIC "QRGB"
+#define IMG_VERSION 1
+#define IMG_HEADER_SIZE 40
+#define IMG_CMD_SIZE 8 /* what pack_colpair writes */
+#define IMG_RUN_SIZE (4 + IMG_CMD_SIZE)
+#define IMG_TEMP_SUFFIX ".XXXXXX" /* of the file written before the rename */
+
+/* Messages */
+#define IMG_OPEN_ERR_MSG _("Couldn't open the compiled scene: %s: %s\n")
+#define IMG_WRITE_ERR_MSG _("Couldn't write the compiled scene: %s: %s\n")
+#define IMG_BAD_ERR_MSG _("%s: not a compiled scene or it's damaged\n")
+#define IMG_VERSION_ERR_MSG _("%s: compiled scene version %u, expected %u\n")
+#define IMG_PERIOD_ERR_MSG _("%s: compiled for %u ms frames, expected %u\n")
+#define IMG_ENDLESS_ERR_MSG _("An endless scene (random colors, audio, groups "\
+                              "whose loops line up too rarely) can't be "\
+                              "compiled, the loop must have an end\n")
+
+/* Structs */
+struct scene;
+
+struct image {
+    unsigned char *map; /* the whole file */
+    size_t size;
+    int fd; /* kept to see the file isn't cut under the mapping */
+    const unsigned char *runs;
+    uint32_t cnt; /* of runs */
+    uint32_t frames; /* of one loop */
+    uint32_t loop_run; /* the run to restart from */
+    uint32_t run; /* the one to be played next */
+};
+
+/* Functions */
+/* Both return 0 on success, message on failure */
+int write_image(struct scene *sc, const char *path); /* plays sc through */
+int map_image(const char *path, struct image *img);
+void unmap_image(struct image *img);
+/* Like scene_next: the colors, for how many frames they hold */
+unsigned int image_next(struct image *img, int *upper_col, int *lower_col);
+
+#endif
@@ -0,0 +1,231 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File ingress.c
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#include <stdio.h> /* for fprintf, snprintf */
+#include <stdlib.h> /* for malloc, free */
+#include <string.h> /* for strcmp, strerror */
+#include <errno.h> /* for errno */
+#include <unistd.h> /* for ftruncate, close */
+#include <fcntl.h> /* for O_RDWR, O_CREAT */
+#include <sys/mman.h> /* for shm_open, mmap */
+#include <sys/stat.h> /* for fstat */
+
+#include "ingress.h"
+
+/* Structs */
+struct ing_gen { /* a group's layer, a frame at a time */
+    struct seqgen gen;
+    int group;
+    struct ingress *rd; /* held */
+    unsigned long frame; /* the reader's frame it has seen */
+};
+
+/* The reader new generators read and the one it has replaced, still read
+ * by the playing scene (BE CAREFUL: GLOBAL VARIABLES) */
+static struct ingress *reader = NULL, *replaced = NULL;
+
+static void ing_next(struct seqgen *gen, struct sequence *seq);
+static void ing_free(struct seqgen *gen);
+static void release_reader(struct ingress *rd);
+static void free_reader(struct ingress *rd);
+static int sync_reader(struct ingress *rd, unsigned long *frame);
+static void take_latest(struct ingress *rd);
+static void take_queued(struct ingress *rd);
+static struct qrgb_shm *map_shm(const char *name);
+
+/* Functions */
+int ingress_open(const char *name)
+{
+    char path[ING_NAME_LEN];
+    struct ingress *rd;
+    /* Any name works, shm_open wants the one slash in front */
+    snprintf(path, sizeof(path), "%s%s", name[0] == '/' ? "" : "/", name);
+    if(reader && strcmp(reader->name, path) == 0)
+        return 0;
+    if(reader && reader->refs == 0) { /* opened for this scene already */
+        fprintf(stderr, ING_SOURCE_ERR_MSG, reader->name, path);
+        return 1;
+    }
+    rd = malloc(sizeof(*rd));
+    rd->shm = map_shm(path);
+    if(!rd->shm) {
+        free(rd);
+        return 1;
+    }
+    strcpy(rd->name, path);
+    rd->frame = 0;
+    rd->upper = rd->lower = black;
+    rd->refs = 0;
+    replaced = reader; /* the old one is left to its generators */
+    reader = rd;
+    return 0;
+}
+
+void ingress_close(void)
+{
+    struct ingress *rd = reader;
+    if(rd && rd->refs > 0)
+        return;
+    reader = replaced; /* a scene that isn't made gives it back */
+    replaced = NULL;
+    if(rd)
+        free_reader(rd);
+}
+
+/* ingress_open must have succeeded */
+void sequence_ingress(int group, struct sequence *seq)
+{
+    struct ing_gen *ig = malloc(sizeof(*ig));
+    ig->gen.next = ing_next;
+    ig->gen.free = ing_free;
+    ig->group = group;
+    ig->rd = reader;
+    reader->refs++;
+    ig->frame = ING_UNSTARTED;
+    seq_endless(seq, &ig->gen);
+}
+
+/* Called right before the frame is sent */
+static void ing_next(struct seqgen *gen, struct sequence *seq)
+{
+    struct ing_gen *ig = (struct ing_gen *)gen;
+    if(!sync_reader(ig->rd, &ig->frame)) {
+        seq_run(seq, black, 1);
+        return;
+    }
+    seq_run(seq, ig->group == lower ? ig->rd->lower : ig->rd->upper, 1);
+}
+
+static void ing_free(struct seqgen *gen)
+{
+    struct ing_gen *ig = (struct ing_gen *)gen;
+    release_reader(ig->rd);
+    free(ig);
+}
+
+/* The memory is unmapped when no scene plays it any more */
+static void release_reader(struct ingress *rd)
+{
+    if(--rd->refs > 0)
+        return;
+    if(rd == reader)
+        reader = NULL;
+    if(rd == replaced)
+        replaced = NULL;
+    free_reader(rd);
+}
+
+static void free_reader(struct ingress *rd)
+{
+    munmap(rd->shm, sizeof(*rd->shm));
+    free(rd);
+}
+
+/* The first generator called in a frame takes it, the others see the
+ * same; the call made with the sequence, before the frames, doesn't */
+static int sync_reader(struct ingress *rd, unsigned long *frame)
+{
+    struct qrgb_shm *shm = rd->shm;
+    if(*frame == ING_UNSTARTED) {
+        *frame = rd->frame;
+        return 0;
+    }
+    if(*frame == rd->frame) {
+        /* A producer starting anew hides the header for a while */
+        if(QRGB_SHM_ACQUIRE(&shm->magic) != QRGB_SHM_MAGIC ||
+           shm->version != QRGB_SHM_VERSION || shm->slots != QRGB_SHM_SLOTS)
+            rd->upper = rd->lower = black;
+        else if(shm->mode == qrgb_shm_queued)
+            take_queued(rd);
+        else
+            take_latest(rd);
+        rd->frame++;
+    }
+    *frame = rd->frame;
+    return 1;
+}
+
+/* A torn frame is read again; if the producer is stuck in the middle of
+ * one, the previous colors stay */
+static void take_latest(struct ingress *rd)
+{
+    struct qrgb_shm *shm = rd->shm;
+    uint32_t before, after, upper, lower;
+    int i;
+    for(i = 0; i < ING_SEQ_TRIES; i++) {
+        before = QRGB_SHM_ACQUIRE(&shm->seq);
+        if(before & 1)
+            continue;
+        upper = QRGB_SHM_READ(&shm->latest.upper);
+        lower = QRGB_SHM_READ(&shm->latest.lower);
+        QRGB_SHM_FENCE_ACQUIRE();
+        after = QRGB_SHM_READ(&shm->seq);
+        if(before == after) {
+            rd->upper = upper & 0xffffff;
+            rd->lower = lower & 0xffffff;
+            return;
+        }
+    }
+}
+
+/* An empty ring holds the colors, the producer is late */
+static void take_queued(struct ingress *rd)
+{
+    struct qrgb_shm *shm = rd->shm;
+    uint32_t head = QRGB_SHM_ACQUIRE(&shm->head), tail = shm->tail;
+    const struct qrgb_shm_frame *f;
+    if(head == tail)
+        return;
+    if(head - tail > QRGB_SHM_SLOTS) /* nonsense, start from the newest */
+        tail = head - 1;
+    f = &shm->ring[tail % QRGB_SHM_SLOTS];
+    rd->upper = QRGB_SHM_READ(&f->upper) & 0xffffff;
+    rd->lower = QRGB_SHM_READ(&f->lower) & 0xffffff;
+    QRGB_SHM_RELEASE(&shm->tail, tail + 1); /* the slot is free again */
+}
+
+/* Made if the producer hasn't started yet, the zeros say it's not ready */
+static struct qrgb_shm *map_shm(const char *name)
+{
+    struct stat st;
+    void *map;
+    int fd;
+    fd = shm_open(name, O_RDWR | O_CREAT, 0600);
+    if(fd < 0) {
+        fprintf(stderr, ING_OPEN_ERR_MSG, name, strerror(errno));
+        return NULL;
+    }
+    if(fstat(fd, &st) || ((size_t)st.st_size < sizeof(struct qrgb_shm) &&
+                          ftruncate(fd, sizeof(struct qrgb_shm)))) {
+        fprintf(stderr, ING_OPEN_ERR_MSG, name, strerror(errno));
+        close(fd);
+        return NULL;
+    }
+    map = mmap(NULL, sizeof(struct qrgb_shm), PROT_READ | PROT_WRITE,
+               MAP_SHARED, fd, 0);
+    close(fd); /* the mapping stays */
+    if(map == MAP_FAILED) {
+        fprintf(stderr, ING_OPEN_ERR_MSG, name, strerror(errno));
+        return NULL;
+    }
+    return map;
+}
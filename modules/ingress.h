@@ -0,0 +1,60 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File ingress.h
+ * The shm mode: the frames come from another program through shared
+ * memory laid out as in qrgb_shm.h. One reader takes a frame right before
+ * every frame is sent and both diode groups see the same one; the upper
+ * gets its upper color, the lower ones the lower color.
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#ifndef INGRESS_SENTRY
+#define INGRESS_SENTRY
+
+#include "locale_macros.h"
+#include "argparser.h" /* for black, enum diode_group */
+#include "sequence.h" /* for struct sequence, struct seqgen */
+#include "qrgb_shm.h" /* for struct qrgb_shm */
+
+/* Constants */
+#define ING_NAME_LEN 256
+#define ING_SEQ_TRIES 8 /* reads of a frame being written, then it waits */
+#define ING_UNSTARTED ((unsigned long)-1) /* the frame of a new generator */
+
+/* Messages */
+#define ING_OPEN_ERR_MSG _("Couldn't open the shared memory %s: %s\n")
+#define ING_SOURCE_ERR_MSG _("One shared memory at a time: %s and %s\n")
+
+/* Structs */
+struct ingress {
+    char name[ING_NAME_LEN]; /* with the leading '/' */
+    struct qrgb_shm *shm;
+    unsigned long frame; /* the frames taken */
+    int upper, lower; /* the colors of the last one, kept if none comes */
+    int refs; /* the generators reading it */
+};
+
+/* Functions */
+/* 0 or message, again with the same. Another name replaces the memory in
+ * use, which is unmapped with the last generator reading it */
+int ingress_open(const char *name);
+void ingress_close(void); /* the one opened if unread, back to the old one */
+void sequence_ingress(int group, struct sequence *seq);
+
+#endif
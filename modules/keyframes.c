@@ -0,0 +1,160 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File keyframes.c
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#include <stdio.h> /* for fopen, fgets, fprintf */
+#include <stdlib.h> /* for realloc, free, strtoul, strtol */
+#include <string.h> /* for strchr, strerror, strtok */
+#include <errno.h> /* for errno */
+
+#include "keyframes.h"
+#include "argparser.h" /* for enum diode_group, strequ */
+#include "easing.h" /* for find_ease */
+#include "scene.h" /* for FRAME_MS */
+
+static int parse_line(char *line, const char *path, int lineno,
+                      struct keyframe *kf);
+static int parse_section(const char *line, const char *path, int lineno);
+static void add_keyframe(struct timeline *tl, const struct keyframe *kf);
+
+/* Functions */
+int load_timeline(const char *path, int group, struct timeline *tl)
+{
+    FILE *f;
+    char line[KF_LINE_LEN], *p;
+    int lineno = 0, section = all, err = 0;
+    struct keyframe kf;
+
+    tl->keys = NULL;
+    tl->cnt = tl->cap = 0;
+    f = fopen(path, "r");
+    if(!f) {
+        fprintf(stderr, KF_OPEN_ERR_MSG, path, strerror(errno));
+        return 1;
+    }
+    while(!err && fgets(line, sizeof(line), f)) {
+        lineno++;
+        if((p = strchr(line, '#')))
+            *p = '\0';
+        for(p = line; *p == ' ' || *p == '\t'; p++)
+            {}
+        if(*p == '\0' || *p == '\n' || *p == '\r')
+            continue;
+        if(*p == '[') {
+            section = parse_section(p, path, lineno);
+            err = section < 0;
+            continue;
+        }
+        err = parse_line(p, path, lineno, &kf);
+        if(err || (section != all && section != group))
+            continue;
+        if(tl->cnt && kf.frame < tl->keys[tl->cnt-1].frame) {
+            fprintf(stderr, KF_ORDER_ERR_MSG, path, lineno);
+            err = 1;
+            continue;
+        }
+        add_keyframe(tl, &kf);
+    }
+    fclose(f);
+    if(!err && tl->cnt == 0) {
+        fprintf(stderr, KF_EMPTY_ERR_MSG, path,
+                group == upper ? "upper" : "lower");
+        err = 1;
+    }
+    if(err)
+        free_timeline(tl);
+    return err;
+}
+
+void free_timeline(struct timeline *tl)
+{
+    free(tl->keys);
+    tl->keys = NULL;
+    tl->cnt = tl->cap = 0;
+}
+
+unsigned int timeline_length(const struct timeline *tl)
+{
+    unsigned int len;
+    if(tl->cnt == 0)
+        return 0;
+    len = tl->keys[tl->cnt-1].frame;
+    return len ? len : 1; /* a single moment is a still color */
+}
+
+/* "time color [easing]", the milliseconds are rounded to frames */
+static int parse_line(char *line, const char *path, int lineno,
+                      struct keyframe *kf)
+{
+    char *time_s, *col_s, *ease_s, *end;
+    unsigned long ms;
+
+    time_s = strtok(line, " \t\r\n");
+    col_s = strtok(NULL, " \t\r\n");
+    ease_s = strtok(NULL, " \t\r\n");
+    if(!time_s || !col_s || strtok(NULL, " \t\r\n")) {
+        fprintf(stderr, KF_SYNTAX_ERR_MSG, path, lineno);
+        return 1;
+    }
+    ms = strtoul(time_s, &end, 10);
+    if(*time_s == '-' || *end != '\0') {
+        fprintf(stderr, KF_SYNTAX_ERR_MSG, path, lineno);
+        return 1;
+    }
+    kf->frame = (unsigned int)((ms + FRAME_MS/2) / FRAME_MS);
+    kf->color = (int)strtol(col_s, &end, 16);
+    if(*col_s == '\0' || *end != '\0' || kf->color < 0 ||
+                                           kf->color > 0xffffff) {
+        fprintf(stderr, KF_SYNTAX_ERR_MSG, path, lineno);
+        return 1;
+    }
+    kf->ease = ease_s ? find_ease(ease_s) : ease_linear;
+    if(kf->ease < 0) {
+        fprintf(stderr, KF_EASE_ERR_MSG, path, lineno, ease_s);
+        return 1;
+    }
+    return 0;
+}
+
+/* Returns enum diode_group or -1 */
+static int parse_section(const char *line, const char *path, int lineno)
+{
+    char name[8];
+    if(sscanf(line, "[%7[a-z]]", name) == 1) {
+        if(strequ(name, "all"))
+            return all;
+        if(strequ(name, "upper"))
+            return upper;
+        if(strequ(name, "lower"))
+            return lower;
+    }
+    fprintf(stderr, KF_SECTION_ERR_MSG, path, lineno);
+    return -1;
+}
+
+static void add_keyframe(struct timeline *tl, const struct keyframe *kf)
+{
+    if(tl->cnt == tl->cap) {
+        tl->cap += KF_CHUNK;
+        tl->keys = realloc(tl->keys, tl->cap * sizeof(*tl->keys));
+    }
+    tl->keys[tl->cnt++] = *kf;
+}
@@ -0,0 +1,68 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File keyframes.h
+ * Reads keyframe timelines. A keyframe file has a line per keyframe:
+ *     time color [easing]
+ * time is in milliseconds from the start of the loop, color is hex without
+ * # and the easing is the curve of the transition to the next keyframe
+ * (linear by default). The last keyframe ends the loop. The lines after
+ * [upper] or [lower] are for that diode group only, the ones after [all]
+ * or before any section are for both. Everything after # is a comment.
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#ifndef KEYFRAMES_SENTRY
+#define KEYFRAMES_SENTRY
+
+#include "locale_macros.h"
+
+/* Constants */
+#define KF_LINE_LEN 256
+#define KF_CHUNK 16 /* keyframes are allocated by chunks */
+
+/* Messages */
+#define KF_OPEN_ERR_MSG _("Couldn't read the keyframes: %s: %s\n")
+#define KF_SYNTAX_ERR_MSG _("%s:%d: expected 'time color [easing]'\n")
+#define KF_EASE_ERR_MSG _("%s:%d: unknown easing %s, expected linear, hold, " \
+                          "ease-in, ease-out, ease-in-out or smooth\n")
+#define KF_ORDER_ERR_MSG _("%s:%d: the keyframes must go in time order\n")
+#define KF_SECTION_ERR_MSG _("%s:%d: unknown section, expected [all], " \
+                             "[upper] or [lower]\n")
+#define KF_EMPTY_ERR_MSG _("%s: no keyframes for the %s diode(s)\n")
+
+/* Structs */
+struct keyframe {
+    unsigned int frame; /* from the start of the loop */
+    int color;
+    int ease; /* enum ease_curve, the way to the next keyframe */
+};
+
+struct timeline {
+    struct keyframe *keys;
+    unsigned int cnt, cap;
+};
+
+/* Functions */
+/* Reads the keyframes of group (enum diode_group) into tl,
+ * 0 on success, message on failure */
+int load_timeline(const char *path, int group, struct timeline *tl);
+void free_timeline(struct timeline *tl);
+unsigned int timeline_length(const struct timeline *tl); /* in frames */
+
+#endif
@@ -0,0 +1,93 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File keynames.h
+ * The names of the keys and the modifiers of the hotkeys: the Linux input
+ * codes (KEY_*) in lower case, a few renamed. Shared with the producer
+ * that presses them on a virtual keyboard.
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#ifndef KEYNAMES_SENTRY
+#define KEYNAMES_SENTRY
+
+#ifdef __linux__
+#include <linux/input-event-codes.h> /* for KEY_* */
+
+/* Constants */
+enum key_mod { mod_ctrl = 1, mod_shift = 2, mod_alt = 4, mod_meta = 8 };
+
+/* Structs */
+struct key_name {
+    const char *name;
+    unsigned short code; /* KEY_*, the mask of a modifier */
+};
+
+struct mod_key {
+    unsigned short code; /* KEY_* */
+    int mod; /* enum key_mod */
+};
+
+static const struct key_name key_mods[] = {
+    {"ctrl", mod_ctrl}, {"shift", mod_shift}, {"alt", mod_alt},
+    {"meta", mod_meta}, {"super", mod_meta},
+    {NULL, 0}
+};
+
+/* The keys of the modifiers, the left one first */
+static const struct mod_key mod_keys[] = {
+    {KEY_LEFTCTRL, mod_ctrl}, {KEY_RIGHTCTRL, mod_ctrl},
+    {KEY_LEFTSHIFT, mod_shift}, {KEY_RIGHTSHIFT, mod_shift},
+    {KEY_LEFTALT, mod_alt}, {KEY_RIGHTALT, mod_alt},
+    {KEY_LEFTMETA, mod_meta}, {KEY_RIGHTMETA, mod_meta},
+    {0, 0}
+};
+
+static const struct key_name key_names[] = {
+    {"a", KEY_A}, {"b", KEY_B}, {"c", KEY_C}, {"d", KEY_D}, {"e", KEY_E},
+    {"f", KEY_F}, {"g", KEY_G}, {"h", KEY_H}, {"i", KEY_I}, {"j", KEY_J},
+    {"k", KEY_K}, {"l", KEY_L}, {"m", KEY_M}, {"n", KEY_N}, {"o", KEY_O},
+    {"p", KEY_P}, {"q", KEY_Q}, {"r", KEY_R}, {"s", KEY_S}, {"t", KEY_T},
+    {"u", KEY_U}, {"v", KEY_V}, {"w", KEY_W}, {"x", KEY_X}, {"y", KEY_Y},
+    {"z", KEY_Z}, {"0", KEY_0}, {"1", KEY_1}, {"2", KEY_2}, {"3", KEY_3},
+    {"4", KEY_4}, {"5", KEY_5}, {"6", KEY_6}, {"7", KEY_7}, {"8", KEY_8},
+    {"9", KEY_9}, {"f1", KEY_F1}, {"f2", KEY_F2}, {"f3", KEY_F3},
+    {"f4", KEY_F4}, {"f5", KEY_F5}, {"f6", KEY_F6}, {"f7", KEY_F7},
+    {"f8", KEY_F8}, {"f9", KEY_F9}, {"f10", KEY_F10}, {"f11", KEY_F11},
+    {"f12", KEY_F12}, {"f13", KEY_F13}, {"f14", KEY_F14}, {"f15", KEY_F15},
+    {"f16", KEY_F16}, {"f17", KEY_F17}, {"f18", KEY_F18}, {"f19", KEY_F19},
+    {"f20", KEY_F20}, {"f21", KEY_F21}, {"f22", KEY_F22}, {"f23", KEY_F23},
+    {"f24", KEY_F24}, {"kp0", KEY_KP0}, {"kp1", KEY_KP1}, {"kp2", KEY_KP2},
+    {"kp3", KEY_KP3}, {"kp4", KEY_KP4}, {"kp5", KEY_KP5}, {"kp6", KEY_KP6},
+    {"kp7", KEY_KP7}, {"kp8", KEY_KP8}, {"kp9", KEY_KP9}, {"esc", KEY_ESC},
+    {"tab", KEY_TAB}, {"space", KEY_SPACE}, {"enter", KEY_ENTER},
+    {"backspace", KEY_BACKSPACE}, {"insert", KEY_INSERT},
+    {"delete", KEY_DELETE}, {"home", KEY_HOME}, {"end", KEY_END},
+    {"pageup", KEY_PAGEUP}, {"pagedown", KEY_PAGEDOWN}, {"up", KEY_UP},
+    {"down", KEY_DOWN}, {"left", KEY_LEFT}, {"right", KEY_RIGHT},
+    {"pause", KEY_PAUSE}, {"scrolllock", KEY_SCROLLLOCK},
+    {"print", KEY_SYSRQ}, {"minus", KEY_MINUS}, {"equal", KEY_EQUAL},
+    {"mute", KEY_MUTE}, {"volumedown", KEY_VOLUMEDOWN},
+    {"volumeup", KEY_VOLUMEUP}, {"playpause", KEY_PLAYPAUSE},
+    {"nextsong", KEY_NEXTSONG}, {"previoussong", KEY_PREVIOUSSONG},
+    {"micmute", KEY_MICMUTE},
+    {NULL, 0}
+};
+#endif
+
+#endif
@@ -0,0 +1,502 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File live.c
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#include <stdio.h> /* for fprintf, snprintf */
+#include <stdlib.h> /* for malloc, free, strtoul */
+#include <string.h> /* for memcpy, memchr, strncmp, strcpy, strerror */
+#include <stdint.h> /* for uint32_t, int32_t */
+#include <errno.h> /* for errno */
+#include <unistd.h> /* for close */
+#include <fcntl.h> /* for fcntl */
+#include <sys/socket.h> /* for socket, bind, recv */
+#include <netinet/in.h> /* for struct sockaddr_in */
+#include <arpa/inet.h> /* for htonl, htons */
+
+#include "live.h"
+
+#ifdef WITH_ALSA
+#include <alsa/asoundlib.h>
+#endif
+
+/* Constants */
+#define PROG_NAME "quadcastrgb" /* argv[0] of the requests made */
+
+/* Structs */
+struct osc_arg {
+    char type; /* of the OSC type tag */
+    unsigned long u; /* the 32 bits of i, f and r */
+    const char *s; /* of s */
+};
+
+struct live_state {
+    int osc; /* the UDP socket, -1 if none */
+#ifdef WITH_ALSA
+    snd_seq_t *seq; /* NULL if none */
+#endif
+    /* The newest values since the last poll, NOT_GIVEN if none came */
+    int dim[2]; /* upper, lower */
+    int rate;
+    int color; /* nocolor if none came, the scene is a preset then */
+    char preset[LIVE_ARG_LEN]; /* "" if none came */
+    int midi_rgb; /* the color the MIDI controllers have made */
+};
+
+static struct live_state *live = NULL;
+
+static int open_osc(int port);
+static int open_midi(const char *src);
+static void read_osc(void);
+static void take_packet(const unsigned char *p, size_t len, int depth);
+static void take_message(const unsigned char *p, size_t len);
+static size_t osc_string(const unsigned char *p, size_t len);
+static void take_param(const char *addr, const struct osc_arg *args,
+                       int cnt);
+static int osc_percent(const struct osc_arg *arg, int min, int max);
+static int osc_color(const struct osc_arg *args, int cnt);
+static int osc_number(const struct osc_arg *arg, double *num);
+static int clamp(double num, int min, int max);
+static void set_color(int color);
+static void set_preset(const char *preset);
+static void add_arg(struct live_args *la, const char *fmt, const char *str,
+                    int num);
+static unsigned long get_u32(const unsigned char *p);
+#ifdef WITH_ALSA
+static void read_midi(void);
+static void take_event(const snd_seq_event_t *ev);
+#endif
+
+/* Functions */
+int live_open(int osc_port, const char *midi)
+{
+    if(osc_port <= 0 && !midi)
+        return 0;
+    live = malloc(sizeof(*live));
+    live->osc = -1;
+#ifdef WITH_ALSA
+    live->seq = NULL;
+#endif
+    live->dim[0] = live->dim[1] = live->rate = NOT_GIVEN;
+    live->color = nocolor;
+    live->preset[0] = '\0';
+    live->midi_rgb = black;
+    if((osc_port > 0 && open_osc(osc_port)) || (midi && open_midi(midi))) {
+        live_close();
+        return 1;
+    }
+    return 0;
+}
+
+void live_close(void)
+{
+    if(!live)
+        return;
+    if(live->osc >= 0)
+        close(live->osc);
+#ifdef WITH_ALSA
+    if(live->seq)
+        snd_seq_close(live->seq);
+#endif
+    free(live);
+    live = NULL;
+}
+
+/* The dimmers of both groups are one option if they're the same */
+int live_poll(struct live_args *la)
+{
+    if(!live)
+        return 0;
+    read_osc();
+#ifdef WITH_ALSA
+    read_midi();
+#endif
+    la->argc = 0;
+    add_arg(la, "%s", PROG_NAME, 0);
+    if(live->dim[0] != NOT_GIVEN && live->dim[0] == live->dim[1]) {
+        add_arg(la, "%s", "--dim", 0);
+        add_arg(la, "%d", NULL, live->dim[0]);
+    } else if(live->dim[0] != NOT_GIVEN || live->dim[1] != NOT_GIVEN) {
+        if(live->dim[0] != NOT_GIVEN) {
+            add_arg(la, "%s", "-u", 0);
+            add_arg(la, "%s", "--dim", 0);
+            add_arg(la, "%d", NULL, live->dim[0]);
+        }
+        if(live->dim[1] != NOT_GIVEN) {
+            add_arg(la, "%s", "-l", 0);
+            add_arg(la, "%s", "--dim", 0);
+            add_arg(la, "%d", NULL, live->dim[1]);
+        }
+        add_arg(la, "%s", "-a", 0); /* the scene is for both */
+    }
+    if(live->rate != NOT_GIVEN) {
+        add_arg(la, "%s", "--rate", 0);
+        add_arg(la, "%d", NULL, live->rate);
+    }
+    if(live->color != nocolor) {
+        add_arg(la, "%s", "solid", 0);
+        add_arg(la, "%06x", NULL, live->color);
+    } else if(live->preset[0]) {
+        add_arg(la, "%s", "-P", 0);
+        add_arg(la, "%s", live->preset, 0);
+    }
+    live->dim[0] = live->dim[1] = live->rate = NOT_GIVEN;
+    live->color = nocolor;
+    live->preset[0] = '\0';
+    return la->argc > 1 ? la->argc : 0;
+}
+
+static int open_osc(int port)
+{
+    struct sockaddr_in addr;
+    live->osc = socket(AF_INET, SOCK_DGRAM, 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((unsigned short)port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK); /* never the network */
+    if(live->osc < 0 ||
+       bind(live->osc, (struct sockaddr *)&addr, sizeof(addr)) ||
+       fcntl(live->osc, F_SETFL, fcntl(live->osc, F_GETFL) | O_NONBLOCK)) {
+        fprintf(stderr, LIVE_OSC_ERR_MSG, port, strerror(errno));
+        return 1;
+    }
+    return 0;
+}
+
+#ifdef WITH_ALSA
+static int open_midi(const char *src)
+{
+    snd_seq_addr_t addr;
+    int port, err;
+    err = snd_seq_open(&live->seq, "default", SND_SEQ_OPEN_INPUT,
+                       SND_SEQ_NONBLOCK);
+    if(err < 0) {
+        fprintf(stderr, LIVE_MIDI_ERR_MSG, "default", snd_strerror(err));
+        live->seq = NULL;
+        return 1;
+    }
+    snd_seq_set_client_name(live->seq, LIVE_MIDI_CLIENT);
+    port = snd_seq_create_simple_port(live->seq, LIVE_MIDI_PORT,
+                   SND_SEQ_PORT_CAP_WRITE | SND_SEQ_PORT_CAP_SUBS_WRITE,
+                   SND_SEQ_PORT_TYPE_MIDI_GENERIC |
+                   SND_SEQ_PORT_TYPE_APPLICATION);
+    if(port < 0) {
+        fprintf(stderr, LIVE_MIDI_ERR_MSG, LIVE_MIDI_PORT, snd_strerror(port));
+        return 1;
+    }
+    if(strequ(src, "-"))
+        return 0;
+    err = snd_seq_parse_address(live->seq, &addr, src);
+    if(err >= 0)
+        err = snd_seq_connect_from(live->seq, port, addr.client, addr.port);
+    if(err < 0) {
+        fprintf(stderr, LIVE_MIDI_ERR_MSG, src, snd_strerror(err));
+        return 1;
+    }
+    return 0;
+}
+#else
+static int open_midi(const char *src)
+{
+    fprintf(stderr, LIVE_NOALSA_ERR_MSG);
+    return 1;
+}
+#endif
+
+static void read_osc(void)
+{
+    unsigned char buf[LIVE_MAX_PACKET];
+    ssize_t len;
+    int i;
+    if(live->osc < 0)
+        return;
+    for(i = 0; i < LIVE_READ_CAP; i++) {
+        len = recv(live->osc, buf, sizeof(buf), 0);
+        if(len < 0)
+            return;
+        take_packet(buf, len, 0);
+    }
+}
+
+/* A message or a bundle of them; the time tags are ignored, all is now */
+static void take_packet(const unsigned char *p, size_t len, int depth)
+{
+    unsigned long size;
+    if(len < 16 || memcmp(p, "#bundle", 8)) {
+        take_message(p, len);
+        return;
+    }
+    if(depth == LIVE_MAX_NEST)
+        return;
+    p += 16; /* the tag and the time tag */
+    len -= 16;
+    while(len >= 4) {
+        size = get_u32(p);
+        if(size > len - 4 || size % 4)
+            return;
+        take_packet(p + 4, size, depth + 1);
+        p += 4 + size;
+        len -= 4 + size;
+    }
+}
+
+/* An address, the type tags and the arguments, 4-byte aligned */
+static void take_message(const unsigned char *p, size_t len)
+{
+    struct osc_arg args[LIVE_OSC_ARGS];
+    const char *addr = (const char *)p, *tags;
+    size_t n;
+    int cnt;
+    n = osc_string(p, len);
+    if(!n)
+        return;
+    p += n;
+    len -= n;
+    n = osc_string(p, len);
+    if(!n || *p != ',') /* the oldest senders had no tags, no matter */
+        return;
+    tags = (const char *)p + 1;
+    p += n;
+    len -= n;
+    for(cnt = 0; *tags && cnt < LIVE_OSC_ARGS; tags++) {
+        switch(*tags) {
+        case 'i': case 'f': case 'r':
+            if(len < 4)
+                return;
+            args[cnt].type = *tags;
+            args[cnt++].u = get_u32(p);
+            p += 4;
+            len -= 4;
+            break;
+        case 's':
+            n = osc_string(p, len);
+            if(!n)
+                return;
+            args[cnt].type = 's';
+            args[cnt++].s = (const char *)p;
+            p += n;
+            len -= n;
+            break;
+        case 'T': case 'F': case 'N': case 'I': /* no data */
+            break;
+        default: /* its size is unknown, so are the ones after it */
+            take_param(addr, args, cnt);
+            return;
+        }
+    }
+    take_param(addr, args, cnt);
+}
+
+/* The bytes of a string with its padding, 0 if it doesn't end in time */
+static size_t osc_string(const unsigned char *p, size_t len)
+{
+    const unsigned char *nul = memchr(p, '\0', len);
+    size_t n;
+    if(!nul)
+        return 0;
+    n = (nul - p + 4) & ~(size_t)3;
+    return n <= len ? n : 0;
+}
+
+/* A float is a fraction, 1.0 is 100% or 255 */
+static void take_param(const char *addr, const struct osc_arg *args,
+                       int cnt)
+{
+    size_t prefix = strlen(LIVE_OSC_PREFIX);
+    char num[LIVE_ARG_LEN];
+    double id;
+    int value;
+    if(cnt == 0 || strncmp(addr, LIVE_OSC_PREFIX, prefix))
+        return;
+    addr += prefix;
+    if(strequ(addr, "/dim") || strequ(addr, "/upper/dim") ||
+                               strequ(addr, "/lower/dim")) {
+        value = osc_percent(args, 0, MAX_BR_SPD_DLY);
+        if(value == NOT_GIVEN)
+            return;
+        if(addr[1] != 'l')
+            live->dim[0] = value;
+        if(addr[1] != 'u')
+            live->dim[1] = value;
+    } else if(strequ(addr, "/rate")) {
+        value = osc_percent(args, 1, MAX_RATE);
+        if(value != NOT_GIVEN)
+            live->rate = value;
+    } else if(strequ(addr, "/color")) {
+        value = osc_color(args, cnt);
+        if(value != nocolor)
+            set_color(value);
+    } else if(strequ(addr, "/preset")) {
+        if(args[0].type == 's') {
+            set_preset(args[0].s);
+        } else if(args[0].type == 'i' && osc_number(args, &id) && id > 0) {
+            sprintf(num, "%d", (int)id);
+            set_preset(num);
+        }
+    }
+}
+
+static int osc_percent(const struct osc_arg *arg, int min, int max)
+{
+    double num;
+    if(!osc_number(arg, &num))
+        return NOT_GIVEN;
+    return clamp(arg->type == 'f' ? num*100 : num, min, max);
+}
+
+/* 0xRRGGBB as i, RGBA as r, "RRGGBB" as s or three components */
+static int osc_color(const struct osc_arg *args, int cnt)
+{
+    double c[3];
+    char *end;
+    unsigned long hex;
+    int i;
+    if(cnt >= 3 && osc_number(&args[0], &c[0]) &&
+       osc_number(&args[1], &c[1]) && osc_number(&args[2], &c[2])) {
+        for(i = 0; i < 3; i++)
+            c[i] = clamp(args[i].type == 'f' ? c[i]*255 : c[i], 0, 255);
+        return (int)c[0] << 16 | (int)c[1] << 8 | (int)c[2];
+    }
+    switch(args[0].type) {
+    case 'i':
+        return args[0].u & 0xffffff;
+    case 'r':
+        return args[0].u >> 8 & 0xffffff;
+    case 's':
+        hex = strtoul(args[0].s + (args[0].s[0] == '#'), &end, 16);
+        return *end == '\0' && end - args[0].s > 1 ? (int)(hex & 0xffffff)
+                                                   : nocolor;
+    }
+    return nocolor;
+}
+
+/* An i is signed, an f is a float of IEEE 754 */
+static int osc_number(const struct osc_arg *arg, double *num)
+{
+    float f;
+    uint32_t bits = (uint32_t)arg->u;
+    if(arg->type == 'i') {
+        *num = (int32_t)bits;
+        return 1;
+    }
+    if(arg->type == 'f') {
+        memcpy(&f, &bits, sizeof(f));
+        *num = f;
+        return f == f; /* not a NaN */
+    }
+    return 0;
+}
+
+static int clamp(double num, int min, int max)
+{
+    if(num < min)
+        return min;
+    if(num > max)
+        return max;
+    return (int)(num + 0.5);
+}
+
+/* The scene is the newest one, a color or a preset */
+static void set_color(int color)
+{
+    live->color = color;
+    live->preset[0] = '\0';
+}
+
+static void set_preset(const char *preset)
+{
+    if(!*preset || strlen(preset) >= LIVE_ARG_LEN)
+        return;
+    strcpy(live->preset, preset);
+    live->color = nocolor;
+}
+
+static void add_arg(struct live_args *la, const char *fmt, const char *str,
+                    int num)
+{
+    if(str)
+        snprintf(la->text[la->argc], LIVE_ARG_LEN, fmt, str);
+    else
+        snprintf(la->text[la->argc], LIVE_ARG_LEN, fmt, num);
+    la->argv[la->argc] = la->text[la->argc];
+    la->argc++;
+}
+
+static unsigned long get_u32(const unsigned char *p)
+{
+    return (unsigned long)p[0] << 24 | (unsigned long)p[1] << 16 |
+           (unsigned long)p[2] << 8 | p[3];
+}
+
+#ifdef WITH_ALSA
+/* Nonblocking, it stops when there are no more */
+static void read_midi(void)
+{
+    snd_seq_event_t *ev;
+    int i, err;
+    if(!live->seq)
+        return;
+    for(i = 0; i < LIVE_READ_CAP; i++) {
+        err = snd_seq_event_input(live->seq, &ev);
+        if(err == -ENOSPC) /* an overrun, the older events are lost */
+            continue;
+        if(err < 0 || !ev)
+            return;
+        take_event(ev);
+    }
+}
+
+/* A controller of 0-127 is 0-100%, the rate is 100% at 64; a program
+ * change plays the preset of the number one higher */
+static void take_event(const snd_seq_event_t *ev)
+{
+    int value = ev->data.control.value, shift;
+    char num[LIVE_ARG_LEN];
+    if(ev->type == SND_SEQ_EVENT_PGMCHANGE) {
+        sprintf(num, "%d", clamp(value, 0, LIVE_MIDI_MAX) + 1);
+        set_preset(num);
+        return;
+    }
+    if(ev->type != SND_SEQ_EVENT_CONTROLLER)
+        return;
+    value = clamp(value, 0, LIVE_MIDI_MAX);
+    switch(ev->data.control.param) {
+    case LIVE_CC_DIM:
+        live->dim[0] = live->dim[1] = value*MAX_BR_SPD_DLY/LIVE_MIDI_MAX;
+        break;
+    case LIVE_CC_UPPER_DIM:
+        live->dim[0] = value*MAX_BR_SPD_DLY/LIVE_MIDI_MAX;
+        break;
+    case LIVE_CC_LOWER_DIM:
+        live->dim[1] = value*MAX_BR_SPD_DLY/LIVE_MIDI_MAX;
+        break;
+    case LIVE_CC_RATE:
+        live->rate = clamp(value*RATE_DEFAULT/(LIVE_MIDI_MAX/2+1), 1,
+                           MAX_RATE);
+        break;
+    case LIVE_CC_RED: case LIVE_CC_GREEN: case LIVE_CC_BLUE:
+        shift = 8*(LIVE_CC_BLUE - ev->data.control.param);
+        live->midi_rgb = (live->midi_rgb & ~(0xff << shift)) |
+                         (value << 1 | value >> 6) << shift;
+        set_color(live->midi_rgb);
+        break;
+    }
+}
+#endif
@@ -0,0 +1,76 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File live.h
+ * The live control of the running scene: OSC messages over UDP on
+ * 127.0.0.1 and the MIDI events coming to an ALSA sequencer port change the
+ * brightness, the rate, the color or the preset. All that has come is read
+ * right before every frame and only the newest value of each parameter is
+ * taken, so a fader moving faster than the frames costs one change a frame
+ * and nothing waits for a whole frame more.
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#ifndef LIVE_SENTRY
+#define LIVE_SENTRY
+
+#include "locale_macros.h"
+#include "argparser.h" /* for NOT_GIVEN, nocolor, MAX_RATE */
+
+/* Constants */
+#define LIVE_OSC_PREFIX "/quadcastrgb" /* of every address */
+#define LIVE_MAX_PACKET 1536 /* bytes of a datagram, a longer one is cut */
+#define LIVE_MAX_NEST 4 /* bundles in bundles */
+#define LIVE_OSC_ARGS 8 /* the ones of a message looked at */
+#define LIVE_READ_CAP 256 /* datagrams and events per frame */
+#define LIVE_MAX_ARGS 12 /* of the request made of the changes */
+#define LIVE_ARG_LEN 64 /* the longest preset name taken, NUL included */
+#define LIVE_MIDI_CLIENT "quadcastrgb"
+#define LIVE_MIDI_PORT "control"
+/* The MIDI controllers, on any channel */
+#define LIVE_CC_RATE 1 /* the modulation wheel, 64 is the normal rate */
+#define LIVE_CC_DIM 7 /* the channel volume, both groups */
+#define LIVE_CC_RED 16 /* the general purpose ones 1-3, a solid color */
+#define LIVE_CC_GREEN 17
+#define LIVE_CC_BLUE 18
+#define LIVE_CC_UPPER_DIM 20 /* undefined ones */
+#define LIVE_CC_LOWER_DIM 21
+#define LIVE_MIDI_MAX 127
+
+/* Messages */
+#define LIVE_OSC_ERR_MSG _("Couldn't listen for OSC on 127.0.0.1:%d: %s\n")
+#define LIVE_NOALSA_ERR_MSG _("--midi: built without ALSA, rebuild with "\
+                              "ALSA=1\n")
+#define LIVE_MIDI_ERR_MSG _("ALSA sequencer: %s: %s\n")
+
+/* Structs */
+struct live_args { /* a request, as the control socket would give it */
+    int argc;
+    const char *argv[LIVE_MAX_ARGS];
+    char text[LIVE_MAX_ARGS][LIVE_ARG_LEN];
+};
+
+/* Functions */
+/* No OSC if the port is 0, no MIDI if the source is NULL; "-" makes the
+ * port only, for aconnect. 0 or message */
+int live_open(int osc_port, const char *midi);
+void live_close(void);
+/* The options doing what has changed since the last call, 0 if nothing */
+int live_poll(struct live_args *la);
+
+#endif
@@ -0,0 +1,497 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File openrgb.c
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#include <stdio.h> /* for fprintf */
+#include <stdlib.h> /* for malloc, free, strtol */
+#include <string.h> /* for memcpy, strlen, strerror */
+#include <errno.h> /* for errno */
+#include <unistd.h> /* for close */
+#include <fcntl.h> /* for fcntl */
+#include <sys/socket.h> /* for socket, bind, accept, recv, send */
+#include <netinet/in.h> /* for struct sockaddr_in */
+#include <netinet/tcp.h> /* for TCP_NODELAY */
+#include <arpa/inet.h> /* for htonl, htons */
+
+#include "openrgb.h"
+
+/* Constants */
+#ifndef MSG_NOSIGNAL /* macOS, SO_NOSIGPIPE is set instead */
+#define MSG_NOSIGNAL 0
+#endif
+#define DESCR_LEN 512 /* enough for the description of the device */
+/* Packet ids */
+#define REQUEST_CONTROLLER_COUNT 0
+#define REQUEST_CONTROLLER_DATA 1
+#define REQUEST_PROTOCOL_VERSION 40
+#define SET_CLIENT_NAME 50
+#define UPDATE_LEDS 1050
+#define UPDATE_ZONE_LEDS 1051
+#define UPDATE_SINGLE_LED 1052
+/* The description */
+#define DEVICE_TYPE_MICROPHONE 16
+#define ZONE_TYPE_SINGLE 0
+#define MODE_FLAG_HAS_PER_LED_COLOR (1 << 5)
+#define MODE_COLORS_PER_LED 1
+#define COLOR_LEN 4 /* R, G, B and a pad byte */
+
+/* Structs */
+struct orgb_gen { /* a group's layer, a frame at a time */
+    struct seqgen gen;
+    int group;
+    struct orgb_server *srv; /* held */
+    unsigned long frame; /* the server's frame it has seen */
+};
+
+/* The server new generators read and the one it has replaced, still read
+ * by the playing scene (BE CAREFUL: GLOBAL VARIABLES) */
+static struct orgb_server *server = NULL, *replaced = NULL;
+
+static void orgb_next(struct seqgen *gen, struct sequence *seq);
+static void orgb_free(struct seqgen *gen);
+static void release_server(struct orgb_server *srv);
+static void free_server(struct orgb_server *srv);
+static int sync_server(struct orgb_server *srv, unsigned long *frame);
+static void accept_clients(struct orgb_server *srv);
+static void read_client(struct orgb_client *cl);
+static int feed_client(struct orgb_client *cl, const unsigned char *data,
+                       size_t len);
+static int handle_packet(struct orgb_client *cl, unsigned long dev,
+                         unsigned long id, const unsigned char *data,
+                         unsigned long len);
+static int reply(struct orgb_client *cl, unsigned long dev, unsigned long id,
+                 const unsigned char *data, size_t len);
+static void drop_client(struct orgb_client *cl);
+static size_t describe(const struct orgb_server *srv, unsigned char *buf,
+                       unsigned int protocol);
+static void set_led(struct orgb_server *srv, int led,
+                    const unsigned char *color);
+/* Little-endian fields */
+static unsigned char *put_u16(unsigned char *p, unsigned int v);
+static unsigned char *put_u32(unsigned char *p, unsigned long v);
+static unsigned char *put_str(unsigned char *p, const char *str);
+static unsigned char *put_color(unsigned char *p, int color);
+static unsigned int get_u16(const unsigned char *p);
+static unsigned long get_u32(const unsigned char *p);
+
+/* Functions */
+int orgb_open(const char *port)
+{
+    struct orgb_server *srv;
+    struct sockaddr_in addr;
+    char *end;
+    long num = strtol(port, &end, 10);
+    int i, on = 1;
+    if(*port == '\0' || *end != '\0' || num < 1 || num > 65535) {
+        fprintf(stderr, ORGB_PORT_ERR_MSG, port);
+        return 1;
+    }
+    if(server && server->port == num)
+        return 0;
+    if(server && server->refs == 0) { /* opened for this scene already */
+        fprintf(stderr, ORGB_SOURCE_ERR_MSG, server->port, (int)num);
+        return 1;
+    }
+    srv = malloc(sizeof(*srv));
+    srv->port = (int)num;
+    srv->fd = socket(AF_INET, SOCK_STREAM, 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((unsigned short)num);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK); /* never the network */
+    if(srv->fd < 0 ||
+       setsockopt(srv->fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) ||
+       bind(srv->fd, (struct sockaddr *)&addr, sizeof(addr)) ||
+       listen(srv->fd, ORGB_BACKLOG) ||
+       fcntl(srv->fd, F_SETFL, fcntl(srv->fd, F_GETFL) | O_NONBLOCK)) {
+        fprintf(stderr, ORGB_LISTEN_ERR_MSG, srv->port, strerror(errno));
+        if(srv->fd >= 0)
+            close(srv->fd);
+        free(srv);
+        return 1;
+    }
+    for(i = 0; i < ORGB_MAX_CLIENTS; i++) {
+        srv->clients[i].srv = srv;
+        srv->clients[i].fd = -1;
+    }
+    srv->frame = 0;
+    srv->upper = srv->lower = black;
+    srv->refs = 0;
+    replaced = server; /* the old one is left to its generators */
+    server = srv;
+    return 0;
+}
+
+void orgb_close(void)
+{
+    struct orgb_server *srv = server;
+    if(srv && srv->refs > 0)
+        return;
+    server = replaced; /* a scene that isn't made gives it back */
+    replaced = NULL;
+    if(srv)
+        free_server(srv);
+}
+
+/* orgb_open must have succeeded */
+void sequence_openrgb(int group, struct sequence *seq)
+{
+    struct orgb_gen *og = malloc(sizeof(*og));
+    og->gen.next = orgb_next;
+    og->gen.free = orgb_free;
+    og->group = group;
+    og->srv = server;
+    server->refs++;
+    og->frame = ORGB_UNSTARTED;
+    seq_endless(seq, &og->gen);
+}
+
+/* Called right before the frame is sent */
+static void orgb_next(struct seqgen *gen, struct sequence *seq)
+{
+    struct orgb_gen *og = (struct orgb_gen *)gen;
+    if(!sync_server(og->srv, &og->frame)) {
+        seq_run(seq, black, 1);
+        return;
+    }
+    seq_run(seq, og->group == lower ? og->srv->lower : og->srv->upper, 1);
+}
+
+static void orgb_free(struct seqgen *gen)
+{
+    struct orgb_gen *og = (struct orgb_gen *)gen;
+    release_server(og->srv);
+    free(og);
+}
+
+/* The port is closed when no scene plays it any more */
+static void release_server(struct orgb_server *srv)
+{
+    if(--srv->refs > 0)
+        return;
+    if(srv == server)
+        server = NULL;
+    if(srv == replaced)
+        replaced = NULL;
+    free_server(srv);
+}
+
+static void free_server(struct orgb_server *srv)
+{
+    int i;
+    for(i = 0; i < ORGB_MAX_CLIENTS; i++)
+        drop_client(&srv->clients[i]);
+    close(srv->fd);
+    free(srv);
+}
+
+/* The first generator called in a frame serves the clients, the others
+ * see the same; the call made with the sequence, before the frames,
+ * doesn't */
+static int sync_server(struct orgb_server *srv, unsigned long *frame)
+{
+    int i;
+    if(*frame == ORGB_UNSTARTED) {
+        *frame = srv->frame;
+        return 0;
+    }
+    if(*frame == srv->frame) {
+        accept_clients(srv);
+        for(i = 0; i < ORGB_MAX_CLIENTS; i++) {
+            if(srv->clients[i].fd >= 0)
+                read_client(&srv->clients[i]);
+        }
+        srv->frame++;
+    }
+    *frame = srv->frame;
+    return 1;
+}
+
+static void accept_clients(struct orgb_server *srv)
+{
+    struct orgb_client *cl;
+    int fd, i, on = 1;
+    while((fd = accept(srv->fd, NULL, NULL)) >= 0) {
+        for(i = 0; i < ORGB_MAX_CLIENTS && srv->clients[i].fd >= 0; i++)
+            {}
+        if(i == ORGB_MAX_CLIENTS) {
+            close(fd);
+            continue;
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        #ifdef SO_NOSIGPIPE
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+        #endif
+        cl = &srv->clients[i];
+        cl->fd = fd;
+        cl->protocol = 0;
+        cl->len = 0;
+        cl->skip = 0;
+    }
+}
+
+/* Everything that has come, up to a limit, the rest waits a frame */
+static void read_client(struct orgb_client *cl)
+{
+    unsigned char chunk[4096];
+    unsigned long total = 0;
+    ssize_t n;
+    while(total < ORGB_READ_CAP) {
+        n = recv(cl->fd, chunk, sizeof(chunk), 0);
+        if(n < 0 && errno == EINTR)
+            continue;
+        if(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return;
+        if(n <= 0 || feed_client(cl, chunk, n)) { /* gone or not OpenRGB */
+            drop_client(cl);
+            return;
+        }
+        total += n;
+    }
+}
+
+/* Splits the stream into packets, 1 if the client must be dropped */
+static int feed_client(struct orgb_client *cl, const unsigned char *data,
+                       size_t len)
+{
+    size_t need, part;
+    unsigned long size;
+    while(len > 0) {
+        if(cl->skip) {
+            part = cl->skip < len ? cl->skip : len;
+            cl->skip -= part;
+            data += part;
+            len -= part;
+            continue;
+        }
+        need = ORGB_HEADER_LEN;
+        if(cl->len >= ORGB_HEADER_LEN)
+            need += get_u32(cl->buf+12);
+        part = need - cl->len < len ? need - cl->len : len;
+        memcpy(cl->buf + cl->len, data, part);
+        cl->len += part;
+        data += part;
+        len -= part;
+        if(cl->len < ORGB_HEADER_LEN)
+            continue;
+        if(0 != memcmp(cl->buf, "ORGB", 4))
+            return 1;
+        size = get_u32(cl->buf+12);
+        if(size > ORGB_MAX_PACKET) {
+            cl->skip = size;
+            cl->len = 0;
+            continue;
+        }
+        if(cl->len < ORGB_HEADER_LEN + size)
+            continue;
+        cl->len = 0;
+        if(handle_packet(cl, get_u32(cl->buf+4), get_u32(cl->buf+8),
+                         cl->buf + ORGB_HEADER_LEN, size))
+            return 1;
+    }
+    return 0;
+}
+
+/* The rest of the packets, modes and profiles, change nothing */
+static int handle_packet(struct orgb_client *cl, unsigned long dev,
+                         unsigned long id, const unsigned char *data,
+                         unsigned long len)
+{
+    unsigned char out[DESCR_LEN];
+    unsigned int i, cnt;
+    switch(id) {
+    case REQUEST_CONTROLLER_COUNT:
+        put_u32(out, 1);
+        return reply(cl, 0, id, out, 4);
+    case REQUEST_CONTROLLER_DATA:
+        if(dev != 0)
+            return 0;
+        if(len >= 4) /* the version the client wants it in */
+            cl->protocol = get_u32(data) < ORGB_PROTOCOL ? get_u32(data)
+                                                          : ORGB_PROTOCOL;
+        return reply(cl, 0, id, out, describe(cl->srv, out, cl->protocol));
+    case REQUEST_PROTOCOL_VERSION:
+        if(len >= 4)
+            cl->protocol = get_u32(data) < ORGB_PROTOCOL ? get_u32(data)
+                                                          : ORGB_PROTOCOL;
+        put_u32(out, ORGB_PROTOCOL);
+        return reply(cl, 0, id, out, 4);
+    case UPDATE_LEDS: /* the size, the count, the colors */
+        if(dev != 0 || len < 6)
+            return 0;
+        cnt = get_u16(data+4);
+        for(i = 0; i < cnt && i < 2 && 6 + (i+1)*COLOR_LEN <= len; i++)
+            set_led(cl->srv, i, data + 6 + i*COLOR_LEN);
+        return 0;
+    case UPDATE_ZONE_LEDS: /* the size, the zone, the count, the colors */
+        if(dev != 0 || len < 10 + COLOR_LEN || get_u16(data+8) < 1)
+            return 0;
+        set_led(cl->srv, (int)get_u32(data+4), data+10);
+        return 0;
+    case UPDATE_SINGLE_LED: /* the LED, the color */
+        if(dev != 0 || len < 4 + COLOR_LEN)
+            return 0;
+        set_led(cl->srv, (int)get_u32(data), data+4);
+        return 0;
+    default: /* SET_CLIENT_NAME among them */
+        return 0;
+    }
+}
+
+/* 1 if it can't be sent at once: the client doesn't read its replies */
+static int reply(struct orgb_client *cl, unsigned long dev, unsigned long id,
+                 const unsigned char *data, size_t len)
+{
+    unsigned char pkt[ORGB_HEADER_LEN + DESCR_LEN];
+    unsigned char *p = pkt;
+    ssize_t n;
+    memcpy(p, "ORGB", 4);
+    p = put_u32(p+4, dev);
+    p = put_u32(p, id);
+    p = put_u32(p, len);
+    memcpy(p, data, len);
+    do {
+        n = send(cl->fd, pkt, ORGB_HEADER_LEN + len, MSG_NOSIGNAL);
+    } while(n < 0 && errno == EINTR);
+    return n != (ssize_t)(ORGB_HEADER_LEN + len);
+}
+
+static void drop_client(struct orgb_client *cl)
+{
+    if(cl->fd < 0)
+        return;
+    close(cl->fd);
+    cl->fd = -1;
+}
+
+/* As RGBController::GetDeviceDescription writes it, up to version 3 */
+static size_t describe(const struct orgb_server *srv, unsigned char *buf,
+                       unsigned int protocol)
+{
+    static const char *names[2] = { "Upper", "Lower" };
+    unsigned char *p = buf + 4; /* the size goes first */
+    int i;
+    p = put_u32(p, DEVICE_TYPE_MICROPHONE);
+    p = put_str(p, "HyperX QuadCast S");
+    if(protocol >= 1)
+        p = put_str(p, "HyperX");
+    p = put_str(p, "quadcastrgb");
+    p = put_str(p, VERSION);
+    p = put_str(p, ""); /* the serial */
+    p = put_str(p, "quadcastrgb");
+    /* The only mode */
+    p = put_u16(p, 1);
+    p = put_u32(p, 0); /* active */
+    p = put_str(p, "Direct");
+    p = put_u32(p, 0); /* value */
+    p = put_u32(p, MODE_FLAG_HAS_PER_LED_COLOR);
+    p = put_u32(p, 0); /* speed min */
+    p = put_u32(p, 0); /* speed max */
+    if(protocol >= 3) {
+        p = put_u32(p, 0); /* brightness min */
+        p = put_u32(p, 0); /* brightness max */
+    }
+    p = put_u32(p, 0); /* colors min */
+    p = put_u32(p, 0); /* colors max */
+    p = put_u32(p, 0); /* speed */
+    if(protocol >= 3)
+        p = put_u32(p, 0); /* brightness */
+    p = put_u32(p, 0); /* direction */
+    p = put_u32(p, MODE_COLORS_PER_LED);
+    p = put_u16(p, 0); /* colors */
+    /* A zone of one LED per diode group */
+    p = put_u16(p, 2);
+    for(i = 0; i < 2; i++) {
+        p = put_str(p, names[i]);
+        p = put_u32(p, ZONE_TYPE_SINGLE);
+        p = put_u32(p, 1); /* LEDs min */
+        p = put_u32(p, 1); /* LEDs max */
+        p = put_u32(p, 1); /* LEDs */
+        p = put_u16(p, 0); /* no matrix */
+    }
+    p = put_u16(p, 2);
+    for(i = 0; i < 2; i++) {
+        p = put_str(p, names[i]);
+        p = put_u32(p, i); /* value */
+    }
+    p = put_u16(p, 2);
+    p = put_color(p, srv->upper);
+    p = put_color(p, srv->lower);
+    put_u32(buf, p - buf);
+    return p - buf;
+}
+
+static void set_led(struct orgb_server *srv, int led,
+                    const unsigned char *color)
+{
+    int rgb = color[0] << 16 | color[1] << 8 | color[2];
+    if(led == 0)
+        srv->upper = rgb;
+    else if(led == 1)
+        srv->lower = rgb;
+}
+
+static unsigned char *put_u16(unsigned char *p, unsigned int v)
+{
+    p[0] = v & 0xff;
+    p[1] = (v >> 8) & 0xff;
+    return p+2;
+}
+
+static unsigned char *put_u32(unsigned char *p, unsigned long v)
+{
+    p[0] = v & 0xff;
+    p[1] = (v >> 8) & 0xff;
+    p[2] = (v >> 16) & 0xff;
+    p[3] = (v >> 24) & 0xff;
+    return p+4;
+}
+
+/* The length with the '\0' and the string with it */
+static unsigned char *put_str(unsigned char *p, const char *str)
+{
+    size_t len = strlen(str) + 1;
+    p = put_u16(p, len);
+    memcpy(p, str, len);
+    return p + len;
+}
+
+/* RGBColor is 0x00BBGGRR */
+static unsigned char *put_color(unsigned char *p, int color)
+{
+    p[0] = (color >> 16) & 0xff;
+    p[1] = (color >> 8) & 0xff;
+    p[2] = color & 0xff;
+    p[3] = 0;
+    return p+4;
+}
+
+static unsigned int get_u16(const unsigned char *p)
+{
+    return p[0] | p[1] << 8;
+}
+
+static unsigned long get_u32(const unsigned char *p)
+{
+    return p[0] | p[1] << 8 | (unsigned long)p[2] << 16 |
+           (unsigned long)p[3] << 24;
+}
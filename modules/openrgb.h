@@ -0,0 +1,79 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File openrgb.h
+ * The openrgb mode: a server of the OpenRGB SDK protocol on 127.0.0.1.
+ * The microphone is one device of the type microphone with the Direct
+ * mode and two zones of one LED each: upper and lower. The clients are
+ * served right before every frame is sent, all the packets that have come
+ * by then are read and only the newest colors are shown, so a burst of
+ * updates never waits for the transfers.
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#ifndef OPENRGB_SENTRY
+#define OPENRGB_SENTRY
+
+#include <stddef.h> /* for size_t */
+#include "locale_macros.h"
+#include "argparser.h" /* for black, enum diode_group, VERSION */
+#include "sequence.h" /* for struct sequence, struct seqgen */
+
+/* Constants */
+#define ORGB_PROTOCOL 3 /* the newest version spoken */
+#define ORGB_MAX_CLIENTS 8
+#define ORGB_HEADER_LEN 16 /* "ORGB", device, packet id, data size */
+#define ORGB_MAX_PACKET 1024 /* larger ones are skipped */
+#define ORGB_READ_CAP 65536 /* bytes per client per frame */
+#define ORGB_BACKLOG 4
+#define ORGB_UNSTARTED ((unsigned long)-1) /* the frame of a new generator */
+
+/* Messages */
+#define ORGB_PORT_ERR_MSG _("openrgb: the port must be 1-65535, not %s\n")
+#define ORGB_LISTEN_ERR_MSG _("Couldn't listen on 127.0.0.1:%d: %s\n")
+#define ORGB_SOURCE_ERR_MSG _("One OpenRGB port at a time: %d and %d\n")
+
+/* Structs */
+struct orgb_server;
+
+struct orgb_client {
+    struct orgb_server *srv; /* the one it's connected to */
+    int fd; /* -1 if the place is free */
+    unsigned int protocol; /* agreed on, 0 until asked */
+    unsigned char buf[ORGB_HEADER_LEN + ORGB_MAX_PACKET]; /* a packet */
+    size_t len; /* of it read */
+    unsigned long skip; /* bytes of a too large packet left to drop */
+};
+
+struct orgb_server {
+    int port;
+    int fd; /* listening */
+    struct orgb_client clients[ORGB_MAX_CLIENTS];
+    unsigned long frame; /* the frames served */
+    int upper, lower; /* the LEDs as the clients have set them */
+    int refs; /* the generators reading it */
+};
+
+/* Functions */
+/* 0 or message, again with the same. Another port replaces the server in
+ * use, which goes on until the last generator reading it is freed */
+int orgb_open(const char *port);
+void orgb_close(void); /* the one opened if unread, back to the old one */
+void sequence_openrgb(int group, struct sequence *seq);
+
+#endif
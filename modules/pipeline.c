@@ -0,0 +1,114 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File pipeline.c
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#include <stdio.h> /* for snprintf */
+
+#include "locale_macros.h"
+
+#include "pipeline.h"
+
+/* The counters are accessed atomically, GCC and Clang builtins. A slot is
+ * filled before the head is released and read before the tail is */
+#define ACQUIRE(P) __atomic_load_n((P), __ATOMIC_ACQUIRE)
+#define RELEASE(P, V) __atomic_store_n((P), (V), __ATOMIC_RELEASE)
+#define READ(P) __atomic_load_n((P), __ATOMIC_RELAXED)
+#define WRITE(P, V) __atomic_store_n((P), (V), __ATOMIC_RELAXED)
+
+/* Messages */
+#define PIPE_STATS_MSG _("Pipeline: %lu frames taken, up to %u made ahead, " \
+                         "%lu.%lu ready on average, %u at least; " \
+                         "%lu underruns\n")
+
+/* Functions */
+void pipe_init(struct pipeline *pp, unsigned int ahead)
+{
+    if(ahead < 1)
+        ahead = 1;
+    if(ahead > PIPE_SLOTS-1)
+        ahead = PIPE_SLOTS-1;
+    pp->ahead = ahead;
+    pp->head = pp->tail = 0;
+    pp->resend = 0;
+    pp->underruns = pp->waiting = pp->dropped = 0;
+    pp->least = ahead;
+}
+
+struct pipe_frame *pipe_slot(struct pipeline *pp)
+{
+    unsigned long head = READ(&pp->head);
+    if(head - ACQUIRE(&pp->tail) >= pp->ahead)
+        return NULL;
+    return &pp->frames[head % PIPE_SLOTS];
+}
+
+void pipe_push(struct pipeline *pp)
+{
+    RELEASE(&pp->head, READ(&pp->head) + 1);
+}
+
+int pipe_resent(struct pipeline *pp)
+{
+    return READ(&pp->resend) && __atomic_exchange_n(&pp->resend, 0,
+                                                    __ATOMIC_RELAXED);
+}
+
+const struct pipe_frame *pipe_peek(struct pipeline *pp)
+{
+    unsigned long tail = READ(&pp->tail);
+    unsigned int cnt = ACQUIRE(&pp->head) - tail;
+    if(cnt == 0) {
+        WRITE(&pp->underruns, READ(&pp->underruns) + 1);
+        WRITE(&pp->least, 0);
+        return NULL;
+    }
+    WRITE(&pp->waiting, READ(&pp->waiting) + cnt);
+    if(cnt < READ(&pp->least))
+        WRITE(&pp->least, cnt);
+    return &pp->frames[tail % PIPE_SLOTS];
+}
+
+void pipe_pop(struct pipeline *pp)
+{
+    RELEASE(&pp->tail, READ(&pp->tail) + 1);
+}
+
+void pipe_resend(struct pipeline *pp)
+{
+    WRITE(&pp->resend, 1);
+}
+
+/* Taken without being sent, they don't count */
+void pipe_drop(struct pipeline *pp)
+{
+    unsigned long head = ACQUIRE(&pp->head);
+    WRITE(&pp->dropped, READ(&pp->dropped) + (head - READ(&pp->tail)));
+    RELEASE(&pp->tail, head);
+}
+
+void pipe_report(struct pipeline *pp, char *buf, size_t len)
+{
+    unsigned long taken = READ(&pp->tail) - READ(&pp->dropped);
+    unsigned long waiting = READ(&pp->waiting);
+    unsigned long avg = taken ? 10*waiting/taken : 0;
+    snprintf(buf, len, PIPE_STATS_MSG, taken, pp->ahead, avg/10, avg%10,
+             READ(&pp->least), READ(&pp->underruns));
+}
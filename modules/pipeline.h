@@ -0,0 +1,73 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File pipeline.h
+ * The frames made ahead of time by one thread and sent by another, a ring
+ * with one writer and one reader and no locks. The writer makes a frame
+ * while there's a free slot and at most the given number of them waiting;
+ * the reader takes one every frame and never waits. If none is ready, it's
+ * an underrun: the device keeps the colors it shows for one more frame.
+ * While the writer is stopped, the reader may drop the frames waiting, so
+ * the ones made after a change are sent next.
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#ifndef PIPELINE_SENTRY
+#define PIPELINE_SENTRY
+
+#include <stddef.h> /* for size_t */
+
+/* Constants */
+#define PIPE_SLOTS 16 /* a power of two */
+#define PIPE_FRAME_SIZE 64 /* bytes, a packet of colors */
+
+/* Structs */
+struct pipe_frame {
+    unsigned char packet[PIPE_FRAME_SIZE];
+    int send; /* 0 if the colors are the ones sent before */
+};
+
+struct pipeline {
+    struct pipe_frame frames[PIPE_SLOTS];
+    unsigned int ahead; /* the frames that may wait, 1 to PIPE_SLOTS-1 */
+    /* The counters only grow, each has one thread writing it */
+    unsigned long head; /* made, the writer's */
+    unsigned long tail; /* taken, the reader's */
+    int resend; /* set by the reader, the device has forgotten the colors */
+    /* Statistics, the reader's */
+    unsigned long underruns;
+    unsigned long waiting; /* the sum of the frames waiting at every take */
+    unsigned int least; /* of them, since the start */
+    unsigned long dropped;
+};
+
+/* Functions */
+void pipe_init(struct pipeline *pp, unsigned int ahead);
+/* The writer's: the slot to fill, NULL if enough frames wait already */
+struct pipe_frame *pipe_slot(struct pipeline *pp);
+void pipe_push(struct pipeline *pp); /* the slot is filled */
+int pipe_resent(struct pipeline *pp); /* 1 once after pipe_resend */
+/* The reader's: the frame to send, NULL on an underrun */
+const struct pipe_frame *pipe_peek(struct pipeline *pp);
+void pipe_pop(struct pipeline *pp); /* after a frame that pipe_peek gave */
+void pipe_resend(struct pipeline *pp);
+void pipe_drop(struct pipeline *pp); /* only while the writer is stopped */
+/* Either thread, the statistics as a line of text */
+void pipe_report(struct pipeline *pp, char *buf, size_t len);
+
+#endif
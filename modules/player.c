@@ -0,0 +1,205 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File player.c
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#include "player.h"
+
+/* The cue is handed over atomically, GCC and Clang builtins. Its scene is
+ * built before the cue is released and read after it's acquired */
+#define READ(P) __atomic_load_n((P), __ATOMIC_RELAXED)
+#define EXCHANGE(P, V) __atomic_exchange_n((P), (V), __ATOMIC_ACQ_REL)
+
+static void take_next(struct player *pl, struct cue *cue);
+static void free_cue(struct cue *cue);
+static void track_init(struct track *tr, struct scene *sc);
+static void track_colors(struct track *tr, int *upper_col, int *lower_col);
+static void track_step(struct track *tr);
+static void track_advance(struct track *tr, unsigned int rate);
+static int mix(int from, int to, unsigned int pos, unsigned int len);
+
+/* Functions */
+void player_init(struct player *pl, struct scene *sc)
+{
+    track_init(&pl->cur, sc);
+    track_init(&pl->old, NULL);
+    pl->next = NULL;
+    pl->rate = RATE_ONE;
+    pl->fade = pl->fade_len = 0;
+    pl->upper = pl->lower = 0;
+    pl->started = 0;
+}
+
+void player_free(struct player *pl)
+{
+    free_scene(pl->cur.sc);
+    free_scene(pl->old.sc);
+    free_cue(EXCHANGE(&pl->next, NULL));
+    pl->cur.sc = pl->old.sc = NULL;
+}
+
+/* Any number of switches between two frames cost one crossfade */
+void player_switch(struct player *pl, struct scene *sc, unsigned int frames)
+{
+    struct cue *cue = malloc(sizeof(*cue));
+    if(!cue) { /* the playing scene stays */
+        free_scene(sc);
+        return;
+    }
+    cue->sc = sc;
+    cue->fade = frames;
+    free_cue(EXCHANGE(&pl->next, cue)); /* never shown */
+}
+
+void player_set_rate(struct player *pl, unsigned int rate)
+{
+    pl->rate = rate ? rate : 1; /* never stop, the scenes might be live */
+}
+
+int player_next(struct player *pl, int *upper_col, int *lower_col)
+{
+    struct cue *cue;
+    int changed;
+    if(READ(&pl->next) && (cue = EXCHANGE(&pl->next, NULL)))
+        take_next(pl, cue);
+    track_colors(&pl->cur, upper_col, lower_col);
+    track_advance(&pl->cur, pl->rate);
+    if(pl->fade_len) {
+        int old_upper, old_lower;
+        track_colors(&pl->old, &old_upper, &old_lower);
+        track_advance(&pl->old, pl->rate);
+        pl->fade++;
+        *upper_col = mix(old_upper, *upper_col, pl->fade, pl->fade_len);
+        *lower_col = mix(old_lower, *lower_col, pl->fade, pl->fade_len);
+        if(pl->fade == pl->fade_len) { /* this frame is the new scene's */
+            free_scene(pl->old.sc);
+            track_init(&pl->old, NULL);
+            pl->fade_len = 0;
+        }
+    }
+    changed = !pl->started || *upper_col != pl->upper ||
+              *lower_col != pl->lower;
+    pl->upper = *upper_col;
+    pl->lower = *lower_col;
+    pl->started = 1;
+    return changed;
+}
+
+static void take_next(struct player *pl, struct cue *cue)
+{
+    if(pl->fade_len && cue->fade) {
+        /* Neither scene is what's shown, the mix of them stays instead */
+        free_scene(pl->old.sc);
+        free_scene(pl->cur.sc);
+        track_init(&pl->old, NULL);
+        pl->old.upper = pl->upper;
+        pl->old.lower = pl->lower;
+    } else {
+        free_scene(pl->old.sc);
+        if(cue->fade) /* the current colors go on from where they are */
+            pl->old = pl->cur;
+        else
+            free_scene(pl->cur.sc);
+    }
+    track_init(&pl->cur, cue->sc);
+    pl->fade = 0;
+    pl->fade_len = cue->fade;
+    free(cue);
+}
+
+static void free_cue(struct cue *cue)
+{
+    if(!cue)
+        return;
+    free_scene(cue->sc);
+    free(cue);
+}
+
+static void track_init(struct track *tr, struct scene *sc)
+{
+    tr->sc = sc;
+    tr->left = tr->next_left = 0;
+    tr->frac = 0;
+    tr->upper = tr->lower = tr->next_upper = tr->next_lower = 0;
+}
+
+/* The scene is expanded only when the colors change, at the frame they
+ * are needed, unless a color between two frames needs the next ones */
+static void track_colors(struct track *tr, int *upper_col, int *lower_col)
+{
+    if(!tr->sc) {
+        *upper_col = tr->upper;
+        *lower_col = tr->lower;
+        return;
+    }
+    if(tr->left == 0)
+        track_step(tr);
+    *upper_col = tr->upper;
+    *lower_col = tr->lower;
+    if(tr->frac == 0 || tr->left > 1) /* no other color to go to */
+        return;
+    if(tr->next_left == 0)
+        tr->next_left = scene_next(tr->sc, &tr->next_upper, &tr->next_lower);
+    *upper_col = mix(tr->upper, tr->next_upper, tr->frac, RATE_ONE);
+    *lower_col = mix(tr->lower, tr->next_lower, tr->frac, RATE_ONE);
+}
+
+/* Moves to the colors after the current ones */
+static void track_step(struct track *tr)
+{
+    if(tr->next_left) { /* already expanded */
+        tr->left = tr->next_left;
+        tr->upper = tr->next_upper;
+        tr->lower = tr->next_lower;
+        tr->next_left = 0;
+    } else {
+        tr->left = scene_next(tr->sc, &tr->upper, &tr->lower);
+    }
+}
+
+static void track_advance(struct track *tr, unsigned int rate)
+{
+    unsigned int frames;
+    if(!tr->sc)
+        return;
+    tr->frac += rate;
+    frames = tr->frac >> RATE_SHIFT;
+    tr->frac &= RATE_ONE-1;
+    while(frames) {
+        if(tr->left > frames) {
+            tr->left -= frames;
+            return;
+        }
+        frames -= tr->left;
+        tr->left = 0; /* the next colors are taken when they are needed */
+        if(frames)
+            track_step(tr);
+    }
+}
+
+static int mix(int from, int to, unsigned int pos, unsigned int len)
+{
+    int shift, result = 0;
+    for(shift = 16; shift >= 0; shift -= 8) {
+        int f = (from >> shift) & 0xff, t = (to >> shift) & 0xff;
+        result |= (f + (int)((long)(t - f)*(long)pos/(long)len)) << shift;
+    }
+    return result;
+}
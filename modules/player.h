@@ -0,0 +1,79 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File player.h
+ * What the microphone shows: the current scene and, for a while after a
+ * switch, the previous one fading out. Both keep being expanded frame by
+ * frame, so a crossfade is never rendered in advance and costs a blend
+ * per channel only while it lasts.
+ * The scenes are played at a rate: a frame sent moves them by a fraction
+ * of their frames, a color between two frames is interpolated. At the
+ * rate of 1 the frames are exactly the frames of the scene.
+ * A switch is taken at the next frame, the latest one of those that come
+ * before it: a scene nobody has seen is freed at once and never faded
+ * from. A switch during a crossfade fades from the colors being shown.
+ * Switches may come from another thread than the frames.
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#ifndef PLAYER_SENTRY
+#define PLAYER_SENTRY
+
+#include "scene.h" /* for struct scene, scene_next */
+
+/* Constants */
+#define RATE_SHIFT 16
+#define RATE_ONE (1U << RATE_SHIFT) /* fixed point 1.0, the normal rate */
+
+/* Structs */
+struct track { /* a scene and the position in it */
+    struct scene *sc; /* owned, NULL: the colors of frame n stay */
+    unsigned int left; /* frames the colors of frame n stay, n included */
+    unsigned int next_left; /* the same of the colors after, 0: unknown */
+    unsigned int frac; /* the way from frame n to the next one */
+    int upper, lower; /* the colors of frame n */
+    int next_upper, next_lower;
+};
+
+struct cue { /* a switch waiting for the next frame */
+    struct scene *sc; /* owned */
+    unsigned int fade; /* frames of the crossfade to it */
+};
+
+struct player {
+    struct track cur; /* the one playing */
+    struct track old; /* the one fading out */
+    struct cue *next; /* taken at the next frame, exchanged atomically */
+    unsigned int rate; /* frames of the scenes per frame sent, fixed point */
+    unsigned int fade; /* frames of the crossfade played */
+    unsigned int fade_len; /* frames it lasts */
+    int upper, lower; /* the colors given the last time */
+    int started;
+};
+
+/* Functions */
+void player_init(struct player *pl, struct scene *sc); /* takes sc */
+void player_free(struct player *pl);
+/* Takes sc and fades over to it from the next frame, cuts if frames is 0 */
+void player_switch(struct player *pl, struct scene *sc, unsigned int frames);
+void player_set_rate(struct player *pl, unsigned int rate); /* from now */
+/* Gives the colors of the next frame, 1 if they differ from the colors of
+ * the previous one */
+int player_next(struct player *pl, int *upper_col, int *lower_col);
+
+#endif
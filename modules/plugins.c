@@ -0,0 +1,118 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File plugins.c
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#include <stdio.h> /* for fprintf */
+#include <string.h> /* for strcmp */
+#include <dlfcn.h> /* for dlopen, dlsym, dlclose */
+
+#include "plugins.h"
+
+/* The registry (BE CAREFUL: GLOBAL VARIABLES) */
+static void *handles[MAX_PLUGINS];
+static const struct qrgb_effect *effects[MAX_PLUGINS];
+static int plugin_cnt = 0;
+
+static int effect_is_valid(const struct qrgb_effect *eff, const char *path);
+
+/* Functions */
+int load_plugin(const char *path)
+{
+    void *handle;
+    qrgb_plugin_entry_fn entry;
+    const struct qrgb_effect *eff;
+    int i;
+
+    /* Resolve everything now: a missing symbol mustn't pop up mid-frame */
+    handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if(!handle) {
+        fprintf(stderr, PLUGIN_OPEN_ERR_MSG, dlerror());
+        return 1;
+    }
+    for(i = 0; i < plugin_cnt; i++) { /* every request may name it again */
+        if(handles[i] == handle) {
+            dlclose(handle);
+            return 0;
+        }
+    }
+    if(plugin_cnt >= MAX_PLUGINS) {
+        fprintf(stderr, PLUGIN_MAX_ERR_MSG, MAX_PLUGINS);
+        dlclose(handle);
+        return 1;
+    }
+    /* Casting through a union keeps ISO C quiet about object->function */
+    {
+        union { void *obj; qrgb_plugin_entry_fn fn; } sym;
+        sym.obj = dlsym(handle, QRGB_PLUGIN_ENTRY);
+        entry = sym.fn;
+    }
+    if(!entry) {
+        fprintf(stderr, PLUGIN_ENTRY_ERR_MSG, path);
+        dlclose(handle);
+        return 1;
+    }
+    eff = entry();
+    if(!effect_is_valid(eff, path)) {
+        dlclose(handle);
+        return 1;
+    }
+    handles[plugin_cnt] = handle;
+    effects[plugin_cnt] = eff;
+    plugin_cnt++;
+    return 0;
+}
+
+const struct qrgb_effect *find_plugin(const char *name)
+{
+    int i;
+    for(i = 0; i < plugin_cnt; i++) {
+        if(0 == strcmp(effects[i]->name, name))
+            return effects[i];
+    }
+    return NULL;
+}
+
+void unload_plugins(void)
+{
+    for(; plugin_cnt > 0; plugin_cnt--) {
+        dlclose(handles[plugin_cnt-1]);
+        effects[plugin_cnt-1] = NULL;
+    }
+}
+
+static int effect_is_valid(const struct qrgb_effect *eff, const char *path)
+{
+    /* The version goes first: the layout past it may differ */
+    if(eff && eff->abi_version != QRGB_PLUGIN_ABI_VERSION) {
+        fprintf(stderr, PLUGIN_ABI_ERR_MSG, path, eff->abi_version,
+                QRGB_PLUGIN_ABI_VERSION);
+        return 0;
+    }
+    if(!eff || !eff->name || !eff->count || !eff->fill) {
+        fprintf(stderr, PLUGIN_BAD_ERR_MSG, path);
+        return 0;
+    }
+    if(find_plugin(eff->name)) {
+        fprintf(stderr, PLUGIN_DUP_ERR_MSG, path, eff->name);
+        return 0;
+    }
+    return 1;
+}
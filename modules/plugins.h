@@ -0,0 +1,47 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File plugins.h
+ * Loads effect plugins (shared objects) with dlopen and keeps a registry
+ * of their effects, looked up by the mode name.
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#ifndef PLUGINS_SENTRY
+#define PLUGINS_SENTRY
+
+#include "locale_macros.h"
+#include "qrgb_plugin.h"
+
+/* Constants */
+#define MAX_PLUGINS 16
+
+/* Messages */
+#define PLUGIN_OPEN_ERR_MSG _("Couldn't load the plugin: %s\n")
+#define PLUGIN_ENTRY_ERR_MSG _("%s: no " QRGB_PLUGIN_ENTRY " symbol\n")
+#define PLUGIN_ABI_ERR_MSG _("%s: plugin ABI version %u, expected %u\n")
+#define PLUGIN_BAD_ERR_MSG _("%s: the plugin effect is incomplete\n")
+#define PLUGIN_DUP_ERR_MSG _("%s: mode %s is already loaded\n")
+#define PLUGIN_MAX_ERR_MSG _("Too many plugins, the limit is %d\n")
+
+/* Functions */
+int load_plugin(const char *path); /* 0 on success, message on failure */
+const struct qrgb_effect *find_plugin(const char *name);
+void unload_plugins(void);
+
+#endif
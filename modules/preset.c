@@ -0,0 +1,428 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File preset.c
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#include <stdio.h> /* for fopen, fgets, fprintf, snprintf, sprintf */
+#include <stdlib.h> /* for malloc, free, strtol */
+#include <string.h> /* for strtok, strchr, strrchr, strcpy, strerror */
+#include <errno.h> /* for errno */
+#include <unistd.h> /* for getcwd */
+
+#include "preset.h"
+#include "argparser.h" /* for parse_opts, check_modes, find_paths */
+#include "rgbmodes.h" /* for parse_colorscheme, check_colorscheme */
+#include "control.h" /* for ctl_check, CTL_MAX_REPLY */
+
+/* Constants */
+#define PROG_NAME "quadcastrgb"
+#define PRESET_SPACES " \t\r\n"
+#define FNV_OFFSET 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+/* The library (BE CAREFUL: GLOBAL VARIABLE) */
+static struct preset_lib *lib = NULL;
+
+static struct preset_lib *new_lib(const char *path, int budget_kib);
+static char *lib_dir(const char *path);
+static void free_lib(struct preset_lib *l);
+static int read_lib(struct preset_lib *l, FILE *f, const char *path);
+static int add_preset(struct preset_lib *l, const char *line,
+                      const char *path, int lineno);
+static int set_args(struct preset *p, const char **argv, const char *dir);
+static void check_args(int argc, const char **argv);
+static int reads_live(struct preset *p);
+static int hash_slot(const struct preset_lib *l, const char *name);
+static struct scene *build(struct preset *p, uint64_t dev_key);
+static void keep(struct preset *p, struct scene *sc);
+static void drop(struct preset *p);
+
+/* Functions */
+int preset_load(const char *path, int budget_kib)
+{
+    struct preset_lib *l;
+    FILE *f;
+    int err;
+    f = fopen(path, "r");
+    if(!f) {
+        fprintf(stderr, PRESET_OPEN_ERR_MSG, path, strerror(errno));
+        return 1;
+    }
+    l = new_lib(path, budget_kib);
+    err = read_lib(l, f, path);
+    fclose(f);
+    if(err) {
+        free_lib(l);
+        return 1;
+    }
+    preset_free(); /* a scene of it might be playing, it isn't freed then */
+    lib = l;
+    return 0;
+}
+
+void preset_free(void)
+{
+    free_lib(lib);
+    lib = NULL;
+}
+
+/* In the order of the file, none is given the room of another one. The
+ * ones reading a source would open it for nothing, they're left out */
+void preset_warm(uint64_t dev_key)
+{
+    struct scene *sc;
+    int i;
+    if(!lib)
+        return;
+    for(i = 0; i < lib->cnt; i++) {
+        if(lib->presets[i].sc || lib->presets[i].live)
+            continue;
+        sc = build(&lib->presets[i], dev_key);
+        if(sc && lib->kept + scene_size(sc) <= lib->budget)
+            keep(&lib->presets[i], sc);
+        free_scene(sc);
+    }
+}
+
+void preset_flush(void)
+{
+    int i;
+    if(!lib)
+        return;
+    for(i = 0; i < lib->cnt; i++)
+        drop(&lib->presets[i]);
+}
+
+/* A name first: a preset may be called 2 */
+int preset_find(const char *name)
+{
+    char *end;
+    long num;
+    int slot;
+    if(!lib) {
+        fprintf(stderr, PRESET_NOLIB_MSG);
+        return -1;
+    }
+    slot = hash_slot(lib, name);
+    if(lib->hash[slot] >= 0)
+        return lib->hash[slot];
+    num = strtol(name, &end, 10);
+    if(*name && !*end && num >= 1 && num <= lib->cnt)
+        return (int)num - 1;
+    fprintf(stderr, PRESET_UNKNOWN_MSG, name);
+    return -1;
+}
+
+const char *preset_name(int id)
+{
+    return lib->presets[id].name;
+}
+
+/* A kept scene that's playing can't be played once more from the start,
+ * another one is built then. A scene reading a source isn't kept: the
+ * source is closed when it stops playing */
+struct scene *preset_take(int id, uint64_t dev_key)
+{
+    struct preset *p = &lib->presets[id];
+    struct scene *sc;
+    lib->switches++;
+    p->used = lib->switches;
+    if(p->sc && p->sc->refs == 1) {
+        lib->hits++;
+        scene_rewind(p->sc);
+        return scene_hold(p->sc);
+    }
+    lib->misses++;
+    sc = build(p, dev_key);
+    if(sc && !p->sc && !p->live)
+        keep(p, sc);
+    return sc;
+}
+
+int preset_stats(char *buf, size_t len)
+{
+    int i, kept = 0;
+    if(!lib)
+        return 1;
+    for(i = 0; i < lib->cnt; i++)
+        kept += lib->presets[i].sc != NULL;
+    snprintf(buf, len, PRESET_STATS_MSG, lib->switches, lib->hits,
+             lib->misses, kept, (unsigned long)((lib->kept+1023)/1024),
+             (unsigned long)(lib->budget/1024));
+    return 0;
+}
+
+static struct preset_lib *new_lib(const char *path, int budget_kib)
+{
+    struct preset_lib *l = malloc(sizeof(*l));
+    int i;
+    l->cnt = 0;
+    for(i = 0; i < PRESET_HASH_SIZE; i++)
+        l->hash[i] = -1;
+    l->kept = 0;
+    l->budget = (size_t)budget_kib*1024;
+    l->switches = l->hits = l->misses = 0;
+    l->dir = lib_dir(path);
+    return l;
+}
+
+/* Absolute, the program doesn't stay in the directory it's started in;
+ * NULL if the working directory is unknown */
+static char *lib_dir(const char *path)
+{
+    const char *slash = strrchr(path, '/');
+    char cwd[PRESET_DIR_LEN], *dir;
+    int len = slash ? (int)(slash - path) : 0;
+    if(path[0] == '/')
+        cwd[0] = '\0';
+    else if(!getcwd(cwd, sizeof(cwd)))
+        return NULL;
+    dir = malloc(strlen(cwd) + len + 2);
+    if(!dir)
+        return NULL;
+    if(path[0] == '/')
+        sprintf(dir, "%.*s", len, path); /* the root is "", as it's joined */
+    else if(len)
+        sprintf(dir, "%s/%.*s", cwd, len, path);
+    else
+        strcpy(dir, cwd);
+    return dir;
+}
+
+static void free_lib(struct preset_lib *l)
+{
+    int i;
+    if(!l)
+        return;
+    for(i = 0; i < l->cnt; i++) {
+        free_scene(l->presets[i].sc);
+        free(l->presets[i].line);
+    }
+    free(l->dir);
+    free(l);
+}
+
+static int read_lib(struct preset_lib *l, FILE *f, const char *path)
+{
+    char line[PRESET_LINE_LEN], *p;
+    int lineno = 0, err = 0;
+    while(!err && fgets(line, sizeof(line), f)) {
+        lineno++;
+        if(!strchr(line, '\n') && !feof(f)) {
+            fprintf(stderr, PRESET_LONG_ERR_MSG, path, lineno);
+            return 1;
+        }
+        if((p = strchr(line, '#')))
+            *p = '\0';
+        err = add_preset(l, line, path, lineno);
+    }
+    if(!err && l->cnt == 0) {
+        fprintf(stderr, PRESET_EMPTY_ERR_MSG, path);
+        err = 1;
+    }
+    return err;
+}
+
+/* Checked as a request is, in a child, so a wrong one only tells why */
+static int add_preset(struct preset_lib *l, const char *line,
+                      const char *path, int lineno)
+{
+    struct preset *p;
+    char msg[CTL_MAX_REPLY], *copy, *name, *arg;
+    const char *argv[PRESET_MAX_ARGS+1];
+    int slot;
+    copy = malloc(strlen(line)+1);
+    strcpy(copy, line);
+    name = strtok(copy, PRESET_SPACES);
+    if(!name) { /* an empty line */
+        free(copy);
+        return 0;
+    }
+    if(l->cnt == PRESET_MAX) {
+        fprintf(stderr, PRESET_MANY_ERR_MSG, path, PRESET_MAX);
+        free(copy);
+        return 1;
+    }
+    p = &l->presets[l->cnt];
+    argv[0] = PROG_NAME;
+    for(p->argc = 1; (arg = strtok(NULL, PRESET_SPACES)); p->argc++) {
+        if(p->argc == PRESET_MAX_ARGS) {
+            fprintf(stderr, PRESET_LONG_ERR_MSG, path, lineno);
+            free(copy);
+            return 1;
+        }
+        argv[p->argc] = arg;
+    }
+    argv[p->argc] = NULL;
+    if(p->argc == 1 || strlen(name) >= PRESET_NAME_LEN) {
+        fprintf(stderr, PRESET_NAME_ERR_MSG, path, lineno);
+        free(copy);
+        return 1;
+    }
+    slot = hash_slot(l, name);
+    if(l->hash[slot] >= 0) {
+        fprintf(stderr, PRESET_TWICE_ERR_MSG, path, lineno, name);
+        free(copy);
+        return 1;
+    }
+    strcpy(p->name, name);
+    if(set_args(p, argv, l->dir)) {
+        fprintf(stderr, NOMEM_MSG);
+        free(copy);
+        return 1;
+    }
+    free(copy);
+    if(ctl_check(check_args, p->argc, p->argv, msg, sizeof(msg))) {
+        fprintf(stderr, PRESET_LINE_ERR_MSG, path, lineno, msg);
+        free(p->line);
+        return 1;
+    }
+    p->live = reads_live(p);
+    p->sc = NULL;
+    p->size = 0;
+    p->used = 0;
+    l->hash[slot] = l->cnt;
+    l->cnt++;
+    return 0;
+}
+
+/* The line holds them, the relative paths joined to the directory of the
+ * library: 0, or 1 if there's no memory */
+static int set_args(struct preset *p, const char **argv, const char *dir)
+{
+    char paths[PRESET_MAX_ARGS+1], *end;
+    size_t size = 1;
+    int i;
+    find_paths(p->argc, argv, paths);
+    for(i = 1; i < p->argc; i++) {
+        paths[i] = paths[i] && dir && argv[i][0] != '/';
+        size += strlen(argv[i])+1 + (paths[i] ? strlen(dir)+1 : 0);
+    }
+    p->line = malloc(size);
+    if(!p->line)
+        return 1;
+    end = p->line;
+    p->argv[0] = PROG_NAME;
+    for(i = 1; i < p->argc; i++) {
+        p->argv[i] = end;
+        if(paths[i])
+            end += sprintf(end, "%s/%s", dir, argv[i]) + 1;
+        else
+            end += sprintf(end, "%s", argv[i]) + 1;
+    }
+    p->argv[p->argc] = NULL;
+    return 0;
+}
+
+/* Exits as parse_arg does if the preset can't be played */
+static void check_args(int argc, const char **argv)
+{
+    struct colschemes *cs;
+    struct scene *sc;
+    int verbose = 0;
+    cs = parse_opts(argc, argv, &verbose);
+    if(cs->output || cs->presets || cs->preset) {
+        fprintf(stderr, PRESET_NESTED_MSG);
+        free(cs); exit(argerr);
+    }
+    if(cs->image) {
+        sc = load_scene(cs->image);
+        if(!sc) {
+            free(cs); exit(argerr);
+        }
+        free_scene(sc);
+    } else {
+        check_modes(cs);
+        if(check_colorscheme(cs)) {
+            free(cs); exit(NOSUPPORT_EXIT);
+        }
+    }
+    free(cs);
+}
+
+/* The options are checked already, parsing them can't fail */
+static int reads_live(struct preset *p)
+{
+    struct colschemes *cs;
+    int live, verbose = 0;
+    cs = parse_opts(p->argc, p->argv, &verbose);
+    live = !cs->image && reads_source(cs);
+    free(cs);
+    return live;
+}
+
+/* The slot of the name, or the free one it would take */
+static int hash_slot(const struct preset_lib *l, const char *name)
+{
+    uint64_t hash = FNV_OFFSET;
+    const unsigned char *c;
+    int slot;
+    for(c = (const unsigned char *)name; *c; c++) {
+        hash ^= *c;
+        hash *= FNV_PRIME;
+    }
+    for(slot = (int)(hash & (PRESET_HASH_SIZE-1)); l->hash[slot] >= 0;
+                                   slot = (slot+1) & (PRESET_HASH_SIZE-1)) {
+        if(strequ(l->presets[l->hash[slot]].name, name))
+            break;
+    }
+    return slot;
+}
+
+/* Only the scene: the playback options of a preset don't count */
+static struct scene *build(struct preset *p, uint64_t dev_key)
+{
+    struct colschemes *cs;
+    struct scene *sc;
+    int verbose = 0;
+    cs = parse_opts(p->argc, p->argv, &verbose);
+    sc = cs->image ? load_scene(cs->image) : parse_colorscheme(cs, dev_key);
+    free(cs);
+    return sc;
+}
+
+/* The ones switched to the longest ago make room for it */
+static void keep(struct preset *p, struct scene *sc)
+{
+    size_t size = scene_size(sc);
+    int i, lru;
+    if(size > lib->budget)
+        return;
+    while(lib->kept + size > lib->budget) {
+        lru = -1;
+        for(i = 0; i < lib->cnt; i++) {
+            if(lib->presets[i].sc && (lru < 0 ||
+                          lib->presets[i].used < lib->presets[lru].used))
+                lru = i;
+        }
+        drop(&lib->presets[lru]);
+    }
+    p->sc = scene_hold(sc);
+    p->size = size;
+    lib->kept += size;
+}
+
+static void drop(struct preset *p)
+{
+    free_scene(p->sc); /* a playing one stays until it's over */
+    p->sc = NULL;
+    lib->kept -= p->size;
+    p->size = 0;
+}
@@ -0,0 +1,94 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File preset.h
+ * A library of presets, named scenes to switch between while running.
+ * A line of the library file is a name and the arguments of a scene as
+ * quadcastrgb takes them, split by spaces; # starts a comment. The paths
+ * in them are relative to the directory of the file.
+ * The built scenes are kept while they fit into the memory budget, the
+ * one switched to the longest ago goes first. A switch to a kept scene
+ * only rewinds it: nothing is parsed or built again.
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#ifndef PRESET_SENTRY
+#define PRESET_SENTRY
+
+#include <stddef.h> /* for size_t */
+#include <stdint.h> /* for uint64_t */
+#include "locale_macros.h"
+#include "scene.h" /* for struct scene */
+
+/* Constants */
+#define PRESET_MAX 64
+#define PRESET_NAME_LEN 32
+#define PRESET_LINE_LEN 1024
+#define PRESET_MAX_ARGS 64
+#define PRESET_DIR_LEN 4096
+#define PRESET_HASH_SIZE 128 /* a power of 2, twice PRESET_MAX at least */
+
+/* Messages */
+#define PRESET_OPEN_ERR_MSG _("Couldn't read the presets: %s: %s\n")
+#define PRESET_LINE_ERR_MSG _("%s:%d: %s")
+#define PRESET_NAME_ERR_MSG _("%s:%d: expected a name and the arguments " \
+                              "of a scene\n")
+#define PRESET_LONG_ERR_MSG _("%s:%d: the line is too long\n")
+#define PRESET_TWICE_ERR_MSG _("%s:%d: preset %s is given twice\n")
+#define PRESET_MANY_ERR_MSG _("%s: more than %d presets\n")
+#define PRESET_EMPTY_ERR_MSG _("%s: no presets\n")
+#define PRESET_NESTED_MSG _("A preset can't load presets or write a file\n")
+#define PRESET_UNKNOWN_MSG _("No preset %s\n")
+#define PRESET_NOLIB_MSG _("No presets are loaded, see --presets\n")
+#define PRESET_STATS_MSG _("Presets: %lu switches, %lu to kept scenes, " \
+                           "%lu built; %d kept in %lu of %lu KiB\n")
+
+/* Structs */
+struct preset {
+    char name[PRESET_NAME_LEN];
+    char *line; /* the arguments are in it, owned */
+    int argc; /* argv[0] is the program name, like in main */
+    const char *argv[PRESET_MAX_ARGS+1];
+    struct scene *sc; /* kept, NULL if not */
+    int live; /* reads a source, built only when switched to, never kept */
+    size_t size; /* of the scene kept */
+    unsigned long used; /* the switch to it was the n-th one */
+};
+
+struct preset_lib {
+    struct preset presets[PRESET_MAX];
+    int cnt;
+    short hash[PRESET_HASH_SIZE]; /* of the names, -1 if the slot is free */
+    char *dir; /* of the file, absolute; NULL if unknown */
+    size_t kept, budget; /* bytes */
+    unsigned long switches, hits, misses;
+};
+
+/* Functions */
+/* 0, or message and the loaded library stays. Checks every preset */
+int preset_load(const char *path, int budget_kib);
+void preset_free(void);
+void preset_warm(uint64_t dev_key); /* builds them while they fit */
+void preset_flush(void); /* the files might have changed */
+int preset_find(const char *name); /* or its number from 1; -1 & message */
+const char *preset_name(int id);
+/* Ready to play from the start, the caller owns it; NULL & message */
+struct scene *preset_take(int id, uint64_t dev_key);
+int preset_stats(char *buf, size_t len); /* 1 if there's no library */
+
+#endif
@@ -0,0 +1,57 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File prng.c
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#include "prng.h"
+
+/* Constants */
+#define PCG_MULTIPLIER 6364136223846793005ULL
+
+/* Functions */
+void pcg32_seed(struct pcg32 *rng, uint64_t seed, uint64_t stream)
+{
+    /* The reference initialization: step, add the seed, step again */
+    rng->state = 0;
+    rng->inc = (stream << 1) | 1;
+    pcg32_next(rng);
+    rng->state += seed;
+    pcg32_next(rng);
+}
+
+uint32_t pcg32_next(struct pcg32 *rng)
+{
+    uint64_t old = rng->state;
+    uint32_t xorshifted, rot;
+    rng->state = old*PCG_MULTIPLIER + rng->inc;
+    xorshifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+    rot = (uint32_t)(old >> 59);
+    return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+}
+
+uint32_t pcg32_bounded(struct pcg32 *rng, uint32_t bound)
+{
+    /* Values below the threshold would make the lower numbers likelier */
+    uint32_t r, threshold = -bound % bound;
+    do {
+        r = pcg32_next(rng);
+    } while(r < threshold);
+    return r % bound;
+}
@@ -0,0 +1,42 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File prng.h
+ * A small pseudorandom number generator (PCG32, XSH RR variant).
+ * The state is two 64-bit numbers, so every diode group, layer and device
+ * gets its own independent stream from the same seed.
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#ifndef PRNG_SENTRY
+#define PRNG_SENTRY
+
+#include <stdint.h> /* for uint64_t, uint32_t */
+
+/* Structs */
+struct pcg32 {
+    uint64_t state;
+    uint64_t inc; /* the stream, always odd */
+};
+
+/* Functions */
+void pcg32_seed(struct pcg32 *rng, uint64_t seed, uint64_t stream);
+uint32_t pcg32_next(struct pcg32 *rng);
+uint32_t pcg32_bounded(struct pcg32 *rng, uint32_t bound); /* [0; bound) */
+
+#endif
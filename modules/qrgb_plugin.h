@@ -0,0 +1,63 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File qrgb_plugin.h
+ * The ABI between quadcastrgb and effect plugins.
+ * A plugin is a shared object exporting QRGB_PLUGIN_ENTRY, a function
+ * returning the description of one effect. The effect follows the same
+ * contract as the built-in modes: first it tells how many frames it
+ * needs, then it generates exactly that many frames.
+ * This header must stay self-contained: plugins are built against it
+ * alone.
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#ifndef QRGB_PLUGIN_SENTRY
+#define QRGB_PLUGIN_SENTRY
+
+/* Constants */
+#define QRGB_PLUGIN_ABI_VERSION 1 /* bump on any change of the structs */
+#define QRGB_PLUGIN_ENTRY "qrgb_plugin_entry"
+#define QRGB_NOCOLOR (-1) /* terminates the color array */
+#define QRGB_MAX_FRAMES 720 /* longer sequences are cut */
+
+enum qrgb_group { qrgb_upper = 1, qrgb_lower }; /* the same as diode_group */
+
+/* Structs */
+struct qrgb_effect_params {
+    const int *colors; /* 0xRRGGBB ended by QRGB_NOCOLOR, fill gets them
+                        * with the brightness already applied */
+    int spd; /* 0-100 */
+    int dly; /* 0-100 */
+    int group; /* enum qrgb_group */
+};
+
+struct qrgb_effect {
+    unsigned int abi_version; /* must be QRGB_PLUGIN_ABI_VERSION */
+    const char *name; /* the mode name on the command line */
+    /* Returns the number of frames, 0 if the parameters are unsupported */
+    unsigned int (*count)(const struct qrgb_effect_params *p);
+    /* Writes cnt frames as 0xRRGGBB, cnt is what count has returned */
+    void (*fill)(const struct qrgb_effect_params *p, int *frames,
+                 unsigned int cnt);
+};
+
+/* The only symbol looked up in a plugin */
+typedef const struct qrgb_effect *(*qrgb_plugin_entry_fn)(void);
+
+#endif
@@ -0,0 +1,85 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File qrgb_shm.h
+ * The layout of the shared memory the shm mode takes its frames from.
+ * Another program (the producer) writes the colors into a POSIX shared
+ * memory object, the running quadcastrgb (the reader) takes one frame
+ * right before every frame it sends: no system call per frame on either
+ * side. Either side may create the object, sizeof(struct qrgb_shm) bytes
+ * filled with zeros; the producer fills in the header and sets the magic
+ * last, the reader shows black until then.
+ *
+ * Latest-wins (qrgb_shm_latest), a seqlock: the producer makes seq odd,
+ * writes the frame and makes seq even again. The reader takes the frame
+ * if seq was even and the same before and after the copy. The frames
+ * written between two sent ones are skipped.
+ * Queued (qrgb_shm_queued), a single-producer single-consumer ring: the
+ * producer writes ring[head % QRGB_SHM_SLOTS] while head - tail is less
+ * than QRGB_SHM_SLOTS and then advances head, the reader takes one frame
+ * per frame it sends and advances tail. No frame is skipped, the producer
+ * waits for room instead.
+ * Only the producer writes seq, head and the frames, only the reader
+ * writes tail. The indices are free-running 32-bit counters.
+ *
+ * This header must stay self-contained: producers are built against it
+ * alone.
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#ifndef QRGB_SHM_SENTRY
+#define QRGB_SHM_SENTRY
+
+#include <stdint.h> /* for uint32_t */
+
+/* Constants */
+#define QRGB_SHM_MAGIC 0x51524753U /* "QRGS" */
+#define QRGB_SHM_VERSION 1 /* bump on any change of the layout */
+#define QRGB_SHM_SLOTS 64 /* frames of the ring, a power of two */
+
+enum qrgb_shm_mode { qrgb_shm_latest, qrgb_shm_queued };
+
+/* The shared fields are accessed atomically, GCC and Clang builtins */
+#define QRGB_SHM_ACQUIRE(P) __atomic_load_n((P), __ATOMIC_ACQUIRE)
+#define QRGB_SHM_RELEASE(P, V) __atomic_store_n((P), (V), __ATOMIC_RELEASE)
+#define QRGB_SHM_READ(P) __atomic_load_n((P), __ATOMIC_RELAXED)
+#define QRGB_SHM_WRITE(P, V) __atomic_store_n((P), (V), __ATOMIC_RELAXED)
+#define QRGB_SHM_FENCE_ACQUIRE() __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#define QRGB_SHM_FENCE_RELEASE() __atomic_thread_fence(__ATOMIC_RELEASE)
+
+/* Structs */
+struct qrgb_shm_frame {
+    uint32_t upper, lower; /* 0xRRGGBB */
+};
+
+struct qrgb_shm {
+    /* The header */
+    uint32_t magic; /* QRGB_SHM_MAGIC once the rest is filled in */
+    uint32_t version; /* QRGB_SHM_VERSION */
+    uint32_t mode; /* enum qrgb_shm_mode */
+    uint32_t slots; /* QRGB_SHM_SLOTS */
+    /* Latest-wins */
+    uint32_t seq; /* odd while the frame is written */
+    struct qrgb_shm_frame latest;
+    /* Queued, on cache lines of their own: each is written by one side */
+    uint32_t head __attribute__((aligned(64))); /* the frames written */
+    uint32_t tail __attribute__((aligned(64))); /* the frames taken */
+    struct qrgb_shm_frame ring[QRGB_SHM_SLOTS] __attribute__((aligned(64)));
+};
+
+#endif
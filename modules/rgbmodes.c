@@ -25,37 +25,67 @@
  */
 #include "rgbmodes.h"
 
-static int count_data(struct colscheme *colsch);
-static void fill_data(struct colscheme *colsch, byte_t *da, int pckcnt,
-                      int group);
-static void equalize(int upper_size, int lower_size, datpack *da);
-static void fillup_to(size_t copy_size, byte_t *curr, byte_t *finish);
+/* Structs */
+struct blink_gen { /* makes endless random blinking */
+    struct seqgen gen;
+    struct pcg32 rng;
+    int col_seg, dly_seg;
+};
+
+static int count_group(struct colschemes *cs, int group);
+static int fill_group(struct colschemes *cs, int group, uint64_t dev_key,
+                      struct compositor *comp, struct compositor *twin,
+                      const long *phases);
+static void find_twins(struct colschemes *cs, long *phases);
+static int same_layer(const struct colscheme *a, const struct colscheme *b);
+static long twin_phase(const struct colscheme *colsch, int phase);
+static int group_layers(struct colschemes *cs, int group,
+                        struct colscheme **layers);
+static int count_data(struct colscheme *colsch, int group);
+static int fill_data(struct colscheme *colsch, struct sequence *seq,
+                     int group, const struct pcg32 *rng);
 static void set_brightness(int *color, int br);
+static int scale_color(int color, int br);
 
 /* Solid */
-static void sequence_solid(const int *colors, byte_t *da);
+static void sequence_solid(const int *colors, struct sequence *seq);
 /* Blink */
 static unsigned int count_blink_data(struct colscheme *colsch);
-static void sequence_blink_random(int speed, int dly_seg, byte_t *da);
-static void sequence_blink(const struct colscheme *colsch, byte_t *da,
-                           int pckcnt);
-static void blink_segment_fill(int col, int col_seg, int dly_seg, byte_t **da);
-static void color_fill(int color, int size, byte_t **da);
-static int random_color();
+static int sequence_blink_random(int speed, int dly_seg,
+                                 const struct pcg32 *rng,
+                                 struct sequence *seq);
+static void blink_random_next(struct seqgen *gen, struct sequence *seq);
+static void sequence_blink(const struct colscheme *colsch,
+                           struct sequence *seq);
+static void blink_segment_fill(int col, int col_seg, int dly_seg,
+                               struct sequence *seq);
+static int random_color(struct pcg32 *rng);
 /* Cycle */
 static unsigned int count_cycle_data(struct colscheme *colsch);
 static int get_gradient_length(const int *color, int spd);
-static void sequence_cycle(const int *color, int spd, byte_t *da);
-static void write_gradient(byte_t **da, int start_col, int end_col,
-                           int length);
+static void sequence_cycle(const int *color, int spd, struct sequence *seq);
 /* Wave */
-static void sequence_wave(int *color, int spd, int group, byte_t *da);
+static void sequence_wave(int *color, int spd, int group,
+                          struct sequence *seq);
 static void wave_array_shift(int *color);
 /* Lightning & Pulse */
 static unsigned int count_lightning_data(struct colscheme *colsch);
 static void sequence_lightning(const int *color, int spd, int group,
-                               int synchronous, byte_t *da);
+                               int synchronous, struct sequence *seq);
+static void lightning_flash(int color, unsigned int up, unsigned int down,
+                            struct sequence *seq);
 static int next_gradient_color(int color, int endcolor, unsigned int size);
+static void sequence_beat_flashes(const int *color, int spd,
+                                  struct sequence *seq);
+/* Plugins */
+static void sequence_keyframes(const struct colscheme *colsch, int group,
+                               struct sequence *seq);
+static unsigned int count_plugin_data(const struct qrgb_effect *eff,
+                                      const struct colscheme *colsch,
+                                      int group);
+static int sequence_plugin(const struct qrgb_effect *eff,
+                           const struct colscheme *colsch, int group,
+                           struct sequence *seq);
 
 /* Shared */
 static void write_hexcolor(int color, byte_t *mem);
@@ -63,53 +93,207 @@ static unsigned int colarr_len(const int *arr);
 static unsigned int sizeof_frames(int *color, unsigned int framesize);
 
 #ifdef DEBUG
-static void print_datpack(datpack *da, int pck_cnt);
+static void print_scene(const struct scene *sc);
+static void print_group(const struct compositor *comp);
 #endif
 
-datpack *parse_colorscheme(struct colschemes *cs, int *pck_cnt)
+/* The sources opened for the scene are closed if it can't be made */
+int check_colorscheme(struct colschemes *cs)
 {
-    datpack *data_arr;
     int seq_upper, seq_lower;
-
-    seq_upper = count_data(&cs->upper);
-    seq_lower = count_data(&cs->lower);
+    seq_upper = count_group(cs, upper);
+    seq_lower = seq_upper < 1 ? seq_upper : count_group(cs, lower);
     if(seq_upper < 1 || seq_lower < 1) {
-        fprintf(stderr, NOSUPPORT_MSG);
-        free(cs); exit(254);
+        if(seq_upper < 0 || seq_lower < 0) /* else it's already printed */
+            fprintf(stderr, NOSUPPORT_MSG);
+        vis_close();
+        ingress_close();
+        orgb_close();
+        return 1;
     }
+    return 0;
+}
 
-    *pck_cnt = seq_upper >= seq_lower ? seq_upper : seq_lower;
-    data_arr = calloc(sizeof(datpack), *pck_cnt);
+int reads_source(struct colschemes *cs)
+{
+    struct colscheme *layers[MAX_LAYERS];
+    const char *mode;
+    int group, i, cnt;
+    for(group = upper; group <= lower; group++) {
+        cnt = group_layers(cs, group, layers);
+        for(i = 0; i < cnt; i++) {
+            mode = layers[i]->mode;
+            if(mode && (strequ(mode, "visualizer") || strequ(mode, "beat") ||
+                        strequ(mode, "shm") || strequ(mode, "openrgb")))
+                return 1;
+        }
+    }
+    return 0;
+}
 
-    fill_data(&cs->upper, *data_arr, *pck_cnt, upper);
-    fill_data(&cs->lower, *data_arr+BYTE_STEP, *pck_cnt, lower);
-    equalize(seq_upper, seq_lower, data_arr);
+int reads_stdin(struct colschemes *cs)
+{
+    struct colscheme *layers[MAX_LAYERS];
+    const char *mode;
+    int group, i, cnt;
+    for(group = upper; group <= lower; group++) {
+        cnt = group_layers(cs, group, layers);
+        for(i = 0; i < cnt; i++) {
+            mode = layers[i]->mode;
+            if(mode && (strequ(mode, "visualizer") || strequ(mode, "beat")) &&
+               layers[i]->file && strequ(layers[i]->file, "-"))
+                return 1;
+        }
+    }
+    return 0;
+}
+
+struct scene *parse_colorscheme(struct colschemes *cs, uint64_t dev_key)
+{
+    struct scene *sc;
+    long phases[MAX_LAYERS];
+
+    if(check_colorscheme(cs))
+        return NULL;
+    find_twins(cs, phases); /* before the filling changes the colors */
+    sc = scene_new();
+    if(fill_group(cs, upper, dev_key, &sc->upper, NULL, NULL) ||
+       fill_group(cs, lower, dev_key, &sc->lower, &sc->upper, phases)) {
+        free_scene(sc); /* the generators let their sources go */
+        vis_close();
+        ingress_close();
+        orgb_close();
+        return NULL;
+    }
+    scene_set_len(sc);
 
     #ifdef DEBUG
-    print_datpack(data_arr, *pck_cnt);
+    print_scene(sc);
     #endif
 
-    return data_arr;
+    return sc;
+}
+
+void pack_colpair(int upper_col, int lower_col, byte_t *cmd)
+{
+    *cmd = RGB_CODE;
+    write_hexcolor(upper_col, cmd+1);
+    *(cmd+BYTE_STEP) = RGB_CODE;
+    write_hexcolor(lower_col, cmd+BYTE_STEP+1);
 }
 
-short count_color_commands(const datpack *data_arr, int pck_cnt, int colgroup)
+/* Validates every layer of a group, returns the longest one */
+static int count_group(struct colschemes *cs, int group)
 {
-    short cnt, step = 0;
-    const byte_t *b;
-    if(colgroup) /* case of lower color commands */
-        step = BYTE_STEP;
-    cnt = (pck_cnt-1)*8;
-    for(b = data_arr[pck_cnt-1]; b < data_arr[pck_cnt-1]+DATA_PACKET_SIZE;
-                                                         b += 2*BYTE_STEP) {
-        if(*(b+step) != RGB_CODE)
-            break;
-        cnt++;
+    struct colscheme *layers[MAX_LAYERS];
+    int i, cnt, size, max = 0;
+    cnt = group_layers(cs, group, layers);
+    for(i = 0; i < cnt; i++) {
+        size = count_data(layers[i], group);
+        if(size < 1)
+            return size;
+        if(size > max)
+            max = size;
     }
-    return cnt;
+    return max;
+}
+
+/* Every layer of every group of every device has its own random stream */
+static int fill_group(struct colschemes *cs, int group, uint64_t dev_key,
+                      struct compositor *comp, struct compositor *twin,
+                      const long *phases)
+{
+    struct colscheme *layers[MAX_LAYERS];
+    int i, cnt;
+    cnt = group_layers(cs, group, layers);
+    for(i = 0; i < cnt; i++) {
+        struct sequence seq;
+        struct pcg32 rng;
+        pcg32_seed(&rng, cs->seed,
+                   dev_key*(MAX_LAYERS*3) + group*MAX_LAYERS + i);
+        seq_init(&seq);
+        if(twin && phases[i] >= 0 && i < twin->cnt) {
+            seq_view(&seq, &twin->layers[i].seq, phases[i]);
+        } else if(fill_data(layers[i], &seq, group, &rng)) {
+            seq_free(&seq);
+            return 1;
+        }
+        compositor_add(comp, &seq, layers[i]->blend, layers[i]->alpha);
+    }
+    return 0;
+}
+
+/* A lower layer that is the same as the upper one under it plays the
+ * upper one's frames from its phase: phases[i] of the layer, -1 if not */
+static void find_twins(struct colschemes *cs, long *phases)
+{
+    struct colscheme *up[MAX_LAYERS], *low[MAX_LAYERS];
+    int i, up_cnt, low_cnt;
+    up_cnt = group_layers(cs, upper, up);
+    low_cnt = group_layers(cs, lower, low);
+    for(i = 0; i < low_cnt; i++) {
+        phases[i] = -1;
+        if(i < up_cnt && same_layer(up[i], low[i]))
+            phases[i] = twin_phase(low[i], cs->phase);
+    }
+}
+
+static int same_layer(const struct colscheme *a, const struct colscheme *b)
+{
+    int i;
+    if(!strequ(a->mode, b->mode) || a->br != b->br || a->spd != b->spd ||
+       a->dly != b->dly || a->file || b->file)
+        return 0;
+    for(i = 0; a->colors[i] != nocolor || b->colors[i] != nocolor; i++) {
+        if(a->colors[i] != b->colors[i])
+            return 0;
+    }
+    return 1;
 }
 
-static int count_data(struct colscheme *colsch)
+/* In frames: the lower group is that much ahead; -1 if the mode differs
+ * between the groups in other ways */
+static long twin_phase(const struct colscheme *colsch, int phase)
 {
+    long per_color, cnt = colarr_len(colsch->colors), own;
+    if(strequ(colsch->mode, "cycle") || strequ(colsch->mode, "wave")) {
+        per_color = get_gradient_length(colsch->colors, colsch->spd);
+        own = strequ(colsch->mode, "wave") ? per_color : 0;
+    } else if(strequ(colsch->mode, "lightning") ||
+              strequ(colsch->mode, "pulse")) {
+        long bl_size = SPEED_RANGE(MIN_LGHT_BL, MAX_LGHT_BL, colsch->spd);
+        per_color = bl_size +
+                    SPEED_RANGE(MIN_LGHT_UP, MAX_LGHT_UP, colsch->spd) +
+                    SPEED_RANGE(MIN_LGHT_DOWN, MAX_LGHT_DOWN, colsch->spd);
+        /* Lightning: the lower flash comes after the upper one's pause */
+        own = strequ(colsch->mode, "pulse") ? 0 : per_color*cnt - bl_size;
+    } else {
+        return -1;
+    }
+    return phase < 0 ? own : per_color*phase/100;
+}
+
+static int group_layers(struct colschemes *cs, int group,
+                        struct colscheme **layers)
+{
+    int i, ovl_cnt;
+    struct colscheme *ovl;
+    layers[0] = (group == upper) ? &cs->upper : &cs->lower;
+    ovl = (group == upper) ? cs->upper_ovl : cs->lower_ovl;
+    ovl_cnt = (group == upper) ? cs->upper_ovl_cnt : cs->lower_ovl_cnt;
+    for(i = 0; i < ovl_cnt; i++)
+        layers[i+1] = &ovl[i];
+    return ovl_cnt+1;
+}
+
+/* Returns the number of frames, the colors that don't fit are dropped.
+ * -1 for an unknown mode or parameters a plugin doesn't support, 0 if the
+ * mode has printed the reason itself */
+static int count_data(struct colscheme *colsch, int group)
+{
+    const struct qrgb_effect *eff;
+    struct timeline tl;
+    unsigned int size;
     if(strequ(colsch->mode, "solid")) {
         return 1;
     } else if(strequ(colsch->mode, "blink")) {
@@ -119,6 +303,23 @@ static int count_data(struct colscheme *colsch)
     } else if(strequ(colsch->mode, "lightning") ||
               strequ(colsch->mode, "pulse")) {
         return count_lightning_data(colsch);
+    } else if(strequ(colsch->mode, "visualizer") ||
+              strequ(colsch->mode, "beat")) {
+        return vis_open(colsch->file) ? 0 : MAX_COLPAIR_COUNT; /* endless */
+    } else if(strequ(colsch->mode, "shm")) {
+        return ingress_open(colsch->file) ? 0 : MAX_COLPAIR_COUNT;
+    } else if(strequ(colsch->mode, "openrgb")) {
+        return orgb_open(colsch->file) ? 0 : MAX_COLPAIR_COUNT;
+    } else if(strequ(colsch->mode, "keyframes")) {
+        unsigned int len;
+        if(load_timeline(colsch->file, group, &tl))
+            return 0;
+        len = timeline_length(&tl);
+        free_timeline(&tl);
+        return len;
+    } else if((eff = find_plugin(colsch->mode))) {
+        size = count_plugin_data(eff, colsch, group); /* it can't tell why */
+        return size ? (int)size : -1;
     } else {
         return -1;
     }
@@ -126,16 +327,13 @@ static int count_data(struct colscheme *colsch)
 
 static unsigned int count_blink_data(struct colscheme *colsch)
 {
-    unsigned int frame, size = 0;
+    unsigned int frame;
 
-    if(colsch->colors[0] == nocolor) { /* case of random colors */
-        srand(time(NULL)); /* random seed (must be done only once) */
-        return MAX_PCT_COUNT;
-    }
+    if(colsch->colors[0] == nocolor) /* random colors, endless actually */
+        return MAX_COLPAIR_COUNT;
 
     frame = 101-colsch->spd + colsch->dly;
-    size = sizeof_frames(colsch->colors, frame);
-    return DIV_CEIL(size, COLPAIR_PER_PCT);
+    return sizeof_frames(colsch->colors, frame);
 }
 
 static unsigned int count_cycle_data(struct colscheme *colsch)
@@ -146,18 +344,17 @@ static unsigned int count_cycle_data(struct colscheme *colsch)
     /* The size of all colpairs: */
     size *= colarr_len(colsch->colors); 
     if(size > MAX_COLPAIR_COUNT) /* case of overflow */
-        return MAX_PCT_COUNT;
-    return DIV_CEIL(size, COLPAIR_PER_PCT);
+        return MAX_COLPAIR_COUNT;
+    return size;
 }
 
 static unsigned int count_lightning_data(struct colscheme *colsch)
 {
-    unsigned int frame, size = 0;
+    unsigned int frame;
     frame = SPEED_RANGE(MIN_LGHT_BL, MAX_LGHT_BL, colsch->spd) +
             SPEED_RANGE(MIN_LGHT_UP, MAX_LGHT_UP, colsch->spd) +
             SPEED_RANGE(MIN_LGHT_DOWN, MAX_LGHT_DOWN, colsch->spd);
-    size = sizeof_frames(colsch->colors, frame);
-    return DIV_CEIL(size, COLPAIR_PER_PCT);
+    return sizeof_frames(colsch->colors, frame);
 }
 
 static unsigned int sizeof_frames(int *color, unsigned int framesize)
@@ -177,106 +374,114 @@ static unsigned int colarr_len(const int *arr)
     return cnt;
 }
 
-static void fill_data(struct colscheme *colsch, byte_t *da, int pckcnt,
-                      int group)
+/* 1 if there's no memory for it */
+static int fill_data(struct colscheme *colsch, struct sequence *seq,
+                     int group, const struct pcg32 *rng)
 {
+    const struct qrgb_effect *eff;
     set_brightness(colsch->colors, colsch->br);
     if(strequ(colsch->mode, "solid")) {
-        sequence_solid(colsch->colors, da);
+        sequence_solid(colsch->colors, seq);
     } else if(strequ(colsch->mode, "blink")) {
         if(colsch->colors[0] == nocolor)
-            sequence_blink_random(colsch->spd, colsch->dly, da);
+            return sequence_blink_random(colsch->spd, colsch->dly, rng, seq);
         else
-            sequence_blink(colsch, da, pckcnt);
+            sequence_blink(colsch, seq);
     } else if(strequ(colsch->mode, "cycle")) {
-        sequence_cycle(colsch->colors, colsch->spd, da);
+        sequence_cycle(colsch->colors, colsch->spd, seq);
     } else if(strequ(colsch->mode, "wave")) {
-        sequence_wave(colsch->colors, colsch->spd, group, da);
+        sequence_wave(colsch->colors, colsch->spd, group, seq);
     } else if(strequ(colsch->mode, "lightning")) {
-        sequence_lightning(colsch->colors, colsch->spd, group, 0, da);
+        sequence_lightning(colsch->colors, colsch->spd, group, 0, seq);
     } else if(strequ(colsch->mode, "pulse")) {
-        sequence_lightning(colsch->colors, colsch->spd, group, 1, da);
+        sequence_lightning(colsch->colors, colsch->spd, group, 1, seq);
+    } else if(strequ(colsch->mode, "visualizer")) {
+        sequence_visualizer(colsch->colors, colsch->spd, group, seq);
+    } else if(strequ(colsch->mode, "beat")) {
+        sequence_beat_flashes(colsch->colors, colsch->spd, seq);
+    } else if(strequ(colsch->mode, "keyframes")) {
+        sequence_keyframes(colsch, group, seq);
+    } else if(strequ(colsch->mode, "shm")) {
+        sequence_ingress(group, seq);
+    } else if(strequ(colsch->mode, "openrgb")) {
+        sequence_openrgb(group, seq);
+    } else if((eff = find_plugin(colsch->mode))) {
+        return sequence_plugin(eff, colsch, group, seq);
     }
+    return 0;
 }
 
 static void set_brightness(int *color, int br) 
 {
-    for(; color && *color != nocolor; color++) {
-        int i, shift;
-        byte_t rgb[3];
-        for(shift = 16, i = 0; i < 3; shift -= 8, i++) {
-            rgb[i] = (byte_t)((*color >> shift) & 0xff);
-            rgb[i] = rgb[i]*br/100;
-        }
-        *color = (rgb[0] << 16) + (rgb[1] << 8) + rgb[2];
-    }
-}
-
-static void equalize(int upper_size, int lower_size, datpack *da)
-{
-    enum { upper = 0, lower };
-    byte_t *upper_end, *lower_end;
-    upper_size = count_color_commands(da, upper_size, upper);
-    lower_size = count_color_commands(da, lower_size, lower);
-    upper_end = *da + 2*BYTE_STEP*(upper_size-1);
-    lower_end = *da + 2*BYTE_STEP*(lower_size-1) + BYTE_STEP;
-
-    if(upper_size < lower_size) {
-        fillup_to(upper_size, upper_end+2*BYTE_STEP, lower_end-BYTE_STEP);
-    } else if(lower_size < upper_size) {
-        fillup_to(lower_size, lower_end+2*BYTE_STEP, upper_end+BYTE_STEP);
-    } /* else equalizing isn't needed */
+    for(; color && *color != nocolor; color++)
+        *color = scale_color(*color, br);
 }
 
-static void fillup_to(size_t copy_size, byte_t *curr, byte_t *finish)
+static int scale_color(int color, int br)
 {
-    while(curr <= finish) {
-        memcpy(curr, curr-(2*BYTE_STEP*copy_size), BYTE_STEP);
-        curr += 2*BYTE_STEP;
+    int i, shift;
+    byte_t rgb[3];
+    for(shift = 16, i = 0; i < 3; shift -= 8, i++) {
+        rgb[i] = (byte_t)((color >> shift) & 0xff);
+        rgb[i] = rgb[i]*br/100;
     }
+    return (rgb[0] << 16) + (rgb[1] << 8) + rgb[2];
 }
 
 /* Mode-related functions */
-static void sequence_solid(const int *colors, byte_t *da)
+static void sequence_solid(const int *colors, struct sequence *seq)
 {
-    *da = RGB_CODE; /* write code to the first byte */
-    write_hexcolor(*colors, da+1); /* write RGB */
+    seq_run(seq, *colors, 1);
 }
 
-static void sequence_blink_random(int speed, int delay, byte_t *da)
+/* Random colors never repeat: one color & its delay are made at a time */
+static int sequence_blink_random(int speed, int delay,
+                                 const struct pcg32 *rng,
+                                 struct sequence *seq)
 {
-    int colpair = 0;
-    int col_seg, dly_seg;
+    struct blink_gen *bg = malloc(sizeof(*bg));
 
-    col_seg = RAND_COL_SEG_MIN +
-              (int)(speed * (RAND_COL_SEG_MAX-RAND_COL_SEG_MIN)) / MAX_SPD;
-    dly_seg = RAND_DLY_SEG_MIN +
-              (int)(delay * (RAND_DLY_SEG_MAX-RAND_DLY_SEG_MIN)) / MAX_DLY;
-     
-    while(colpair < MAX_COLPAIR_COUNT) {
-        colpair += col_seg + dly_seg;
-        if(colpair > MAX_COLPAIR_COUNT) /* strip color segment if overflow */
-            col_seg -= colpair - MAX_COLPAIR_COUNT;
-        blink_segment_fill(random_color(), col_seg, dly_seg, &da);
+    if(!bg) {
+        fprintf(stderr, NOMEM_MSG);
+        return 1;
     }
+    bg->gen.next = blink_random_next;
+    bg->gen.free = NULL;
+    bg->rng = *rng;
+    bg->col_seg = RAND_COL_SEG_MIN +
+                  (int)(speed * (RAND_COL_SEG_MAX-RAND_COL_SEG_MIN)) / MAX_SPD;
+    bg->dly_seg = RAND_DLY_SEG_MIN +
+                  (int)(delay * (RAND_DLY_SEG_MAX-RAND_DLY_SEG_MIN)) / MAX_DLY;
+    seq_endless(seq, &bg->gen);
+    return 0;
+}
+
+static void blink_random_next(struct seqgen *gen, struct sequence *seq)
+{
+    struct blink_gen *bg = (struct blink_gen *)gen;
+    blink_segment_fill(random_color(&bg->rng), bg->col_seg, bg->dly_seg,
+                       seq);
 }
 
-static void sequence_blink(const struct colscheme *colsch, byte_t *da,
-                           int pckcnt)
+static void sequence_blink(const struct colscheme *colsch,
+                           struct sequence *seq)
 {
     const int *col;
     int col_seg = 101 - colsch->spd;
     for(col = colsch->colors; *col != nocolor; col++)
-        blink_segment_fill(*col, col_seg, colsch->dly, &da);
+        blink_segment_fill(*col, col_seg, colsch->dly, seq);
 }
 
-static void blink_segment_fill(int col, int col_seg, int dly_seg, byte_t **da)
+static void blink_segment_fill(int col, int col_seg, int dly_seg,
+                               struct sequence *seq)
 {
-    color_fill(col, col_seg, da);
-    color_fill(black, dly_seg, da);
+    if(col_seg > 0)
+        seq_run(seq, col, col_seg);
+    if(dly_seg > 0)
+        seq_run(seq, black, dly_seg);
 }
 
-static void sequence_cycle(const int *color, int spd, byte_t *da)
+static void sequence_cycle(const int *color, int spd, struct sequence *seq)
 {
     const int *first_col;
     int tr_length;
@@ -291,7 +496,7 @@ static void sequence_cycle(const int *color, int spd, byte_t *da)
         else
             tr_end = *(color+1);
 
-        write_gradient(&da, tr_start, tr_end, tr_length);
+        seq_gradient(seq, tr_start, tr_end, tr_length);
     }
 }
 
@@ -308,36 +513,13 @@ static int get_gradient_length(const int *color, int spd)
     return tr_size;
 }
 
-static void write_gradient(byte_t **da, int start_col, int end_col, int length)
-{
-    byte_t rgb_st[3], rgb_end[3], rgb_curr[3];
-    int shift, i;
-    /* Fill the arrays */
-    for(shift = 16, i = 0; shift >= 0; shift -= 8, i++) {
-        rgb_st[i] = (byte_t)((start_col >> shift) & 0xff);
-        rgb_end[i] = (byte_t)((end_col >> shift) & 0xff);
-        rgb_curr[i] = rgb_st[i]; /* the start is going to be the 1st rgb */
-    }
-    /* Write the transition to *da */
-    for(i = 1; i <= length; i++, *da += BYTE_STEP) {
-        int j;
-        **da = RGB_CODE;
-        (*da)++;
-        for(j = 0; j < 3; j++, (*da)++) {
-            **da = rgb_curr[j]; /* write R, G, or B */
-            /* Alter the first RGB depending on the second and the length */
-            rgb_curr[j] = (int)(rgb_st[j] +
-                          ((float)(i)/(length - 1))*(rgb_end[j] - rgb_st[j]));
-        }
-    }
-}
-
-static void sequence_wave(int *color, int spd, int group, byte_t *da)
+static void sequence_wave(int *color, int spd, int group,
+                          struct sequence *seq)
 {
     if(group == lower)
         wave_array_shift(color);
     /* Just do the same as in the Cycle mode */
-    sequence_cycle(color, spd, da);
+    sequence_cycle(color, spd, seq);
 }
 
 static void wave_array_shift(int *color)
@@ -350,7 +532,7 @@ static void wave_array_shift(int *color)
 }
 
 static void sequence_lightning(const int *color, int spd, int group,
-                               int synchronous, byte_t *da)
+                               int synchronous, struct sequence *seq)
 {
     unsigned int bl_size, up, down; /* the sizes of sections */
     bl_size = SPEED_RANGE(MIN_LGHT_BL, MAX_LGHT_BL, spd);
@@ -358,15 +540,35 @@ static void sequence_lightning(const int *color, int spd, int group,
     down = SPEED_RANGE(MIN_LGHT_DOWN, MAX_LGHT_DOWN, spd);
     for(; *color != nocolor; color++) {
         if(group == lower && !synchronous)
-            color_fill(black, bl_size, &da);
-        write_gradient(&da, black, *color, up);
-        write_gradient(&da, next_gradient_color(*color, black, down), black,
-                       down);
+            seq_run(seq, black, bl_size);
+        lightning_flash(*color, up, down, seq);
         if(group == upper || synchronous)
-            color_fill(black, bl_size, &da);
+            seq_run(seq, black, bl_size);
     }
 }
 
+/* Rises from black to the color and fades back */
+static void lightning_flash(int color, unsigned int up, unsigned int down,
+                            struct sequence *seq)
+{
+    seq_gradient(seq, black, color, up);
+    seq_gradient(seq, next_gradient_color(color, black, down), black, down);
+}
+
+/* The same flashes as of the pulse mode, shown on the beats instead */
+static void sequence_beat_flashes(const int *color, int spd,
+                                  struct sequence *seq)
+{
+    struct sequence flashes;
+    unsigned int up, down;
+    up = SPEED_RANGE(MIN_LGHT_UP, MAX_LGHT_UP, spd);
+    down = SPEED_RANGE(MIN_LGHT_DOWN, MAX_LGHT_DOWN, spd);
+    seq_init(&flashes);
+    for(; *color != nocolor; color++)
+        lightning_flash(*color, up, down, &flashes);
+    sequence_beat(&flashes, up + down, BEAT_LEAD(spd), seq);
+}
+
 static int next_gradient_color(int color, int endcolor, unsigned int size)
 {
     byte_t rgb[3], rgb_end[3];
@@ -383,10 +585,73 @@ static int next_gradient_color(int color, int endcolor, unsigned int size)
     return nextcolor;
 }
 
-static int random_color()
+/* A segment per keyframe: the frames are made only while playing */
+static void sequence_keyframes(const struct colscheme *colsch, int group,
+                               struct sequence *seq)
+{
+    struct timeline tl;
+    const struct keyframe *kf;
+    if(load_timeline(colsch->file, group, &tl)) /* checked, mustn't happen */
+        return;
+    kf = tl.keys;
+    if(kf->frame > 0) /* the first color holds until its time */
+        seq_run(seq, scale_color(kf->color, colsch->br), kf->frame);
+    for(; kf < tl.keys+tl.cnt-1; kf++) {
+        seq_eased(seq, scale_color(kf->color, colsch->br),
+                  scale_color((kf+1)->color, colsch->br),
+                  (kf+1)->frame - kf->frame, kf->ease);
+    }
+    if(seq->len == 0) /* all at the same moment: the last one stays */
+        seq_run(seq, scale_color(kf->color, colsch->br), 1);
+    free_timeline(&tl);
+}
+
+static unsigned int count_plugin_data(const struct qrgb_effect *eff,
+                                      const struct colscheme *colsch,
+                                      int group)
+{
+    struct qrgb_effect_params p;
+    unsigned int size;
+    p.colors = colsch->colors;
+    p.spd = colsch->spd;
+    p.dly = colsch->dly;
+    p.group = group;
+    size = eff->count(&p);
+    if(size > MAX_COLPAIR_COUNT) /* the plugin is asked for fewer frames */
+        size = MAX_COLPAIR_COUNT;
+    return size;
+}
+
+/* Plugin frames are kept as they are, one keyframe segment */
+static int sequence_plugin(const struct qrgb_effect *eff,
+                           const struct colscheme *colsch, int group,
+                           struct sequence *seq)
+{
+    struct qrgb_effect_params p;
+    int *frames;
+    unsigned int size, i;
+    p.colors = colsch->colors; /* brightness is already applied */
+    p.spd = colsch->spd;
+    p.dly = colsch->dly;
+    p.group = group;
+    /* The contract says count is stable, so it's asked again here */
+    size = count_plugin_data(eff, colsch, group);
+    frames = malloc(size * sizeof(*frames));
+    if(!frames) {
+        fprintf(stderr, NOMEM_MSG);
+        return 1;
+    }
+    eff->fill(&p, frames, size);
+    for(i = 0; i < size; i++)
+        frames[i] &= 0xffffff;
+    seq_keys(seq, frames, size);
+    return 0;
+}
+
+static int random_color(struct pcg32 *rng)
 {
     /* Generates a pseudorandom number from 0x1 to 0xffffff */
-    return 1 + (int)(16777215.0*rand()/(RAND_MAX+1.0));
+    return 1 + (int)pcg32_bounded(rng, 0xffffff);
 }
 
 static void write_hexcolor(int color, byte_t *mem)
@@ -398,29 +663,37 @@ static void write_hexcolor(int color, byte_t *mem)
     }
 }
 
-static void color_fill(int color, int size, byte_t **da)
+#ifdef DEBUG
+static void print_scene(const struct scene *sc)
 {
-    for(; size > 0; size--, *da += 2*BYTE_STEP) {
-        **da = RGB_CODE;
-        write_hexcolor(color, (*da)+1);
-    }
+    printf(N_("Frames to be played in a loop: %u\n"), sc->len);
+    puts(N_("Upper group:"));
+    print_group(&sc->upper);
+    puts(N_("Lower group:"));
+    print_group(&sc->lower);
 }
 
-#ifdef DEBUG
-static void print_datpack(datpack *da, int pck_cnt)
-{
-    int i, j;
-    printf(N_("Packets to be sent: %d\n"), pck_cnt);
-    for(j = 0; j < pck_cnt; j++) {
-        printf(N_("Packet %d:\n"), j+1);
-        for(i = 0; i < DATA_PACKET_SIZE; i++) {
-            printf("%02X ", (unsigned int)da[j][i]);
-            if((i+1) % 4 == 0)
-                printf("\t");
-            if((i+1) % 8 == 0)
-                puts("");
+static void print_group(const struct compositor *comp)
+{
+    static const char *types[] = { "run", "gradient", "eased", "keys" };
+    int i;
+    unsigned int j;
+    for(i = 0; i < comp->cnt; i++) {
+        const struct sequence *seq = &comp->layers[i].seq;
+        if(seq->view) {
+            printf(N_("Layer %d: %u frames, the upper one from frame %u\n"),
+                   i, seq->len, seq->phase);
+            continue;
+        }
+        printf(N_("Layer %d: %u frames, %u segments\n"), i, seq->len,
+               seq->cnt);
+        for(j = 0; j < seq->cnt; j++) {
+            const struct segment *sg = &seq->segs[j];
+            printf("\t%-8s %4u  %06X", types[sg->type], sg->len, sg->from);
+            if(sg->type == seg_gradient || sg->type == seg_eased)
+                printf(" -> %06X", sg->to);
+            puts("");
         }
-        puts("");
     }
 }
 #endif
@@ -1,7 +1,8 @@
 /* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
  * File rgbmodes.h
- * Assembles data packets from "colorschemes" structure.
- * parse_colorscheme returns pointer to the array of data packets.
+ * Assembles the scene from "colorschemes" structure: every mode is turned
+ * into a sequence of segments. parse_colorscheme returns pointer to the
+ * scene or NULL, pack_colpair turns a frame of it into the color commands.
  *
  * <----- License notice ----->
  * Copyright (C) 2022, 2023, 2024 Ors1mer
@@ -29,9 +30,16 @@
 #define RGBMODES_SENTRY
 
 #include <stdio.h> /* for fprintf */
-#include <stdlib.h> /* for srand & rand */
-#include <time.h> /* for time */
+#include <stdlib.h> /* for malloc */
+#include <stdint.h> /* for uint64_t */
 #include "argparser.h" /* for struct colschemes, strequ, enums */
+#include "prng.h" /* for struct pcg32 */
+#include "keyframes.h" /* for struct timeline, load_timeline */
+#include "visualizer.h" /* for vis_open, sequence_visualizer */
+#include "ingress.h" /* for ingress_open, sequence_ingress */
+#include "openrgb.h" /* for orgb_open, sequence_openrgb */
+#include "plugins.h" /* for find_plugin, struct qrgb_effect */
+#include "scene.h" /* for struct scene, struct sequence */
 
 /* Constants */
 #define MAX_PCT_COUNT 90
@@ -41,6 +49,7 @@
 #define DATA_PACKET_SIZE 64
 #define BYTE_STEP 4 /* used to skip some part of bytes in a packet */
 #define RGB_CODE 0x81
+#define NOSUPPORT_EXIT 254 /* the status of an unsupported mode */
 
 /* Macros */
 #define DIV_CEIL(X, Y) (((X)/(Y)) + ((X)%(Y) != 0))
@@ -62,16 +71,24 @@
 #define MAX_LGHT_UP 10
 #define MIN_LGHT_DOWN 21
 #define MAX_LGHT_DOWN 131
+/* Beat: a lightning flash peaks on its last rising frame */
+#define BEAT_LEAD(SPD) (SPEED_RANGE(MIN_LGHT_UP, MAX_LGHT_UP, SPD) - 1)
 
 /* Messages */
 #define NOSUPPORT_MSG _("The mode not supported yet.\n")
+#define NOMEM_MSG _("Not enough memory for the scene.\n")
 
 /* Types */
 typedef unsigned char byte_t;
 typedef byte_t datpack[DATA_PACKET_SIZE];
 
 /* Functions */
-datpack *parse_colorscheme(struct colschemes *cs, int *pck_cnt);
-short count_color_commands(const datpack *data_arr, int pck_cnt, int colgroup);
+int check_colorscheme(struct colschemes *cs); /* 1 if unsupported, printed */
+/* 1 if a layer reads audio, shared memory or OpenRGB clients: building it
+ * opens the source */
+int reads_source(struct colschemes *cs);
+int reads_stdin(struct colschemes *cs); /* the audio of a layer is "-" */
+struct scene *parse_colorscheme(struct colschemes *cs, uint64_t dev_key);
+void pack_colpair(int upper_col, int lower_col, byte_t *cmd);
 
 #endif
@@ -0,0 +1,105 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File scene.c
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#include "scene.h"
+
+/* Functions */
+struct scene *scene_new(void)
+{
+    struct scene *sc = malloc(sizeof(*sc));
+    compositor_init(&sc->upper);
+    compositor_init(&sc->lower);
+    sc->len = 0;
+    sc->img.map = NULL;
+    sc->refs = 1;
+    return sc;
+}
+
+struct scene *load_scene(const char *path)
+{
+    struct scene *sc = scene_new();
+    if(map_image(path, &sc->img)) {
+        free_scene(sc);
+        return NULL;
+    }
+    sc->len = sc->img.frames;
+    return sc;
+}
+
+void free_scene(struct scene *sc)
+{
+    if(!sc || --sc->refs > 0)
+        return;
+    compositor_free(&sc->upper);
+    compositor_free(&sc->lower);
+    unmap_image(&sc->img);
+    free(sc);
+}
+
+struct scene *scene_hold(struct scene *sc)
+{
+    sc->refs++;
+    return sc;
+}
+
+/* Endless layers go on from where they are, they have no first frame */
+void scene_rewind(struct scene *sc)
+{
+    compositor_rewind(&sc->upper);
+    compositor_rewind(&sc->lower);
+    sc->img.run = 0;
+}
+
+size_t scene_size(const struct scene *sc)
+{
+    size_t size = sizeof(*sc);
+    int i;
+    if(sc->img.map)
+        return size + sc->img.size;
+    for(i = 0; i < sc->upper.cnt; i++)
+        size += seq_size(&sc->upper.layers[i].seq);
+    for(i = 0; i < sc->lower.cnt; i++)
+        size += seq_size(&sc->lower.layers[i].seq);
+    return size;
+}
+
+void scene_set_len(struct scene *sc)
+{
+    sc->len = seq_loop(sc->upper.len, sc->lower.len);
+}
+
+/* A group never waits for the other one, it wraps at its own end */
+unsigned int scene_next(struct scene *sc, int *upper_col, int *lower_col)
+{
+    unsigned int hold, lower_hold;
+    if(sc->img.map)
+        return image_next(&sc->img, upper_col, lower_col);
+    *upper_col = compose(&sc->upper, &hold);
+    *lower_col = compose(&sc->lower, &lower_hold);
+    if(lower_hold < hold)
+        hold = lower_hold;
+    if(hold == 0 || hold == (unsigned int)-1) /* an empty scene is black */
+        hold = 1;
+    compositor_skip(&sc->upper, hold);
+    compositor_skip(&sc->lower, hold);
+    return hold;
+}
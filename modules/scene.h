@@ -0,0 +1,58 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File scene.h
+ * A scene is what is displayed: the layers of both diode groups or a
+ * compiled scene file. scene_next expands it frame by frame while the
+ * packets are being sent.
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#ifndef SCENE_SENTRY
+#define SCENE_SENTRY
+
+#include "compositor.h" /* for struct compositor */
+#include "image.h" /* for struct image */
+
+/* Constants */
+#define FRAME_MS 20 /* a frame is sent every 20 ms */
+
+/* Structs */
+struct scene {
+    struct compositor upper; /* mustn't be copied: cursors point inside */
+    struct compositor lower;
+    /* Each group loops on its own; both repeat together after len frames,
+     * the least common multiple of their lengths */
+    unsigned int len;
+    struct image img; /* played instead of the layers if mapped */
+    int refs; /* the owners, the last one frees it */
+};
+
+/* Functions */
+struct scene *scene_new(void);
+struct scene *load_scene(const char *path); /* NULL & message on failure */
+void scene_set_len(struct scene *sc); /* after the groups are filled */
+void free_scene(struct scene *sc); /* one owner less */
+struct scene *scene_hold(struct scene *sc); /* one owner more */
+void scene_rewind(struct scene *sc); /* to the first frame, for a replay */
+size_t scene_size(const struct scene *sc); /* bytes it takes */
+/* Gives the colors of the next frame, returns for how many frames they
+ * stay the same (at least 1) and moves past all these frames */
+unsigned int scene_next(struct scene *sc, int *upper_col, int *lower_col);
+
+#endif
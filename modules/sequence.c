@@ -0,0 +1,296 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File sequence.c
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#include "sequence.h"
+
+static struct segment *seq_append(struct sequence *seq, int type,
+                                  unsigned int len);
+static void seq_refill(struct sequence *seq);
+static void seq_clear(struct sequence *seq);
+static int gradient_color(const struct segment *sg, unsigned int off);
+static int eased_color(const struct segment *sg, unsigned int off);
+
+/* Functions */
+void seq_init(struct sequence *seq)
+{
+    seq->segs = NULL;
+    seq->cnt = seq->cap = 0;
+    seq->len = 0;
+    seq->gen = NULL;
+    seq->view = NULL;
+    seq->phase = 0;
+}
+
+void seq_free(struct sequence *seq)
+{
+    seq_clear(seq);
+    free(seq->segs);
+    if(seq->gen && seq->gen->free)
+        seq->gen->free(seq->gen);
+    else
+        free(seq->gen);
+    seq_init(seq);
+}
+
+/* Takes the ownership of the generator, the segments so far are dropped */
+void seq_endless(struct sequence *seq, struct seqgen *gen)
+{
+    seq->gen = gen;
+    seq_refill(seq);
+}
+
+/* The segments so far are dropped */
+void seq_view(struct sequence *seq, struct sequence *src, unsigned int phase)
+{
+    seq_free(seq);
+    seq->view = src;
+    seq->len = src->len;
+    seq->phase = src->len ? phase % src->len : 0;
+}
+
+unsigned int seq_length(const struct sequence *seq)
+{
+    return seq->gen ? SEQ_ENDLESS : seq->len;
+}
+
+/* The least common multiple; they'd meet so rarely past SEQ_MAX_LOOP that
+ * it never repeats for what it's worth */
+unsigned int seq_loop(unsigned int a, unsigned int b)
+{
+    unsigned int gcd = a, r = b;
+    if(a == SEQ_ENDLESS || b == SEQ_ENDLESS || a == 0 || b == 0)
+        return a > b ? a : b;
+    while(r) {
+        unsigned int t = gcd % r;
+        gcd = r;
+        r = t;
+    }
+    a /= gcd;
+    return (a > SEQ_MAX_LOOP / b) ? SEQ_ENDLESS : a*b;
+}
+
+/* A view shares the segments of its source, they aren't counted twice */
+size_t seq_size(const struct sequence *seq)
+{
+    size_t size = (size_t)seq->cap*sizeof(*seq->segs);
+    unsigned int i;
+    for(i = 0; i < seq->cnt; i++)
+        if(seq->segs[i].type == seg_keys && seq->segs[i].keys)
+            size += (size_t)seq->segs[i].len*sizeof(int);
+    return size;
+}
+
+/* The played segments of an endless sequence give way to the new ones */
+static void seq_refill(struct sequence *seq)
+{
+    seq_clear(seq);
+    while(seq->cnt == 0)
+        seq->gen->next(seq->gen, seq);
+}
+
+static void seq_clear(struct sequence *seq)
+{
+    unsigned int i;
+    for(i = 0; i < seq->cnt; i++) {
+        free(seq->segs[i].keys);
+        seq->segs[i].keys = NULL;
+    }
+    seq->cnt = 0;
+    seq->len = 0;
+}
+
+void seq_run(struct sequence *seq, int color, unsigned int len)
+{
+    struct segment *last;
+    if(len == 0)
+        return;
+    last = seq->cnt ? &seq->segs[seq->cnt-1] : NULL;
+    if(last && last->type == seg_run && last->from == color) { /* merge */
+        last->len += len;
+        seq->len += len;
+        return;
+    }
+    seq_append(seq, seg_run, len)->from = color;
+}
+
+void seq_gradient(struct sequence *seq, int from, int to, unsigned int len)
+{
+    struct segment *sg;
+    if(from == to) { /* nothing changes, it's a run */
+        seq_run(seq, from, len);
+        return;
+    }
+    sg = seq_append(seq, seg_gradient, len);
+    if(sg) {
+        sg->from = from;
+        sg->to = to;
+    }
+}
+
+/* Unlike a gradient, it stops one frame short of to: to starts the next one */
+void seq_eased(struct sequence *seq, int from, int to, unsigned int len,
+               int ease)
+{
+    struct segment *sg;
+    if(from == to || ease == ease_hold) {
+        seq_run(seq, from, len);
+        return;
+    }
+    sg = seq_append(seq, seg_eased, len);
+    if(sg) {
+        sg->from = from;
+        sg->to = to;
+        sg->ease = ease;
+    }
+}
+
+/* Takes the ownership of keys */
+void seq_keys(struct sequence *seq, int *keys, unsigned int len)
+{
+    struct segment *sg;
+    sg = seq_append(seq, seg_keys, len);
+    if(sg)
+        sg->keys = keys;
+    else
+        free(keys);
+}
+
+static struct segment *seq_append(struct sequence *seq, int type,
+                                  unsigned int len)
+{
+    struct segment *sg;
+    if(len == 0)
+        return NULL;
+    if(seq->cnt == seq->cap) {
+        seq->cap += SEG_CHUNK;
+        seq->segs = realloc(seq->segs, seq->cap * sizeof(*seq->segs));
+    }
+    sg = &seq->segs[seq->cnt++];
+    sg->type = type;
+    sg->len = len;
+    sg->from = sg->to = 0;
+    sg->ease = ease_linear;
+    sg->keys = NULL;
+    seq->len += len;
+    return sg;
+}
+
+void cur_init(struct seqcur *cur, struct sequence *seq)
+{
+    cur->seq = seq->view ? seq->view : seq;
+    cur->seg = 0;
+    cur->off = 0;
+    if(seq->view)
+        cur_skip(cur, seq->phase);
+}
+
+int cur_color(const struct seqcur *cur)
+{
+    const struct segment *sg;
+    if(cur->seq->cnt == 0)
+        return 0; /* black */
+    sg = &cur->seq->segs[cur->seg];
+    switch(sg->type) {
+    case seg_gradient:
+        return gradient_color(sg, cur->off);
+    case seg_eased:
+        return eased_color(sg, cur->off);
+    case seg_keys:
+        return sg->keys[cur->off];
+    default: /* seg_run */
+        return sg->from;
+    }
+}
+
+unsigned int cur_hold(const struct seqcur *cur)
+{
+    const struct segment *sg;
+    if(cur->seq->cnt == 0)
+        return (unsigned int)-1; /* black forever */
+    sg = &cur->seq->segs[cur->seg];
+    return (sg->type == seg_run) ? sg->len - cur->off : 1;
+}
+
+/* The segments of an endless sequence are made only when they are needed,
+ * so a live source is read right before its frame is sent */
+void cur_prepare(struct seqcur *cur)
+{
+    if(cur->seq->gen && cur->seq->cnt == 0)
+        seq_refill(cur->seq);
+}
+
+void cur_skip(struct seqcur *cur, unsigned int frames)
+{
+    struct sequence *seq = cur->seq;
+    if(!seq->gen) {
+        if(seq->len == 0)
+            return;
+        frames %= seq->len;
+    }
+    while(frames > 0) {
+        unsigned int left;
+        cur_prepare(cur);
+        left = seq->segs[cur->seg].len - cur->off;
+        if(frames < left) {
+            cur->off += frames;
+            return;
+        }
+        frames -= left;
+        cur->off = 0;
+        if(cur->seg+1 < seq->cnt) {
+            cur->seg++;
+        } else { /* the end: loop or drop them to make the next ones */
+            if(seq->gen)
+                seq_clear(seq);
+            cur->seg = 0;
+        }
+    }
+}
+
+/* Rounds exactly as the gradients were rounded when they were packed */
+static int gradient_color(const struct segment *sg, unsigned int off)
+{
+    int shift, color = 0;
+    if(off == 0)
+        return sg->from;
+    for(shift = 16; shift >= 0; shift -= 8) {
+        unsigned char st, end, curr;
+        st = (unsigned char)((sg->from >> shift) & 0xff);
+        end = (unsigned char)((sg->to >> shift) & 0xff);
+        curr = (int)(st + ((float)(off)/(sg->len - 1))*(end - st));
+        color |= curr << shift;
+    }
+    return color;
+}
+
+static int eased_color(const struct segment *sg, unsigned int off)
+{
+    int shift, color = 0;
+    unsigned int e = ease_at(sg->ease, off, sg->len);
+    for(shift = 16; shift >= 0; shift -= 8) {
+        int st, end;
+        st = (sg->from >> shift) & 0xff;
+        end = (sg->to >> shift) & 0xff;
+        color |= (st + (end - st)*(int)e/EASE_ONE) << shift;
+    }
+    return color;
+}
@@ -0,0 +1,102 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File sequence.h
+ * A sequence of colors of one layer stored as segments: constant runs,
+ * linear gradients, eased transitions and keyframes (explicit colors of
+ * every frame).
+ * Colors are expanded only while playing, through a cursor, so the
+ * memory and the generation cost depend on the number of segments, not
+ * frames. A cursor also tells how long the current color holds.
+ * An endless sequence has a generator instead of a loop: the segments are
+ * made on the fly, a few at a time, as the cursor reaches the end.
+ * A view has no segments of its own, its cursors play another looped
+ * sequence from a phase, so a group can follow the other one for free.
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#ifndef SEQUENCE_SENTRY
+#define SEQUENCE_SENTRY
+
+#include <stdlib.h> /* for malloc, realloc, free */
+#include "easing.h" /* for ease_at */
+
+/* Constants */
+#define SEG_CHUNK 16 /* segments are allocated by chunks */
+#define SEQ_ENDLESS ((unsigned int)-1) /* the length of an endless sequence */
+#define SEQ_MAX_LOOP (1U << 24) /* frames, a longer loop is endless */
+
+enum segment_type { seg_run, seg_gradient, seg_eased, seg_keys };
+
+/* Structs */
+struct segment {
+    int type; /* enum segment_type */
+    unsigned int len; /* in frames, at least 1 */
+    int from; /* the color of a run, the first color of a gradient */
+    int to; /* the last color of a gradient, the next one of an eased */
+    int ease; /* enum ease_curve of an eased transition */
+    int *keys; /* the colors of every frame of keyframes, owned */
+};
+
+struct sequence;
+
+struct seqgen { /* the 1st member of every generator's own struct */
+    /* Appends at least one segment */
+    void (*next)(struct seqgen *gen, struct sequence *seq);
+    /* Frees the generator, NULL if free() is enough */
+    void (*free)(struct seqgen *gen);
+};
+
+struct sequence {
+    struct segment *segs;
+    unsigned int cnt, cap;
+    unsigned int len; /* the sum of the segment lengths */
+    struct seqgen *gen; /* NULL if the sequence loops, owned */
+    struct sequence *view; /* the one played instead, not owned */
+    unsigned int phase; /* the frame of the view its cursors start from */
+};
+
+struct seqcur {
+    struct sequence *seq;
+    unsigned int seg; /* the current segment */
+    unsigned int off; /* the frame inside of it */
+};
+
+/* Functions */
+void seq_init(struct sequence *seq);
+void seq_free(struct sequence *seq);
+void seq_run(struct sequence *seq, int color, unsigned int len);
+void seq_gradient(struct sequence *seq, int from, int to, unsigned int len);
+void seq_eased(struct sequence *seq, int from, int to, unsigned int len,
+               int ease);
+void seq_keys(struct sequence *seq, int *keys, unsigned int len);
+void seq_endless(struct sequence *seq, struct seqgen *gen);
+/* src must loop and outlive the view */
+void seq_view(struct sequence *seq, struct sequence *src, unsigned int phase);
+unsigned int seq_length(const struct sequence *seq); /* SEQ_ENDLESS too */
+/* The frames after which two loops of lengths a and b repeat together */
+unsigned int seq_loop(unsigned int a, unsigned int b);
+size_t seq_size(const struct sequence *seq); /* bytes of the segments */
+/* Cursors, they loop over the sequence */
+void cur_init(struct seqcur *cur, struct sequence *seq);
+void cur_prepare(struct seqcur *cur); /* before cur_color & cur_hold */
+int cur_color(const struct seqcur *cur);
+unsigned int cur_hold(const struct seqcur *cur); /* at least 1 */
+void cur_skip(struct seqcur *cur, unsigned int frames);
+
+#endif
@@ -0,0 +1,309 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File visualizer.c
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#include <stdio.h> /* for fprintf */
+#include <stdlib.h> /* for malloc, free */
+#include <string.h> /* for strcmp, strcpy */
+#include <math.h> /* for log10 */
+
+#include "visualizer.h"
+
+/* Structs */
+struct vis_gen { /* a group's layer, made a frame at a time */
+    struct seqgen gen;
+    int colors[COLORS_CNT];
+    int group;
+    float release;
+    float level; /* shown the last time */
+    struct vis_engine *eng; /* held */
+    unsigned long hop; /* the engine's hop it has seen */
+};
+
+struct beat_gen { /* flashes on the beats, a frame at a time */
+    struct seqgen gen;
+    struct sequence flashes; /* one after another, owned */
+    struct seqcur cur; /* in the flash being shown */
+    unsigned int flash_len, flash_cnt;
+    unsigned int flash; /* the next one */
+    unsigned int left; /* frames of the flash to show */
+    unsigned int lead;
+    double fired; /* the beat flashed the last time */
+    struct vis_engine *eng; /* held */
+    unsigned long hop;
+};
+
+/* The engine new generators read and the one it has replaced, still read
+ * by the playing scene (BE CAREFUL: GLOBAL VARIABLES) */
+static struct vis_engine *engine = NULL, *replaced = NULL;
+
+static void vis_next(struct seqgen *gen, struct sequence *seq);
+static void vis_free(struct seqgen *gen);
+static void beat_next(struct seqgen *gen, struct sequence *seq);
+static void beat_free(struct seqgen *gen);
+static struct vis_engine *hold_engine(void);
+static void release_engine(struct vis_engine *eng);
+static void free_engine(struct vis_engine *eng);
+static int sync_engine(struct vis_engine *eng, unsigned long *hop);
+static void advance_engine(struct vis_engine *eng);
+static int level_color(const int *colors, float level);
+static int mix_channels(int from, int to, float part);
+
+/* Functions */
+int vis_open(const char *src)
+{
+    struct vis_engine *eng;
+    int b;
+    if(engine && strcmp(engine->src, src) == 0)
+        return 0;
+    if(engine && engine->refs == 0) { /* opened for this scene already */
+        fprintf(stderr, VIS_SOURCE_ERR_MSG, engine->src, src);
+        return 1;
+    }
+    eng = malloc(sizeof(*eng));
+    if(audio_open(&eng->au, src)) {
+        free(eng);
+        return 1;
+    }
+    /* A copy: the arguments of a control request don't stay */
+    eng->src = strcpy(malloc(strlen(src)+1), src);
+    eng->hop = 0;
+    analyzer_init(&eng->an, eng->au.rate);
+    bt_init(&eng->bt);
+    for(b = 0; b < AN_BANDS; b++) {
+        eng->peak_db[b] = VIS_FLOOR_DB;
+        eng->level[b] = 0;
+    }
+    eng->refs = 0;
+    replaced = engine; /* the old one is left to its generators */
+    engine = eng;
+    return 0;
+}
+
+void vis_close(void)
+{
+    struct vis_engine *eng = engine;
+    if(eng && eng->refs > 0)
+        return;
+    engine = replaced; /* a scene that isn't made gives it back */
+    replaced = NULL;
+    if(eng)
+        free_engine(eng);
+}
+
+/* vis_open must have succeeded */
+void sequence_visualizer(const int *colors, int spd, int group,
+                         struct sequence *seq)
+{
+    struct vis_gen *vg = malloc(sizeof(*vg));
+    int i;
+    for(i = 0; i < COLORS_CNT && colors[i] != nocolor; i++)
+        vg->colors[i] = colors[i];
+    vg->colors[i < COLORS_CNT ? i : COLORS_CNT-1] = nocolor;
+    vg->gen.next = vis_next;
+    vg->gen.free = vis_free;
+    vg->group = group;
+    vg->release = VIS_RELEASE_MIN +
+                  (VIS_RELEASE_MAX - VIS_RELEASE_MIN) * spd / 100;
+    vg->level = 0;
+    vg->eng = hold_engine();
+    vg->hop = VIS_UNSTARTED;
+    seq_endless(seq, &vg->gen);
+}
+
+/* vis_open must have succeeded */
+void sequence_beat(struct sequence *flashes, unsigned int flash_len,
+                   unsigned int lead, struct sequence *seq)
+{
+    struct beat_gen *bg = malloc(sizeof(*bg));
+    bg->gen.next = beat_next;
+    bg->gen.free = beat_free;
+    bg->flashes = *flashes;
+    bg->flash_len = flash_len;
+    bg->flash_cnt = flash_len ? seq_length(flashes) / flash_len : 0;
+    bg->flash = bg->left = 0;
+    bg->lead = lead;
+    bg->fired = 0;
+    bg->eng = hold_engine();
+    bg->hop = VIS_UNSTARTED;
+    seq_endless(seq, &bg->gen);
+}
+
+/* Called right before the frame is sent */
+static void vis_next(struct seqgen *gen, struct sequence *seq)
+{
+    struct vis_gen *vg = (struct vis_gen *)gen;
+    struct vis_engine *eng = vg->eng;
+    float level;
+    if(!sync_engine(eng, &vg->hop)) {
+        seq_run(seq, black, 1);
+        return;
+    }
+    if(vg->group == lower) {
+        level = eng->level[band_bass];
+    } else {
+        level = eng->level[band_mid];
+        if(eng->level[band_treble] > level)
+            level = eng->level[band_treble];
+    }
+    /* Rises at once, falls smoothly */
+    if(level < vg->level - vg->release)
+        level = vg->level - vg->release;
+    if(level < 0)
+        level = 0;
+    vg->level = level;
+    seq_run(seq, level_color(vg->colors, level), 1);
+}
+
+static void vis_free(struct seqgen *gen)
+{
+    struct vis_gen *vg = (struct vis_gen *)gen;
+    release_engine(vg->eng);
+    free(vg);
+}
+
+/* The flash starts early, so that it peaks right on the predicted beat */
+static void beat_next(struct seqgen *gen, struct sequence *seq)
+{
+    struct beat_gen *bg = (struct beat_gen *)gen;
+    struct vis_engine *eng = bg->eng;
+    int color = black;
+    if(!sync_engine(eng, &bg->hop)) {
+        seq_run(seq, black, 1);
+        return;
+    }
+    if(bg->flash_cnt &&
+       bt_flash_due(&eng->bt, eng->bt.prev_now, bg->lead, &bg->fired)) {
+        cur_init(&bg->cur, &bg->flashes);
+        cur_skip(&bg->cur, bg->flash*bg->flash_len);
+        bg->flash = (bg->flash + 1) % bg->flash_cnt;
+        bg->left = bg->flash_len; /* the next beat cuts it if it's long */
+    }
+    if(bg->left) {
+        color = cur_color(&bg->cur);
+        cur_skip(&bg->cur, 1);
+        bg->left--;
+    }
+    seq_run(seq, color, 1);
+}
+
+static void beat_free(struct seqgen *gen)
+{
+    struct beat_gen *bg = (struct beat_gen *)gen;
+    seq_free(&bg->flashes);
+    release_engine(bg->eng);
+    free(bg);
+}
+
+/* vis_open must have succeeded */
+static struct vis_engine *hold_engine(void)
+{
+    engine->refs++;
+    return engine;
+}
+
+/* The source is closed when no scene plays it any more */
+static void release_engine(struct vis_engine *eng)
+{
+    if(--eng->refs > 0)
+        return;
+    if(eng == engine)
+        engine = NULL;
+    if(eng == replaced)
+        replaced = NULL;
+    free_engine(eng);
+}
+
+static void free_engine(struct vis_engine *eng)
+{
+    audio_close(&eng->au);
+    free((char *)eng->src);
+    free(eng);
+}
+
+/* The first generator called in a frame analyses it, the others see the
+ * same; the call made with the sequence, before the frames, doesn't */
+static int sync_engine(struct vis_engine *eng, unsigned long *hop)
+{
+    if(*hop == VIS_UNSTARTED) {
+        *hop = eng->hop;
+        return 0;
+    }
+    if(*hop == eng->hop)
+        advance_engine(eng);
+    *hop = eng->hop;
+    return 1;
+}
+
+static void advance_engine(struct vis_engine *eng)
+{
+    float smp[VIS_READ_CHUNK];
+    double now;
+    int n, b;
+    while((n = audio_read(&eng->au, smp, VIS_READ_CHUNK)) > 0)
+        analyzer_push(&eng->an, smp, n);
+    analyzer_run(&eng->an);
+    now = (double)eng->au.consumed / eng->au.rate;
+    bt_update(&eng->bt, eng->an.flux, now - eng->an.onset_lag, now);
+    eng->hop++;
+    for(b = 0; b < AN_BANDS; b++) {
+        float db, lvl;
+        if(eng->an.rms < VIS_GATE) {
+            eng->level[b] = 0;
+            continue;
+        }
+        /* The gain follows the music: the loudest recent sound is full */
+        db = 10.0f * (float)log10(eng->an.energy[b] + 1e-12);
+        eng->peak_db[b] -= VIS_AGC_FALL;
+        if(db > eng->peak_db[b])
+            eng->peak_db[b] = db;
+        lvl = (db - (eng->peak_db[b] - VIS_RANGE_DB)) / VIS_RANGE_DB;
+        eng->level[b] = lvl < 0 ? 0 : lvl;
+    }
+}
+
+/* The palette goes from quiet to loud, the level dims it too */
+static int level_color(const int *colors, float level)
+{
+    int cnt, i;
+    float pos;
+    for(cnt = 0; colors[cnt] != nocolor; cnt++)
+        {}
+    if(cnt == 0)
+        return black;
+    pos = level * (cnt-1);
+    i = (int)pos;
+    if(i >= cnt-1)
+        return mix_channels(black, colors[cnt-1], level);
+    return mix_channels(black,
+                        mix_channels(colors[i], colors[i+1], pos - i),
+                        level);
+}
+
+static int mix_channels(int from, int to, float part)
+{
+    int shift, color = 0;
+    for(shift = 16; shift >= 0; shift -= 8) {
+        int st = (from >> shift) & 0xff, end = (to >> shift) & 0xff;
+        color |= (st + (int)((end - st)*part)) << shift;
+    }
+    return color;
+}
@@ -0,0 +1,79 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File visualizer.h
+ * The audio-reactive mode. One engine reads the audio and analyses it once
+ * per frame, right before the frame is sent; the lower diodes follow the
+ * bass, the upper one the mids & highs. The level of a group picks the
+ * color from the palette (quiet to loud) and its brightness.
+ * The latency is the half of the window (5.8 ms at 44.1 kHz) plus at most
+ * a frame (20 ms) plus the USB transfer: under 30 ms.
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#ifndef VISUALIZER_SENTRY
+#define VISUALIZER_SENTRY
+
+#include "locale_macros.h"
+#include "argparser.h" /* for COLORS_CNT, nocolor, enum diode_group */
+#include "sequence.h" /* for struct sequence, struct seqgen */
+#include "audio.h" /* for struct audio */
+#include "analyzer.h" /* for struct analyzer */
+#include "beat.h" /* for struct beat_tracker */
+
+/* Constants */
+#define VIS_READ_CHUNK 256 /* frames */
+#define VIS_RANGE_DB 30.0f /* from dark to full, under the recent loudest */
+#define VIS_AGC_FALL 0.05f /* dB per frame the loudest level is forgotten */
+#define VIS_FLOOR_DB -100.0f
+#define VIS_GATE 0.002f /* a quieter RMS is silence */
+#define VIS_RELEASE_MIN 0.02f /* per frame, speed 0 */
+#define VIS_RELEASE_MAX 0.25f /* speed 100 */
+#define VIS_UNSTARTED ((unsigned long)-1) /* the hop of a new generator */
+
+/* Messages */
+#define VIS_SOURCE_ERR_MSG _("One audio source at a time: %s and %s\n")
+
+/* Structs */
+struct vis_engine {
+    const char *src; /* owned */
+    struct audio au;
+    struct analyzer an;
+    unsigned long hop; /* the analysed frames */
+    float peak_db[AN_BANDS]; /* the recent loudest, for the gain */
+    float level[AN_BANDS]; /* 0..1 */
+    struct beat_tracker bt;
+    int refs; /* the generators reading it */
+};
+
+/* Functions */
+/* 0 or message, again with the same src. Another source replaces the one
+ * in use: that one stays for the generators reading it, it's closed with
+ * the last of them. Two sources at once are an error for the same scene */
+int vis_open(const char *src);
+/* Closes the one vis_open has opened if nothing reads it, the one it has
+ * replaced is used again */
+void vis_close(void);
+void sequence_visualizer(const int *colors, int spd, int group,
+                         struct sequence *seq);
+/* Takes the flashes over: flash_len frames each, shown one per beat and
+ * peaking lead frames after they start */
+void sequence_beat(struct sequence *flashes, unsigned int flash_len,
+                   unsigned int lead, struct sequence *seq);
+
+#endif
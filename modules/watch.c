@@ -0,0 +1,117 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File watch.c
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#include <string.h> /* for strrchr, strcmp */
+#include <unistd.h> /* for read, close */
+#include <errno.h> /* for errno */
+#ifdef __linux__
+#include <sys/inotify.h> /* for inotify_init1, inotify_add_watch */
+#endif
+
+#include "watch.h"
+
+/* Constants */
+#ifdef __linux__
+#define WATCH_EVENTS (IN_CLOSE_WRITE | IN_MOVED_TO) /* a file is complete */
+#define WATCH_BUF_LEN 4096
+#endif
+
+/* Functions */
+void watch_init(struct watch *wt)
+{
+    wt->cnt = 0;
+    #ifdef __linux__
+    wt->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    #else
+    wt->fd = -1;
+    #endif
+}
+
+void watch_free(struct watch *wt)
+{
+    if(wt->fd >= 0)
+        close(wt->fd); /* the watches go with it */
+    wt->fd = -1;
+    wt->cnt = 0;
+}
+
+void watch_clear(struct watch *wt)
+{
+    #ifdef __linux__
+    int i;
+    for(i = 0; i < wt->cnt; i++) /* a directory twice fails once, no harm */
+        inotify_rm_watch(wt->fd, wt->wd[i]);
+    #endif
+    wt->cnt = 0;
+}
+
+void watch_file(struct watch *wt, const char *path)
+{
+    #ifdef __linux__
+    char dir[WATCH_NAME_LEN];
+    const char *slash = strrchr(path, '/');
+    size_t len = slash ? (size_t)(slash - path) : 0;
+    int wd;
+    if(wt->fd < 0 || wt->cnt == WATCH_MAX || len >= WATCH_NAME_LEN ||
+                                       strlen(path) - len >= WATCH_NAME_LEN)
+        return;
+    if(!slash) {
+        strcpy(dir, ".");
+    } else {
+        memcpy(dir, path, len ? len : 1); /* the root keeps its slash */
+        dir[len ? len : 1] = '\0';
+    }
+    wd = inotify_add_watch(wt->fd, dir, WATCH_EVENTS);
+    if(wd < 0)
+        return;
+    wt->wd[wt->cnt] = wd;
+    strcpy(wt->name[wt->cnt], slash ? slash+1 : path);
+    wt->cnt++;
+    #endif
+}
+
+/* All the events are read, however many files have changed */
+int watch_changed(struct watch *wt)
+{
+    #ifdef __linux__
+    char buf[WATCH_BUF_LEN]
+        __attribute__((aligned(__alignof__(struct inotify_event))));
+    const struct inotify_event *ev;
+    ssize_t n;
+    char *p;
+    int i, changed = 0;
+    if(wt->fd < 0)
+        return 0;
+    while((n = read(wt->fd, buf, sizeof(buf))) > 0 ||
+                                               (n < 0 && errno == EINTR)) {
+        for(p = buf; n > 0 && p < buf + n; p += sizeof(*ev) + ev->len) {
+            ev = (const struct inotify_event *)p;
+            for(i = 0; i < wt->cnt && !changed; i++)
+                changed = ev->wd == wt->wd[i] && ev->len > 0 &&
+                          0 == strcmp(ev->name, wt->name[i]);
+        }
+    }
+    return changed;
+    #else
+    return 0;
+    #endif
+}
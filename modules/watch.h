@@ -0,0 +1,50 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File watch.h
+ * Tells when the files a scene is made of have been written, so the
+ * running program can build it again. The directories are watched, not
+ * the files: an editor replacing a file by renaming a new one over it is
+ * seen too. Only on Linux (inotify), elsewhere nothing is ever seen.
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#ifndef WATCH_SENTRY
+#define WATCH_SENTRY
+
+/* Constants */
+#define WATCH_MAX 16 /* files */
+#define WATCH_NAME_LEN 256
+
+/* Structs */
+struct watch {
+    int fd; /* -1 if the files can't be watched */
+    int cnt;
+    int wd[WATCH_MAX]; /* of the directory of every file */
+    char name[WATCH_MAX][WATCH_NAME_LEN]; /* the file in the directory */
+};
+
+/* Functions */
+void watch_init(struct watch *wt);
+void watch_free(struct watch *wt);
+void watch_clear(struct watch *wt); /* the files are forgotten */
+/* Relative to the current directory, a file that can't be is ignored */
+void watch_file(struct watch *wt, const char *path);
+int watch_changed(struct watch *wt); /* 1 if written since the last call */
+
+#endif
@@ -0,0 +1,95 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File breathe.c
+ * The reference effect plugin: every color slowly fades in and out
+ * along a smoothstep curve, the lower diodes are half a breath behind.
+ * Build with "make plugins", load with "quadcastrgb -p plugins/breathe.so
+ * breathe [COLORS]...".
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#include "../modules/qrgb_plugin.h"
+
+/* Constants */
+#define MIN_BREATH 16 /* frames per color at the speed of 100 */
+#define MAX_BREATH 180 /* at the speed of 0 */
+
+static unsigned int breathe_count(const struct qrgb_effect_params *p);
+static void breathe_fill(const struct qrgb_effect_params *p, int *frames,
+                         unsigned int cnt);
+static unsigned int breath_length(int spd);
+static int scale_color(int color, unsigned int num, unsigned int den);
+
+static const struct qrgb_effect breathe = {
+    QRGB_PLUGIN_ABI_VERSION,
+    "breathe",
+    breathe_count,
+    breathe_fill
+};
+
+/* Functions */
+const struct qrgb_effect *qrgb_plugin_entry(void)
+{
+    return &breathe;
+}
+
+static unsigned int breathe_count(const struct qrgb_effect_params *p)
+{
+    unsigned int col_cnt, len;
+    const int *col;
+    for(col_cnt = 0, col = p->colors; *col != QRGB_NOCOLOR; col++)
+        col_cnt++;
+    len = breath_length(p->spd);
+    while(col_cnt > 0 && col_cnt*len > QRGB_MAX_FRAMES) /* drop extra */
+        col_cnt--;
+    return col_cnt*len;
+}
+
+static void breathe_fill(const struct qrgb_effect_params *p, int *frames,
+                         unsigned int cnt)
+{
+    unsigned int len, i, shift;
+    len = breath_length(p->spd);
+    shift = (p->group == qrgb_lower) ? len/2 : 0;
+    for(i = 0; i < cnt; i++) {
+        unsigned int pos, t, curve;
+        pos = (i + shift) % cnt; /* wrap around the whole sequence */
+        t = pos % len;
+        /* Triangle 0..len/2..0 mapped to 0..1000, then smoothstep */
+        t = (t < len/2) ? t : len - t;
+        t = t*2000/len;
+        curve = t*t*(3000 - 2*t)/1000000;
+        frames[i] = scale_color(p->colors[pos/len], curve, 1000);
+    }
+}
+
+static unsigned int breath_length(int spd)
+{
+    return MIN_BREATH + (MAX_BREATH - MIN_BREATH)*(100 - spd)/100;
+}
+
+static int scale_color(int color, unsigned int num, unsigned int den)
+{
+    int shift, result = 0;
+    for(shift = 16; shift >= 0; shift -= 8) {
+        unsigned int ch = (color >> shift) & 0xff;
+        result |= (int)(ch*num/den) << shift;
+    }
+    return result;
+}
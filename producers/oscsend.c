@@ -0,0 +1,148 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File oscsend.c
+ * A sender of OSC messages for the live control, to try it without a
+ * controller. Every argument starting with a slash begins a message, the
+ * ones after it are its arguments: an integer is sent as i, a number with
+ * a point as f and anything else as s. All the messages go at once, one
+ * datagram each, so "producers/oscsend 9000 /quadcastrgb/dim 10
+ * /quadcastrgb/dim 90" shows the coalescing: only 90 is taken. Build with
+ * "make producers" and run "quadcastrgb --osc 9000 ..." first.
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#include <stdio.h> /* for fprintf, perror */
+#include <stdlib.h> /* for strtol, strtod */
+#include <string.h> /* for memcpy, memset, strlen, strchr */
+#include <stdint.h> /* for uint32_t */
+#include <unistd.h> /* for close */
+#include <sys/socket.h> /* for socket, sendto */
+#include <netinet/in.h> /* for struct sockaddr_in */
+#include <arpa/inet.h> /* for htonl, htons */
+
+/* Constants */
+#define MAX_PACKET 1536
+#define MAX_ARGS 8
+#define USAGE_MSG "Usage: oscsend PORT /ADDRESS [ARG]... " \
+                  "[/ADDRESS [ARG]...]...\n"
+
+static int send_message(int fd, const struct sockaddr_in *addr,
+                        char **argv, int argc);
+static size_t put_str(unsigned char *p, const char *str);
+static void put_u32(unsigned char *p, uint32_t v);
+static char arg_type(const char *arg);
+
+int main(int argc, char **argv)
+{
+    struct sockaddr_in addr;
+    long port;
+    char *end;
+    int fd, i, next, status = 0;
+    port = argc < 3 ? 0 : strtol(argv[1], &end, 10);
+    if(port < 1 || port > 65535 || *end != '\0' || argv[2][0] != '/') {
+        fprintf(stderr, USAGE_MSG);
+        return 1;
+    }
+    fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if(fd < 0) {
+        perror("socket");
+        return 1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((unsigned short)port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    for(i = 2; i < argc; i = next) {
+        for(next = i+1; next < argc && argv[next][0] != '/'; next++)
+            ;
+        if(send_message(fd, &addr, argv + i, next - i))
+            status = 1;
+    }
+    close(fd);
+    return status;
+}
+
+/* The address, the type tags, then the arguments, all 4-byte aligned */
+static int send_message(int fd, const struct sockaddr_in *addr,
+                        char **argv, int argc)
+{
+    unsigned char buf[MAX_PACKET];
+    char tags[MAX_ARGS+2] = ",";
+    size_t len;
+    float f;
+    uint32_t bits;
+    int i;
+    if(argc-1 > MAX_ARGS || strlen(argv[0]) > 256) {
+        fprintf(stderr, USAGE_MSG);
+        return 1;
+    }
+    for(i = 1; i < argc; i++)
+        tags[i] = arg_type(argv[i]);
+    tags[argc] = '\0';
+    len = put_str(buf, argv[0]);
+    len += put_str(buf + len, tags);
+    for(i = 1; i < argc; i++) {
+        if(tags[i] == 'i') {
+            put_u32(buf + len, (uint32_t)strtol(argv[i], NULL, 10));
+            len += 4;
+        } else if(tags[i] == 'f') {
+            f = (float)strtod(argv[i], NULL);
+            memcpy(&bits, &f, sizeof(bits));
+            put_u32(buf + len, bits);
+            len += 4;
+        } else if(strlen(argv[i]) < 256) {
+            len += put_str(buf + len, argv[i]);
+        }
+    }
+    if(sendto(fd, buf, len, 0, (const struct sockaddr *)addr,
+              sizeof(*addr)) < 0) {
+        perror(argv[0]);
+        return 1;
+    }
+    return 0;
+}
+
+/* The string, its NUL and up to 3 more to a multiple of 4 */
+static size_t put_str(unsigned char *p, const char *str)
+{
+    size_t len = strlen(str), padded = (len + 4) & ~(size_t)3;
+    memcpy(p, str, len);
+    memset(p + len, 0, padded - len);
+    return padded;
+}
+
+static void put_u32(unsigned char *p, uint32_t v)
+{
+    p[0] = v >> 24;
+    p[1] = v >> 16;
+    p[2] = v >> 8;
+    p[3] = v;
+}
+
+static char arg_type(const char *arg)
+{
+    char *end;
+    strtol(arg, &end, 10);
+    if(*arg && *end == '\0')
+        return 'i';
+    strtod(arg, &end);
+    if(*arg && *end == '\0' && strchr(arg, '.'))
+        return 'f';
+    return 's';
+}
@@ -0,0 +1,209 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File presskeys.c
+ * A virtual keyboard pressing the combinations of the hotkeys, to try them
+ * without touching the real one. It's made through uinput, so it needs
+ * the rights to /dev/uinput. The keyboard waits a bit before the first
+ * combination for quadcastrgb to find it, then every one is pressed and
+ * released in turn; the moment of each press (CLOCK_MONOTONIC) is printed,
+ * to be compared with the time the colors change.
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#include <stdio.h> /* for printf, fprintf, perror */
+#include <stdlib.h> /* for atoi */
+#include <string.h> /* for strcmp, strcpy, memset */
+#include <ctype.h> /* for tolower */
+#ifdef __linux__
+#include <unistd.h> /* for write, close, usleep */
+#include <fcntl.h> /* for open */
+#include <time.h> /* for clock_gettime */
+#include <sys/ioctl.h> /* for ioctl */
+#include <linux/uinput.h> /* for struct uinput_setup, UI_* */
+#include "../modules/keynames.h"
+#endif
+
+/* Constants */
+#define UINPUT_PATH "/dev/uinput"
+#define DEV_NAME "quadcastrgb presskeys"
+#define WAIT_MS 3000 /* longer than quadcastrgb looks for keyboards */
+#define GAP_MS 1000
+#define MAX_NAME 64
+#define USAGE_MSG "Usage: presskeys [-w MS] [-g MS] COMBO...\n" \
+                  "  -w MS  wait before the first combination (3000)\n" \
+                  "  -g MS  between the combinations (1000)\n" \
+                  "A combination is modifiers and a key joined by '+': " \
+                  "ctrl+alt+f1\n"
+#define BADKEY_MSG "%s: unknown key combination\n"
+
+#ifdef __linux__
+struct combo {
+    int mods; /* enum key_mod */
+    unsigned short code;
+};
+
+static int parse_combo(const char *str, struct combo *cmb);
+static int find_name(const struct key_name *names, const char *name);
+static int open_keyboard(void);
+static void press(int fd, const struct combo *cmb);
+static void emit(int fd, int type, int code, int value);
+
+int main(int argc, char **argv)
+{
+    struct combo cmb;
+    struct timespec now;
+    int fd, i, j, wait_ms = WAIT_MS, gap_ms = GAP_MS;
+    for(i = 1; i+1 < argc && argv[i][0] == '-'; i += 2) {
+        if(!strcmp(argv[i], "-w")) {
+            wait_ms = atoi(argv[i+1]);
+        } else if(!strcmp(argv[i], "-g")) {
+            gap_ms = atoi(argv[i+1]);
+        } else {
+            fprintf(stderr, USAGE_MSG);
+            return 1;
+        }
+    }
+    if(i == argc) {
+        fprintf(stderr, USAGE_MSG);
+        return 1;
+    }
+    for(j = i; j < argc; j++) { /* all are checked before the keyboard */
+        if(parse_combo(argv[j], &cmb)) {
+            fprintf(stderr, BADKEY_MSG, argv[j]);
+            return 1;
+        }
+    }
+    fd = open_keyboard();
+    if(fd < 0)
+        return 1;
+    usleep(wait_ms*1000L);
+    for(; i < argc; i++) {
+        parse_combo(argv[i], &cmb);
+        press(fd, &cmb);
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        printf("%ld.%06ld %s\n", (long)now.tv_sec, now.tv_nsec/1000L,
+               argv[i]);
+        fflush(stdout);
+        if(i+1 < argc)
+            usleep(gap_ms*1000L);
+    }
+    usleep(100000); /* the last events are read before it's gone */
+    ioctl(fd, UI_DEV_DESTROY);
+    close(fd);
+    return 0;
+}
+
+static int parse_combo(const char *str, struct combo *cmb)
+{
+    char name[MAX_NAME];
+    int len, i;
+    cmb->mods = 0;
+    for(;;) {
+        for(len = 0; str[len] && str[len] != '+'; len++) {
+            if(len == MAX_NAME-1)
+                return 1;
+            name[len] = tolower((unsigned char)str[len]);
+        }
+        name[len] = '\0';
+        if(!str[len])
+            break;
+        i = find_name(key_mods, name);
+        if(i < 0)
+            return 1;
+        cmb->mods |= key_mods[i].code;
+        str += len+1;
+    }
+    i = find_name(key_names, name);
+    if(i < 0)
+        return 1;
+    cmb->code = key_names[i].code;
+    return 0;
+}
+
+static int find_name(const struct key_name *names, const char *name)
+{
+    int i;
+    for(i = 0; names[i].name; i++)
+        if(!strcmp(names[i].name, name))
+            return i;
+    return -1;
+}
+
+/* Every key it can name, so it looks like a keyboard */
+static int open_keyboard(void)
+{
+    struct uinput_setup setup;
+    int fd, i;
+    fd = open(UINPUT_PATH, O_WRONLY | O_NONBLOCK);
+    if(fd < 0) {
+        perror(UINPUT_PATH);
+        return -1;
+    }
+    ioctl(fd, UI_SET_EVBIT, EV_KEY);
+    ioctl(fd, UI_SET_EVBIT, EV_SYN);
+    for(i = 0; key_names[i].name; i++)
+        ioctl(fd, UI_SET_KEYBIT, key_names[i].code);
+    for(i = 0; mod_keys[i].code; i++)
+        ioctl(fd, UI_SET_KEYBIT, mod_keys[i].code);
+    memset(&setup, 0, sizeof(setup));
+    setup.id.bustype = BUS_VIRTUAL;
+    strcpy(setup.name, DEV_NAME);
+    if(ioctl(fd, UI_DEV_SETUP, &setup) < 0 ||
+       ioctl(fd, UI_DEV_CREATE) < 0) {
+        perror(UINPUT_PATH);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/* The modifiers go down first and up last, as a hand does it; the left
+ * key of each */
+static void press(int fd, const struct combo *cmb)
+{
+    int i;
+    for(i = 0; mod_keys[i].code; i += 2)
+        if(cmb->mods & mod_keys[i].mod)
+            emit(fd, EV_KEY, mod_keys[i].code, 1);
+    emit(fd, EV_KEY, cmb->code, 1);
+    emit(fd, EV_SYN, SYN_REPORT, 0);
+    emit(fd, EV_KEY, cmb->code, 0);
+    for(i = 0; mod_keys[i].code; i += 2)
+        if(cmb->mods & mod_keys[i].mod)
+            emit(fd, EV_KEY, mod_keys[i].code, 0);
+    emit(fd, EV_SYN, SYN_REPORT, 0);
+}
+
+static void emit(int fd, int type, int code, int value)
+{
+    struct input_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.type = type;
+    ev.code = code;
+    ev.value = value;
+    if(write(fd, &ev, sizeof(ev)) != sizeof(ev))
+        perror("write");
+}
+#else
+int main(void)
+{
+    fprintf(stderr, "presskeys: uinput is only on Linux\n");
+    return 1;
+}
+#endif
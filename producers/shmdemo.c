@@ -0,0 +1,179 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File shmdemo.c
+ * The reference producer of the shm mode: a rainbow runs around the
+ * upper diode and the lower ones get the opposite color. Build with
+ * "make producers", run "producers/shmdemo NAME [latest|queued]" and
+ * "quadcastrgb shm NAME". Latest-wins renders at 200 frames a second and
+ * the extra ones are skipped, queued renders as fast as they're taken.
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#include <stdio.h> /* for fprintf */
+#include <string.h> /* for strcmp */
+#include <signal.h> /* for signal */
+#include <time.h> /* for nanosleep */
+#include <unistd.h> /* for ftruncate, close */
+#include <fcntl.h> /* for O_RDWR, O_CREAT */
+#include <sys/mman.h> /* for shm_open, mmap */
+#include <sys/stat.h> /* for fstat */
+#include "../modules/qrgb_shm.h"
+
+/* Constants */
+#define LATEST_NS 5000000L /* a frame every 5 ms */
+#define QUEUED_NS 1000000L /* a look for room every ms */
+#define HUE_STEPS 1536 /* 6 edges of the color cube, 256 steps each */
+#define HUE_STEP 4 /* per frame */
+#define USAGE_MSG "Usage: shmdemo NAME [latest|queued]\n"
+
+static volatile sig_atomic_t running = 1;
+static void stop_handler(int s)
+{
+    running = 0;
+}
+
+static struct qrgb_shm *map_shm(const char *name);
+static void start(struct qrgb_shm *shm, uint32_t mode);
+static void put_latest(struct qrgb_shm *shm, uint32_t upper,
+                       uint32_t lower);
+static int put_queued(struct qrgb_shm *shm, uint32_t upper, uint32_t lower);
+static uint32_t hue_color(unsigned int hue);
+static void sleep_ns(long ns);
+
+int main(int argc, char **argv)
+{
+    struct qrgb_shm *shm;
+    uint32_t mode = qrgb_shm_latest;
+    unsigned int hue = 0;
+    if(argc < 2 || argc > 3 || (argc == 3 && strcmp(argv[2], "latest") &&
+                                             strcmp(argv[2], "queued"))) {
+        fprintf(stderr, USAGE_MSG);
+        return 1;
+    }
+    if(argc == 3 && 0 == strcmp(argv[2], "queued"))
+        mode = qrgb_shm_queued;
+    shm = map_shm(argv[1]);
+    if(!shm)
+        return 1;
+    signal(SIGINT, stop_handler);
+    signal(SIGTERM, stop_handler);
+    start(shm, mode);
+    while(running) {
+        uint32_t upper = hue_color(hue),
+                 lower = hue_color((hue + HUE_STEPS/2) % HUE_STEPS);
+        if(mode == qrgb_shm_latest) {
+            put_latest(shm, upper, lower);
+            sleep_ns(LATEST_NS);
+        } else {
+            while(running && !put_queued(shm, upper, lower))
+                sleep_ns(QUEUED_NS); /* full: quadcastrgb is behind */
+        }
+        hue = (hue + HUE_STEP) % HUE_STEPS;
+    }
+    munmap(shm, sizeof(*shm));
+    return 0;
+}
+
+/* The name as given to quadcastrgb, with or without the slash */
+static struct qrgb_shm *map_shm(const char *name)
+{
+    char path[256];
+    struct stat st;
+    void *map;
+    int fd;
+    snprintf(path, sizeof(path), "%s%s", name[0] == '/' ? "" : "/", name);
+    fd = shm_open(path, O_RDWR | O_CREAT, 0600);
+    if(fd < 0) {
+        perror(path);
+        return NULL;
+    }
+    if(fstat(fd, &st) || ((size_t)st.st_size < sizeof(struct qrgb_shm) &&
+                          ftruncate(fd, sizeof(struct qrgb_shm)))) {
+        perror(path);
+        close(fd);
+        return NULL;
+    }
+    map = mmap(NULL, sizeof(struct qrgb_shm), PROT_READ | PROT_WRITE,
+               MAP_SHARED, fd, 0);
+    close(fd);
+    if(map == MAP_FAILED) {
+        perror(path);
+        return NULL;
+    }
+    return map;
+}
+
+/* The reader keeps its tail, the ring is emptied by catching up to it */
+static void start(struct qrgb_shm *shm, uint32_t mode)
+{
+    QRGB_SHM_RELEASE(&shm->magic, 0); /* not ready while it changes */
+    shm->version = QRGB_SHM_VERSION;
+    shm->mode = mode;
+    shm->slots = QRGB_SHM_SLOTS;
+    if(QRGB_SHM_READ(&shm->seq) & 1) /* a producer died in the middle */
+        QRGB_SHM_WRITE(&shm->seq, shm->seq + 1);
+    QRGB_SHM_WRITE(&shm->head, QRGB_SHM_ACQUIRE(&shm->tail));
+    QRGB_SHM_RELEASE(&shm->magic, QRGB_SHM_MAGIC);
+}
+
+static void put_latest(struct qrgb_shm *shm, uint32_t upper, uint32_t lower)
+{
+    uint32_t seq = QRGB_SHM_READ(&shm->seq);
+    QRGB_SHM_WRITE(&shm->seq, seq + 1);
+    QRGB_SHM_FENCE_RELEASE(); /* odd before the frame changes */
+    QRGB_SHM_WRITE(&shm->latest.upper, upper);
+    QRGB_SHM_WRITE(&shm->latest.lower, lower);
+    QRGB_SHM_RELEASE(&shm->seq, seq + 2);
+}
+
+/* 0 if there's no room */
+static int put_queued(struct qrgb_shm *shm, uint32_t upper, uint32_t lower)
+{
+    uint32_t head = QRGB_SHM_READ(&shm->head);
+    struct qrgb_shm_frame *f;
+    if(head - QRGB_SHM_ACQUIRE(&shm->tail) >= QRGB_SHM_SLOTS)
+        return 0;
+    f = &shm->ring[head % QRGB_SHM_SLOTS];
+    QRGB_SHM_WRITE(&f->upper, upper);
+    QRGB_SHM_WRITE(&f->lower, lower);
+    QRGB_SHM_RELEASE(&shm->head, head + 1); /* the frame is there */
+    return 1;
+}
+
+/* Around the edges of the color cube: red, yellow, green, cyan... */
+static uint32_t hue_color(unsigned int hue)
+{
+    uint32_t up = hue % 256, down = 255 - up;
+    switch(hue / 256) {
+    case 0: return 0xff0000 | up << 8;
+    case 1: return down << 16 | 0x00ff00;
+    case 2: return 0x00ff00 | up;
+    case 3: return down << 8 | 0x0000ff;
+    case 4: return up << 16 | 0x0000ff;
+    default: return 0xff0000 | down;
+    }
+}
+
+static void sleep_ns(long ns)
+{
+    struct timespec ts;
+    ts.tv_sec = 0;
+    ts.tv_nsec = ns;
+    nanosleep(&ts, NULL);
+}
@@ -0,0 +1,90 @@
+/* quadcastrgb - set RGB lights of HyperX Quadcast S and DuoCast
+ * File switches.c
+ * Switches scenes from one thread while another one plays the frames, as
+ * the control requests do with --ahead. Run by "make check", it's meant
+ * for -fsanitize=thread too: every scene handed over must be taken or
+ * freed once, and the last one must be the one shown.
+ *
+ * <----- License notice ----->
+ * Copyright (C) 2026 the quadcastrgb contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see
+ * <https://www.gnu.org/licenses/gpl-2.0.en.html>. For any questions
+ * concerning the license, you can write to <licensing@fsf.org>.
+ * Also, you may visit the Free Software Foundation at
+ * 51 Franklin Street, Fifth Floor Boston, MA 02110 USA.
+ */
+#include <stdio.h> /* for printf, fprintf */
+#include <pthread.h> /* for pthread_create, pthread_join */
+
+#include "../modules/player.h"
+
+#define SWITCHES 200000
+#define FADE 3 /* frames, the last switch cuts */
+#define LAST_COLOR 0x123456
+
+static int done = 0; /* the switcher has finished */
+
+/* A scene of a single color, as solid mode makes it */
+static struct scene *solid_scene(int color)
+{
+    struct scene *sc = scene_new();
+    struct sequence upper, lower;
+    seq_init(&upper);
+    seq_init(&lower);
+    seq_run(&upper, color, 1);
+    seq_run(&lower, color, 1);
+    compositor_add(&sc->upper, &upper, blend_normal, 100);
+    compositor_add(&sc->lower, &lower, blend_normal, 100);
+    scene_set_len(sc);
+    return sc;
+}
+
+static void *switcher(void *arg)
+{
+    struct player *pl = arg;
+    int i;
+    for(i = 1; i < SWITCHES; i++)
+        player_switch(pl, solid_scene(i & 0xffffff), i % 2 ? FADE : 0);
+    player_switch(pl, solid_scene(LAST_COLOR), 0);
+    __atomic_store_n(&done, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+int main(void)
+{
+    struct player pl;
+    pthread_t thread;
+    unsigned long frames = 0;
+    int upper_col, lower_col;
+    player_init(&pl, solid_scene(0));
+    if(pthread_create(&thread, NULL, switcher, &pl)) {
+        fprintf(stderr, "Couldn't start the switcher\n");
+        player_free(&pl);
+        return 1;
+    }
+    while(!__atomic_load_n(&done, __ATOMIC_ACQUIRE)) {
+        player_next(&pl, &upper_col, &lower_col);
+        frames++;
+    }
+    pthread_join(thread, NULL);
+    player_next(&pl, &upper_col, &lower_col);
+    player_free(&pl);
+    if(upper_col != LAST_COLOR || lower_col != LAST_COLOR) {
+        fprintf(stderr, "switches: %06x %06x shown, %06x switched to\n",
+                upper_col, lower_col, LAST_COLOR);
+        return 1;
+    }
+    printf("switches: %d switches over %lu frames\n", SWITCHES, frames);
+    return 0;
+}